@@ -0,0 +1,49 @@
+// affinity.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Thread placement policies for the OpenMP backend.
+// A policy is resolved once against the detected topology into an ordered CPU
+// list; thread i of the team is then pinned to cpus[i % cpus.size()] (see
+// ParallelOptions::cpus). OMP_PLACES/OMP_PROC_BIND cannot be used for this
+// because the OpenMP runtime reads them when the program starts.
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "sysinfo.hpp"
+
+enum class AffinityPolicy {
+    None,     // leave placement to the OS
+    Compact,  // fill a core's SMT siblings, then the next core, then the next package
+    Scatter,  // round-robin over packages, then cores; SMT siblings used last
+    Cores,    // one thread per physical core (first SMT sibling only)
+    List      // explicit CPU list, in the given order
+};
+
+struct AffinitySpec {
+    AffinityPolicy policy = AffinityPolicy::None;
+    std::vector<int> cpus; // List only
+};
+
+// "none", "compact", "scatter", "cores", or a CPU list such as "0,2,4-7".
+AffinitySpec parse_affinity(const std::string& s);
+
+// CPU order for the policy; empty for None. Throws if a listed CPU is not available.
+std::vector<int> affinity_cpu_order(const AffinitySpec& spec, const std::vector<LogicalCpu>& topo);
+std::vector<int> affinity_cpu_order(const AffinitySpec& spec);
+
+// Pins the calling thread to one CPU. Remembers the last CPU per thread, so
+// repeated calls with the same CPU cost no system call. Returns false where
+// pinning is not supported or fails.
+bool pin_current_thread(int cpu);
+
+// Restores the mask the calling thread had before its first pin_current_thread
+// call. A no-op (no system call) for threads that are not pinned.
+void unpin_current_thread();
+
+// Thread-to-CPU mapping for a team of `threads` threads, e.g. "0:0 1:2 2:4";
+// "os" when cpus is empty.
+std::string affinity_mapping(const std::vector<int>& cpus, int threads);
+
+const char* affinity_policy_name(AffinityPolicy p);
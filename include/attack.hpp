@@ -0,0 +1,62 @@
+// attack.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Scaling-attack sweep used by the attack mode.
+// Evaluates down_up_metrics over a grid of downscale ratios and (down, up)
+// method pairs on one source image loaded once, and ranks the configurations
+// by how much of the source the downscale throws away: the lower the PSNR of
+// the down->up reconstruction, the more source pixels an attacker can alter
+// without changing the downscaled image. The fraction of source pixels the
+// downscale reads at all comes from the sparse resize operator.
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "image.hpp"
+#include "resize.hpp"
+#include "scaling_attacks.hpp"
+
+struct AttackSpec {
+    std::vector<std::pair<double, double>> ratios = {{2, 2}, {3, 3}, {4, 4}, {5, 5}, {8, 8}}; // source/down (x, y)
+    std::vector<std::pair<ResizeMethod, ResizeMethod>> method_pairs = {
+        {ResizeMethod::Nearest, ResizeMethod::Nearest},
+        {ResizeMethod::Nearest, ResizeMethod::Bilinear},
+        {ResizeMethod::Bilinear, ResizeMethod::Nearest},
+        {ResizeMethod::Bilinear, ResizeMethod::Bilinear}
+    };
+    int threads = 0; // 0 = OpenMP default
+    int top = 10;    // rows of the ranked summary
+};
+
+struct AttackResult {
+    double ratio_x = 1.0;
+    double ratio_y = 1.0;
+    int down_w = 0;
+    int down_h = 0;
+    ResizeMethod down_method = ResizeMethod::Nearest;
+    ResizeMethod up_method = ResizeMethod::Nearest;
+    AttackMetrics metrics;
+    double influential_fraction = 0.0; // source pixels the downscale reads (the ones an attacker must control)
+    double ms = 0.0; // downscale (shared by the up methods of a group) + reconstruction
+};
+
+// Downscaled size for a ratio: round(size / ratio), at least 1.
+std::pair<int, int> attack_down_size(int w, int h, double ratio_x, double ratio_y);
+
+// Runs the grid. Configurations sharing (ratio, down_method) reuse one downscaled
+// image. The groups run in parallel (one thread each) when there are at least as
+// many groups as threads; otherwise each group uses the whole team row-wise.
+// Results are in grid order (ratio, then method pair).
+std::vector<AttackResult> run_attack_grid(const Image& src, const AttackSpec& spec, std::ostream& log);
+
+// One row per configuration; CSV or JSON by extension.
+void write_attack_results(const std::vector<AttackResult>& results, const Image& src, const std::string& path);
+
+// Configurations ranked from most to least vulnerable (ascending PSNR, then descending MAE).
+void print_attack_summary(const std::vector<AttackResult>& results, int top, std::ostream& os);
+
+// "4" -> (4, 4), "2x3" -> (2, 3); ratios must be >= 1.
+std::pair<double, double> parse_attack_ratio(const std::string& s);
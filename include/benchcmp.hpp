@@ -0,0 +1,78 @@
+// benchcmp.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Performance regression gate: compares a candidate result file against a
+// baseline (both written by bench/benchset, CSV or JSON). Rows are matched on
+// their configuration columns; each matched pair is tested for a significant
+// change (Mann-Whitney U on raw samples when both sample files are given,
+// otherwise overlap of the bootstrap CIs of the median) and flagged as a
+// regression when it is significant and worse than the threshold. Baseline
+// configurations the candidate lacks, and non-finite metrics, also fail the
+// gate (missing ones can be allowed with --allow-missing).
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class CmpTest {
+    Auto,        // Mann-Whitney when samples are available, else CI overlap
+    MannWhitney,
+    CiOverlap,
+    None         // threshold only
+};
+
+struct BenchCmpSpec {
+    std::string baseline_path;
+    std::string candidate_path;
+    std::string baseline_samples;  // optional raw samples (bench/benchset --samples)
+    std::string candidate_samples;
+
+    std::vector<std::string> keys; // empty => every configuration column present in both files
+    std::string metric = "median_ms";
+    double threshold = 0.05;       // relative change that counts (0.05 = 5%)
+    double alpha = 0.05;           // significance level for Mann-Whitney
+    CmpTest test = CmpTest::Auto;
+    bool allow_missing = false;    // missing configurations do not fail the gate
+};
+
+enum class CmpVerdict { Same, Improved, Regressed, Missing, Invalid };
+
+struct BenchCmpRow {
+    std::string config;       // key values joined with '/'
+    double baseline = 0.0;
+    double candidate = 0.0;
+    double delta = 0.0;       // candidate / baseline - 1 (positive = larger value)
+    CmpTest test = CmpTest::None;
+    double p_value = -1.0;    // Mann-Whitney only
+    CmpVerdict verdict = CmpVerdict::Same;
+};
+
+struct BenchCmpReport {
+    std::vector<std::string> keys;
+    std::string metric;
+    bool lower_is_better = true;
+    std::vector<BenchCmpRow> rows;
+    int regressions = 0;
+    int improvements = 0;
+    int missing = 0;          // baseline configurations absent from the candidate
+    int invalid = 0;          // metric not a finite number (crashed or truncated run)
+
+    // Environment fields that differ between two JSON result files, formatted as
+    // "name: baseline -> candidate" (host, CPU, compiler, flags, revision, ...).
+    std::vector<std::string> env_differences;
+};
+
+BenchCmpReport compare_bench_results(const BenchCmpSpec& spec);
+
+// True if the gate fails: any regression or invalid metric, or missing
+// configurations unless spec.allow_missing.
+bool benchcmp_failed(const BenchCmpReport& rep, const BenchCmpSpec& spec);
+
+void print_benchcmp_table(const BenchCmpReport& rep, const BenchCmpSpec& spec, std::ostream& os);
+
+// One row per configuration; CSV or JSON by extension.
+void write_benchcmp_report(const BenchCmpReport& rep, const std::string& path);
+
+const char* cmp_test_name(CmpTest t);
+const char* cmp_verdict_name(CmpVerdict v);
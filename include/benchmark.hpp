@@ -10,8 +10,50 @@
 #include <vector>
 #include <string>
 #include "image.hpp"
+#include "perf_counters.hpp"
+#include "results.hpp"
 #include "resize.hpp"
 
+// How the output buffer is provided to each measured resize.
+enum class AllocMode {
+    Fresh,      // new Image per call inside the timed region (allocation + zero-fill + first-touch faults)
+    Reused,     // one output Image allocated up front and reused: pure compute cost
+    Prefaulted  // new Image per call, allocated and faulted in before the timer starts
+};
+
+const char* alloc_mode_name(AllocMode m);
+
+// Cache state of the input at the start of each measured resize.
+enum class CacheMode {
+    Warm,   // back-to-back calls on the same input (data stays in cache if it fits)
+    Flush,  // stream a buffer larger than the LLC (and every team core's L2) before every call
+    Rotate  // rotate among enough input copies that each call reads cold data
+};
+
+const char* cache_mode_name(CacheMode m);
+
+// Optional measurement features (all off by default: plain wall-clock timing).
+struct BenchOptions {
+    AllocMode alloc = AllocMode::Fresh;
+    CacheMode cache = CacheMode::Warm;
+
+    bool perf_counters = false; // wrap measured runs in perf_event_open counters
+
+    // Adaptive sampling: `runs` becomes the minimum; keep sampling until the 95% CI
+    // half-width of the median is below ci_target (relative to the median), or the
+    // time budget / max_runs is exhausted.
+    bool adaptive = false;
+    double ci_target = 0.02;
+    double time_budget_ms = 10000.0;
+    int max_runs = 1000;
+
+    double outlier_k = 3.5; // MAD outlier threshold, in robust sigmas
+
+    // OpenMP only: per-thread busy time, rows and barrier wait over the measured
+    // runs (see WorkAccounting); adds one barrier per call.
+    bool thread_stats = false;
+};
+
 // Data structure to hold benchmark results.
 struct BenchResult {
     int runs = 0;
@@ -19,6 +61,40 @@ struct BenchResult {
     double stddev_ms = 0.0;
     double min_ms = 0.0;
     double max_ms = 0.0;
+
+    // Robust statistics, computed after MAD outlier rejection
+    double median_ms = 0.0;
+    double p90_ms = 0.0;
+    double p99_ms = 0.0;
+    double mad_ms = 0.0;
+    double ci_lo_ms = 0.0;   // 95% bootstrap CI of the median
+    double ci_hi_ms = 0.0;
+    int outliers = 0;        // samples rejected by the MAD filter
+    bool converged = true;   // adaptive mode: CI target reached
+
+    // Nominal memory traffic per call (distinct source rows read + output written)
+    // and the bandwidth it implies at the median time.
+    double bytes_per_call = 0.0;
+    double bandwidth_gbs = 0.0;
+
+    // Page faults per resize call during the timed region (getrusage, whole process)
+    double minor_faults = 0.0;
+    double major_faults = 0.0;
+
+    std::vector<double> samples; // raw per-run times (ms per resize), in run order
+
+    // Hardware counters per resize call (summed over threads), -1 when unavailable.
+    PerfCounters perf;
+    std::string perf_status; // empty when counters were not requested
+
+    // Thread accounting (BenchOptions::thread_stats), -1 when not recorded.
+    // Times are per resize call; threads holds per-call averages per thread.
+    double imbalance = -1.0;      // max/mean busy time over the team
+    double idle_fraction = -1.0;  // barrier wait / (busy + wait), whole team
+    double busy_mean_ms = -1.0;
+    double busy_max_ms = -1.0;
+    double wait_mean_ms = -1.0;
+    std::vector<ThreadWork> threads;
 };
 
 // Run a benchmark of the resize function with the given parameters.
@@ -30,12 +106,21 @@ BenchResult benchmark_resize(
     int threads,
     int warmup,
     int runs,
-    int inner_reps = 1   // default per compatibilità
+    int inner_reps = 1,  // default per compatibilità
+    const ParallelOptions& popt = {},
+    const BenchOptions& bopt = {}
 );
 
+// Column names / values for the measured part of a result row: timing statistics
+// followed by perf counters and thread accounting (always present so the schema does
+// not depend on --perf / --thread-stats; -1 = unavailable).
+std::vector<std::string> bench_result_columns();
+void append_bench_result(std::vector<ResultValue>& row, const BenchResult& r);
+
+// Rows per call of each thread, space separated ("540 540 0"); "-" without thread stats.
+std::string thread_rows_summary(const BenchResult& r);
+
+// Raw samples, one row per measured run: <key columns...>, sample, ms, outlier.
+void write_samples(ResultWriter& writer, const std::vector<ResultValue>& key,
+                   const BenchResult& r, double outlier_k = 3.5);
 
-void append_csv_row(
-    const std::string& csv_path,
-    const std::string& header_if_new,
-    const std::string& row
-);
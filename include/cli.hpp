@@ -7,15 +7,36 @@
 
 #include <string>
 #include <ostream>
+#include <vector>
 
+#include "affinity.hpp"
+#include "attack.hpp"
+#include "conformance.hpp"
+#include "detect.hpp"
+#include "benchcmp.hpp"
+#include "benchmark.hpp"
+#include "metadata.hpp"
+#include "pipeline.hpp"
 #include "resize.hpp"
+#include "scaling.hpp"
+#include "sweep.hpp"
+#include "yuv.hpp"
 
 // Run mode determines the main program flow: either run a single resize or a benchmark.
 enum class RunMode {
     Run,        // Run a single resize and write output image
     Bench,      // Run a benchmark and write results to CSV
     Validate,   // Compare two images and print difference metrics
-    BenchSet,   // Run a set of benchmarks with different parameters (not implemented)
+    BenchSet,   // Run a parameter grid (sizes x methods x backends x threads x schedules)
+    Scaling,    // Strong/weak thread-scaling report for the OpenMP backend
+    Yuv,        // Resize a raw planar YUV 4:2:0 / 4:2:2 file plane by plane
+    BenchCmp,   // Compare a candidate result file against a baseline (regression gate)
+    Pipeline,   // End-to-end read/decode/resize/convert/encode/write benchmark
+    Metrics,    // Full-reference quality metrics (PSNR, SSIM, MS-SSIM) of two images
+    Attack,     // Down->up scaling-attack sweep over ratios and method pairs
+    Detect,     // Screen a directory of images for scaling attacks
+    Conformance, // Every registered resize kernel against the scalar reference
+    Hash,       // Content hashes of images; golden-manifest regression check
     Help        // Print usage information
 };
 
@@ -28,25 +49,83 @@ struct CliOptions {
     ResizeMethod method = ResizeMethod::Nearest;
     Backend backend = Backend::Sequential;
     int threads = 0;
+    std::string trace_path; // --trace: Chrome trace-event output (any mode)
+    std::string isa_level;  // --isa: row kernel level override (any mode); empty = RESIZER_ISA or detected
 
     // Run mode
     std::string output_path;
     int out_w = 0;
     int out_h = 0;
 
+    // Validate and metrics modes
+    bool compare_reference = false; // cross-check against the scalar reference implementation
+
+    // Metrics mode (input_path is the reference image)
+    std::string distorted_path;
+    bool metric_psnr = true;
+    bool metric_ssim = true;
+    bool metric_ms_ssim = true;
+
+    // Attack mode (csv_path receives one row per configuration)
+    AttackSpec attack;
+
+    // Detect mode (input_path unused; csv_path receives one row per file)
+    DetectSpec detect;
+
+    // Conformance mode (csv_path receives one row per kernel x method)
+    ConformanceSpec conformance;
+    bool conformance_list = false;
+
+    // Hash mode (files or directories) and run --manifest
+    std::vector<std::string> hash_inputs;
+    bool hash_recursive = false;
+    std::string manifest_path;   // hash: rows for every input; run: row for the output
+    std::string check_manifest;  // hash: compare against this manifest
+    std::string golden_dir;      // hash: reference images compared on mismatch
+
     // Bench mode (also used by BenchSet)
     int warmup = 2;
     int runs = 10;
     std::string csv_path;
+    BenchOptions bench;
+    std::string samples_path; // optional raw per-run samples export
+    std::vector<AllocMode> alloc_modes = {AllocMode::Fresh};
+    std::vector<CacheMode> cache_modes = {CacheMode::Warm};
+    AffinitySpec affinity;    // OpenMP thread placement (bench, benchset, scaling)
 
     // BenchSet mode parameters (size sweep)
     int base_w = 0;     // starting output width
     int base_h = 0;     // starting output height
     int steps = 0;      // number of sizes to test
     double scale = 1.0; // multiplier per step (e.g., 1.5)
+
+    // BenchSet grid axes and options (sizes are filled from base/steps/scale
+    // unless given explicitly with --sizes)
+    SweepSpec sweep;
+
+    // Scaling mode
+    ScalingSpec scaling;
+
+    // Yuv mode: geometry of the raw input (raw planar files carry no header)
+    int in_w = 0;
+    int in_h = 0;
+    ChromaFormat chroma_format = ChromaFormat::Yuv420;
+    ChromaSiting chroma_siting = ChromaSiting::Center;
+
+    // Pipeline mode
+    PipelineSpec pipeline;
+
+    // BenchCmp mode (csv_path, if given, receives the per-configuration deltas)
+    BenchCmpSpec benchcmp;
 };
 
 
 void print_usage(std::ostream& os);
 
 CliOptions parse_cli(int argc, char** argv);
+
+const char* run_mode_name(RunMode m);
+
+// Run parameters recorded in JSON result files: the command line plus the
+// resolved common options (defaults included), for set_run_parameters().
+MetadataFields cli_run_parameters(const CliOptions& opt, int argc, char** argv);
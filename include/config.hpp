@@ -14,4 +14,7 @@ namespace cfg {
     inline constexpr int default_jpg_quality = 95;    // 1..100 (stb)
 
     inline constexpr const char* default_csv_path = "benchmark_results.csv";
+
+    // metrics --reference: max accepted |fast - reference| per channel (float vs double SSIM)
+    inline constexpr double ssim_reference_tolerance = 1e-4;
 }
@@ -0,0 +1,65 @@
+// conformance.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Kernel conformance harness used by the conformance mode.
+// Every resize implementation in the tree is registered here with its method
+// coverage, ISA, backend, precision and a max-abs-diff budget against the
+// per-pixel scalar reference. The harness runs each one over randomized cases
+// (random sizes, 1-pixel dimensions, extreme down/up ratios, odd row strides)
+// and compares the outputs with compare_images. New variants (SIMD, fixed
+// point, tiled) are added to conformance_kernels() with their budget.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+#include "resize.hpp"
+
+// Per-pixel resize straight from the mapping formulas (map_coord, floor/lround,
+// clamped taps, v0 + w * (v1 - v0)): no column maps, no row kernels.
+Image resize_reference(const Image& in, int out_w, int out_h, ResizeMethod method);
+
+struct ConformanceKernel {
+    std::string name;
+    std::vector<ResizeMethod> methods;  // methods the kernel implements
+    std::string isa = "scalar";         // x86-64 level of the row kernels it runs (see dispatch.hpp)
+    std::string backend;                // "seq", "omp", ...
+    std::string precision = "f32";     // arithmetic of the interpolation
+    int max_abs_budget = 0;             // largest |kernel - reference| allowed
+    std::function<Image(const Image& in, int out_w, int out_h, ResizeMethod method)> run;
+};
+
+// The registered kernels: the backends (on the active x86-64 level) and the row
+// kernels of every level this CPU runs, called directly (fused_<level>, separable_<level>).
+std::vector<ConformanceKernel> conformance_kernels();
+
+struct ConformanceSpec {
+    int cases = 200;                    // randomized cases, each run for every kernel x method
+    std::uint64_t seed = 1;
+    int max_side = 257;                 // side limit of the random-size cases
+    std::vector<std::string> filter;    // kernel names to run; empty = all
+};
+
+struct ConformanceResult {
+    std::string kernel;
+    ResizeMethod method = ResizeMethod::Nearest;
+    std::string isa;
+    std::string backend;
+    std::string precision;
+    int budget = 0;
+    int cases = 0;
+    int failures = 0;                   // cases with max_abs > budget (or an exception)
+    int max_abs = 0;                    // worst over the cases
+    std::uint64_t different_values = 0;
+    std::string first_failure;          // case description and first differing value
+};
+
+// Cases are generated once from the seed and shared by all kernels.
+std::vector<ConformanceResult> run_conformance(const ConformanceSpec& spec, std::ostream& log);
+
+void write_conformance_results(const std::vector<ConformanceResult>& results, const std::string& path);
+void print_conformance_summary(const std::vector<ConformanceResult>& results, std::ostream& os);
@@ -0,0 +1,80 @@
+// detect.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Batch scaling-attack screening used by the detect mode.
+// A scaling attack hides a target image in the few source pixels a downscaler
+// samples, so downscaling the image to the model input size and scaling it
+// back (bilinear) gives something far from the image itself: benign images reconstruct
+// with a high PSNR, attack images with a low one. Every file is first screened
+// on a subset of rows and only files that are not clearly benign get the
+// full comparison. Payloads too faint to pull the PSNR down are caught by the
+// spectral detector (spectral.hpp), which looks for the sampling lattice in
+// the spectrum; a file is an attack when either detector flags it.
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+#include "resize.hpp"
+#include "spectral.hpp"
+
+struct DetectSpec {
+    std::string input_dir;               // every image file in it (png, jpg, jpeg, bmp, tga, gif, psd)
+    bool recursive = false;
+    int target_w = 224;                  // size the ML preprocessing downscales to
+    int target_h = 224;
+    std::vector<ResizeMethod> methods = {ResizeMethod::Nearest, ResizeMethod::Bilinear}; // downscalers screened
+    double threshold_db = 20.0;          // attack if the reconstruction PSNR is below this
+    double coarse_margin_db = 3.0;       // coarse pass accepts as benign at threshold + margin and above
+    int coarse_row_step = 8;             // coarse pass compares every n-th row
+    bool use_spectral = true;
+    SpectralSpec spectral;
+    int threads = 0;                     // files processed in parallel; 0 = OpenMP default
+};
+
+enum class DetectVerdict { Benign, Attack, Error };
+
+struct DetectResult {
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    DetectVerdict verdict = DetectVerdict::Error;
+    double score_db = 0.0;          // lowest reconstruction PSNR over the screened methods
+    std::vector<double> psnr_db;    // per screened method, from the last pass run
+    bool full_pass = false;         // false: decided by the coarse pass
+    bool psnr_flag = false;         // reconstruction PSNR below the threshold
+    SpectralResult spectral;
+    bool spectral_flag = false;     // spectral score at or above its threshold
+    double decode_ms = 0.0;
+    double analyze_ms = 0.0;
+    std::string error;
+};
+
+struct DetectReport {
+    std::vector<DetectResult> files; // sorted by path
+    int benign = 0;
+    int attacks = 0;
+    int errors = 0;
+    int early_exits = 0;
+    int spectral_only = 0;           // attacks the PSNR test alone would have missed
+    double wall_ms = 0.0;
+    [[nodiscard]] double images_per_sec() const;
+};
+
+// Image files of the directory, sorted by path.
+std::vector<std::string> detect_list_files(const std::string& dir, bool recursive);
+
+// Screens one decoded image (sequential; the batch runs files in parallel).
+DetectResult detect_image(const Image& img, const DetectSpec& spec);
+
+// Decodes and screens every file of spec.input_dir, files distributed dynamically
+// over the OpenMP team. Unreadable files are reported with verdict Error.
+DetectReport run_detect(const DetectSpec& spec, std::ostream& log);
+
+void write_detect_results(const DetectReport& rep, const DetectSpec& spec, const std::string& path);
+void print_detect_summary(const DetectReport& rep, const DetectSpec& spec, std::ostream& os);
+
+const char* detect_verdict_name(DetectVerdict v);
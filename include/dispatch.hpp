@@ -0,0 +1,65 @@
+// dispatch.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Runtime selection of the resampling row kernels (nearest, bilinear, hpass,
+// vpass) across x86-64 microarchitecture levels. src/kernels_isa.cpp is
+// compiled once per level (baseline, -march=x86-64-v2, -v3, -v4) into one
+// binary; the best level the CPU supports is resolved on the first kernel call
+// and every public kernel of kernels.hpp forwards through its table. All levels
+// produce bit-identical results.
+//
+// The selection can be overridden with the RESIZER_ISA environment variable or
+// the --isa option (baseline, v2, v3, v4 or auto); the active level is
+// recorded as isa_level in the result metadata.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class IsaLevel { Baseline, V2, V3, V4 };
+
+// Raw-pointer forms of the kernels.hpp row kernels (ColumnMap fields passed as arrays).
+struct KernelTable {
+    IsaLevel level;
+    void (*nearest_row)(const std::uint8_t* src, std::uint8_t* dst, const int* x0, int out_w, int channels);
+    void (*bilinear_row)(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst,
+                         const int* x0, const int* x1, const float* wx, float wy, int out_w, int channels);
+    void (*hpass_row)(const std::uint8_t* src, float* dst, const int* x0, const int* x1, const float* wx,
+                      int out_w, int channels);
+    void (*vpass_row)(const float* h0, const float* h1, std::uint8_t* dst, float wy, int n);
+};
+
+// Table in use by the kernels.hpp entry points.
+const KernelTable& active_kernels();
+
+// Table of one level, or nullptr if that level was not compiled in or the CPU lacks it.
+const KernelTable* kernel_table(IsaLevel level);
+
+// Overrides the selection for the rest of the process (call before starting work).
+// Throws std::runtime_error if the level is not available.
+void force_isa_level(IsaLevel level);
+
+// Back to the automatically detected level.
+void reset_isa_level();
+
+// Highest level the CPU supports among the compiled ones.
+IsaLevel detected_isa_level();
+
+// Levels built into this binary, lowest first (always includes Baseline).
+std::vector<IsaLevel> compiled_isa_levels();
+
+// "x86-64", "x86-64-v2", "x86-64-v3", "x86-64-v4".
+const char* isa_level_name(IsaLevel level);
+
+// Accepts the level names above and baseline, v2, v3, v4; throws std::invalid_argument otherwise.
+IsaLevel parse_isa_level(const std::string& s);
+
+// Applies an --isa / RESIZER_ISA value: "auto" resets, anything else forces that level.
+void apply_isa_option(const std::string& s);
+
+// Per-level table definitions (one per compiled level, see src/kernels_isa.cpp).
+const KernelTable& kernel_table_baseline();
+const KernelTable& kernel_table_v2();
+const KernelTable& kernel_table_v3();
+const KernelTable& kernel_table_v4();
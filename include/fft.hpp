@@ -0,0 +1,60 @@
+// fft.hpp
+// Created by Francesco on 17/10/2026.
+//
+// In-tree FFT used by the spectral scaling-attack detector.
+// Mixed-radix Stockham autosort transforms (radix 4, 2, 3, 5 and a generic
+// stage for other prime factors, so any length works) on split real/imaginary
+// arrays. A transform runs on a batch of sequences stored interleaved: element
+// j of sequence b is at j * count + b. The innermost loops therefore run over
+// the batch with unit stride and no shuffles, and the compiler vectorizes them
+// (SSE2 baseline). Batches are split into column blocks across OpenMP threads.
+#pragma once
+
+#include <complex>
+#include <vector>
+
+class FftPlan {
+public:
+    explicit FftPlan(int n);
+
+    [[nodiscard]] int size() const noexcept { return n_; }
+
+    // In-place forward transform (sum of x[j] * e^{-2 pi i jk/n}, unscaled) of
+    // `count` interleaved sequences; re and im hold n * count floats.
+    // threads: 0 = OpenMP default.
+    void forward_batch(float* re, float* im, int count, int threads = 0) const;
+
+private:
+    struct Stage {
+        int radix = 0;
+        int m = 0;          // butterflies per group: length of the sub-transform / radix
+        int stride = 0;     // s: groups already split off by earlier stages
+        std::size_t tw = 0; // offset of this stage's twiddles, (radix - 1) per butterfly
+    };
+
+    void run_block(float* re, float* im, int count, int cw, float* xr, float* xi, float* yr, float* yi) const;
+
+    int n_ = 0;
+    std::vector<Stage> stages_;
+    std::vector<float> tw_re_;
+    std::vector<float> tw_im_;
+};
+
+// Non-redundant half of the 2D DFT of a real w x h plane: frequencies k (along y)
+// 0..h/2 and l (along x) 0..w-1. The other half follows from F(k, l) = conj F(-k, -l).
+struct HalfSpectrum {
+    int width = 0;              // input size
+    int height = 0;
+    int rows = 0;               // height / 2 + 1
+    std::vector<float> re;      // index l * rows + k
+    std::vector<float> im;
+
+    // F(k, l) for any integer k, l (periodic, conjugate-symmetric).
+    [[nodiscard]] std::complex<float> at(int k, int l) const;
+    [[nodiscard]] float power(int k, int l) const { return std::norm(at(k, l)); }
+};
+
+// Real-input 2D FFT. Column pass first, packing two real columns into one
+// complex sequence; the row pass then only transforms the h/2 + 1 rows the
+// Hermitian symmetry does not give for free.
+HalfSpectrum real_fft2d(const float* data, int w, int h, int threads = 0);
@@ -0,0 +1,61 @@
+// hash.hpp
+// Created by Francesco on 17/10/2026.
+//
+// 128-bit content hashes of images for golden-output regression checks.
+// The hash follows the XXH3 construction (not bit-compatible with xxHash):
+// 64-byte stripes accumulated into eight 64-bit lanes (SSE2 where available),
+// a scramble every 1 KiB block and a 128-bit fold-and-avalanche finalization.
+// Images are hashed in fixed 1 MiB chunks on the OpenMP team and the chunk
+// digests are hashed again in chunk order, so the value depends only on the
+// pixels and the image shape, never on the thread count.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+#include "results.hpp"
+
+struct ContentHash {
+    std::uint64_t hi = 0;
+    std::uint64_t lo = 0;
+
+    // 32 lowercase hex digits, hi first.
+    [[nodiscard]] std::string hex() const;
+    [[nodiscard]] bool operator==(const ContentHash&) const = default;
+};
+
+// One-shot hash of a byte range (single-threaded).
+ContentHash hash_bytes(const std::uint8_t* data, std::size_t n, std::uint64_t seed = 0);
+
+// Hash of the pixels and of width, height and channels (threads: 0 = OpenMP default).
+ContentHash hash_image(const Image& img, int threads = 0);
+
+// Parses hex() output; throws std::invalid_argument on anything else.
+ContentHash parse_content_hash(const std::string& s);
+
+// Golden-output manifests: one row per image, written with ResultWriter (CSV or
+// JSON by extension) and read back with read_result_table.
+struct ManifestEntry {
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    ContentHash hash;
+};
+
+std::vector<std::string> hash_manifest_columns();
+std::vector<ResultValue> hash_manifest_row(const std::string& path, const Image& img, const ContentHash& hash);
+
+// Entries by path; when a path appears more than once (CSV manifests are appended
+// to), the last row wins.
+std::map<std::string, ManifestEntry> read_hash_manifest(const std::string& path);
+
+// Records one image in a manifest that may already exist. CSV manifests get the
+// row appended; a JSON manifest is rewritten whole, so its existing entries are
+// read back and merged (the row for the same path is replaced).
+void record_hash_manifest(const std::string& manifest_path, const std::string& path, const Image& img,
+                          const ContentHash& hash);
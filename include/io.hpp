@@ -5,7 +5,9 @@
 // Loads images into the project Image structure and saves PNG/JPG outputs.
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "image.hpp"
 
 Image load_image(const std::string& path, int requested_channels = 0);
@@ -15,7 +17,24 @@ Image load_image(const std::string& path, int requested_channels = 0);
  * 1 = force grayscale
  * 3 = force RGB
  * 4 = force RGBA
+ *
+ * path may also be "synthetic:WxHxC:pattern:seed" (see synthetic.hpp).
  */
 
 void save_png(const Image& img, const std::string& path, int compression_level = 3);
 void save_jpg(const Image& img, const std::string& path, int quality = 95);
+
+// The stages behind load_image / save_png / save_jpg, exposed separately so that
+// file I/O, decoding, channel conversion and encoding can be timed on their own.
+std::vector<std::uint8_t> read_file(const std::string& path);
+void write_file(const std::string& path, const std::vector<std::uint8_t>& bytes);
+
+// name is only used in error messages.
+Image decode_image(const std::vector<std::uint8_t>& bytes, int requested_channels = 0,
+                   const std::string& name = "<memory>");
+
+std::vector<std::uint8_t> encode_png(const Image& img, int compression_level = 3);
+std::vector<std::uint8_t> encode_jpg(const Image& img, int quality = 95); // drops alpha if present
+
+// RGBA -> RGB, as done before JPG encoding.
+Image drop_alpha(const Image& img);
@@ -0,0 +1,115 @@
+// kernels.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Row-level building blocks shared by the resize backends, I/O and validation.
+// Each kernel works on plain row buffers (no Image), so it can be benchmarked in
+// isolation by resize_microbench. Column sampling positions are precomputed once
+// per resize in a ColumnMap; the float expressions are exactly those of the
+// original per-pixel loops, so results are bit-identical. The resampling kernels
+// (nearest, bilinear, hpass, vpass) run the build for the CPU's x86-64 level
+// (dispatch.hpp).
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "resize.hpp"
+
+// pixel center mapping: (x + 0.5) * (in/out) - 0.5
+inline float map_coord(float out_coord, float in_size, float out_size) {
+    return (out_coord + 0.5f) * (in_size / out_size) - 0.5f;
+}
+
+// Source columns for every output column.
+// Nearest uses x0 only; bilinear uses x0, x1 and the weight wx of x1.
+struct ColumnMap {
+    std::vector<int> x0;
+    std::vector<int> x1;
+    std::vector<float> wx;
+};
+
+ColumnMap make_column_map(int in_w, int out_w, ResizeMethod method);
+
+// Source row and weight for output row y (nearest: y0 only, wy = 0).
+struct RowTap {
+    int y0 = 0;
+    int y1 = 0;
+    float wy = 0.0f;
+};
+
+RowTap row_tap(int y, int in_h, int out_h, ResizeMethod method);
+
+// dst[x] = src[x0[x]] for every channel.
+void nearest_row(const std::uint8_t* src, std::uint8_t* dst, const ColumnMap& cm, int out_w, int channels);
+
+// Fused bilinear: horizontal interpolation of row0/row1 followed by vertical blend.
+void bilinear_row(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst,
+                  const ColumnMap& cm, float wy, int out_w, int channels);
+
+// Separable halves of bilinear_row (same arithmetic, float intermediate row).
+void hpass_row(const std::uint8_t* src, float* dst, const ColumnMap& cm, int out_w, int channels);
+void vpass_row(const float* h0, const float* h1, std::uint8_t* dst, float wy, int n);
+
+// RGBA -> RGB (drop alpha), n pixels.
+void rgba_to_rgb_row(const std::uint8_t* src, std::uint8_t* dst, std::size_t n);
+
+// Byte-wise |a - b| statistics over n values: updates max_abs and adds to nonzero.
+// Scalar reference for absdiff_stats.
+void compare_row(const std::uint8_t* a, const std::uint8_t* b, std::size_t n,
+                 int& max_abs, std::uint64_t& nonzero);
+
+// |a - b| statistics accumulated over one or more byte ranges.
+struct AbsDiffAccum {
+    int max_abs = 0;
+    std::uint64_t nonzero = 0; // values with a != b
+    std::uint64_t sum = 0;     // sum of |a - b| (SAD)
+};
+
+// Vectorized (SSE2 where available) |a - b| over n values. When hist is not null,
+// hist[d] is incremented for every non-zero difference d; zero differences are
+// not counted (they are n - nonzero).
+void absdiff_stats(const std::uint8_t* a, const std::uint8_t* b, std::size_t n,
+                   AbsDiffAccum& acc, std::uint64_t* hist);
+
+// Index of the first i with a[i] != b[i], or n if the ranges are equal.
+std::size_t first_mismatch(const std::uint8_t* a, const std::uint8_t* b, std::size_t n);
+
+// Sum of (a - b)^2 over n values (SSE2 where available).
+std::uint64_t sqdiff_sum(const std::uint8_t* a, const std::uint8_t* b, std::size_t n);
+
+// Side of the SSIM window (Gaussian, 11 taps).
+inline constexpr int ssim_window = 11;
+
+// One row of the five local moments SSIM is built from (n floats each).
+struct SsimRows {
+    float* x;   // E[a]
+    float* y;   // E[b]
+    float* xx;  // E[a^2]
+    float* yy;  // E[b^2]
+    float* xy;  // E[a*b]
+};
+
+// Horizontal window pass of SSIM over w pixels of a and b: writes the moment rows
+// for the (w - ssim_window + 1) * channels "valid" positions. tmp holds 5 * w * channels floats.
+void ssim_hpass_row(const std::uint8_t* a, const std::uint8_t* b, int w, int channels,
+                    const float* taps, float* tmp, const SsimRows& out);
+
+// Vertical window pass: out = sum over k < ssim_window of taps[k] * in[k], per moment, n values.
+void ssim_vpass_row(const SsimRows* in, const float* taps, int n, const SsimRows& out);
+
+// SSIM and contrast-structure terms of n filtered values, added position-wise to
+// ssim_acc[i] and cs_acc[i] (callers reduce them per channel every few rows).
+void ssim_map_row(const SsimRows& m, int n, float c1, float c2, float* ssim_acc, float* cs_acc);
+
+// Content hash stripes (XXH3-style accumulation, see hash.hpp): 64-byte stripes
+// feed eight 64-bit lanes.
+inline constexpr std::size_t hash_stripe_bytes = 64;
+inline constexpr int hash_lanes = 8;
+
+// Accumulates `stripes` consecutive stripes of data into acc; stripe s is keyed
+// with keys[s .. s + 7] (keys holds stripes + 7 values). Per lane i:
+// acc[i ^ 1] += d[i]; acc[i] += lo32(d[i] ^ k[i]) * hi32(d[i] ^ k[i]).
+void hash_accumulate(std::uint64_t* acc, const std::uint8_t* data, std::size_t stripes, const std::uint64_t* keys);
+
+// acc[i] = (acc[i] ^ (acc[i] >> 47) ^ keys[i]) * 0x9E3779B1 after every block.
+void hash_scramble(std::uint64_t* acc, const std::uint64_t* keys);
@@ -0,0 +1,30 @@
+// metadata.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Environment and run metadata embedded in JSON result files, so that results
+// from different machines, compilers or builds can be told apart later.
+// All fields are flat (name, value) pairs; see ResultWriter for the file layout.
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "results.hpp"
+
+using MetadataFields = std::vector<std::pair<std::string, ResultValue>>;
+
+// Host, OS, build and runtime description: CPU model, logical/physical CPU
+// counts, cache sizes, ISA extensions, row kernel level (selected, detected and
+// compiled, see dispatch.hpp), kernel, frequency governor, compiler and
+// flags, build type, OpenMP version, git revision and the UTC time of the run.
+// Collected once, on the first call; unknown values read "unknown" or -1.
+const MetadataFields& environment_metadata();
+
+// Process-wide run parameters (command line and resolved options), set once by
+// the entry point and copied into every JSON result file written afterwards.
+void set_run_parameters(MetadataFields params);
+const MetadataFields& run_parameters();
+
+// argv joined with spaces (arguments containing spaces are double-quoted).
+std::string command_line(int argc, char** argv);
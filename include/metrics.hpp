@@ -0,0 +1,56 @@
+// metrics.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Full-reference image quality metrics: MAE/MSE/PSNR, SSIM and MS-SSIM.
+// All of them take two images of identical size and channel count and are
+// parallelized with OpenMP (threads: 0 = OpenMP default). Work is split into
+// fixed tiles whose partial sums are combined in tile order, so results do not
+// depend on the thread count.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "image.hpp"
+
+struct ErrorMetrics {
+    double mae = 0.0;   // mean |a-b| over all channel values
+    double mse = 0.0;
+    double rmse = 0.0;
+    double psnr = 0.0;  // dB (peak 255); +infinity for identical images
+    int max_abs = 0;
+};
+
+// SIMD sums of |a-b| and (a-b)^2 over 1 MiB chunks. Exact: the sums are integers.
+ErrorMetrics error_metrics(const Image& a, const Image& b, int threads = 0);
+
+// Mean SSIM (Wang et al. 2004: 11x11 Gaussian window, sigma 1.5, K1 = 0.01,
+// K2 = 0.03) over the positions where the window fits entirely in the image.
+// Computed per channel; the alpha channel of RGBA images is reported but not
+// included in the overall value.
+struct SsimResult {
+    double ssim = 0.0;            // mean over the color channels
+    std::vector<double> channels; // per-channel mean SSIM
+    std::vector<double> cs;       // per-channel mean contrast-structure term (used by MS-SSIM)
+};
+
+// Separable window, computed in row-band tiles: each thread slides the 11-row
+// window down its band, filtering every source row once. Images must be at
+// least 11x11.
+SsimResult ssim(const Image& a, const Image& b, int threads = 0);
+
+// Direct 2D window in double precision, single-threaded. Slow; for validation.
+SsimResult ssim_reference(const Image& a, const Image& b);
+
+struct MsSsimResult {
+    double ms_ssim = 0.0;         // mean over the color channels
+    std::vector<double> channels; // per-channel MS-SSIM
+    int scales = 0;               // scales evaluated (fewer than 5 for small images)
+};
+
+// Multi-scale SSIM (Wang, Simoncelli, Bovik 2003) with the standard five scale
+// weights. Each scale is a 2x bilinear downscale of the previous one through
+// resize_omp (a 2x2 average at even sizes, rounded to 8 bits). Scales whose
+// smaller side would drop below the window size are skipped and the remaining
+// weights renormalized; negative cs terms are clamped to 0.
+MsSsimResult ms_ssim(const Image& a, const Image& b, int threads = 0);
@@ -0,0 +1,60 @@
+// perf_counters.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Hardware performance counters via Linux perf_event_open.
+// A PerfCounterSet opens one counter per event on every thread that will run
+// the measured code (the calling thread plus the OpenMP team), so counts are
+// aggregated over all worker threads. When counters cannot be opened (non-Linux,
+// containers, VMs, perf_event_paranoid) the set degrades to "unavailable" and
+// all values read as -1 instead of failing the benchmark.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct PerfCounters {
+    // -1 means "not available on this host"
+    std::int64_t cycles = -1;
+    std::int64_t instructions = -1;
+    std::int64_t l1d_misses = -1;     // L1D read misses
+    std::int64_t llc_misses = -1;     // last-level cache misses
+    std::int64_t branch_misses = -1;
+    std::int64_t dtlb_misses = -1;    // dTLB read misses
+
+    [[nodiscard]] bool any() const noexcept {
+        return cycles >= 0 || instructions >= 0 || l1d_misses >= 0 ||
+               llc_misses >= 0 || branch_misses >= 0 || dtlb_misses >= 0;
+    }
+
+    [[nodiscard]] double ipc() const noexcept {
+        return (cycles > 0 && instructions >= 0)
+            ? static_cast<double>(instructions) / static_cast<double>(cycles) : -1.0;
+    }
+};
+
+class PerfCounterSet {
+public:
+    // threads: size of the OpenMP team the measured code will use (0 = OpenMP default,
+    // 1 = calling thread only).
+    explicit PerfCounterSet(int threads);
+    ~PerfCounterSet();
+
+    PerfCounterSet(const PerfCounterSet&) = delete;
+    PerfCounterSet& operator=(const PerfCounterSet&) = delete;
+
+    [[nodiscard]] bool available() const noexcept;
+    // Short reason when unavailable (e.g. "perf_event_open: Permission denied").
+    [[nodiscard]] const std::string& status() const noexcept;
+
+    void reset();
+    void start();
+    void stop();
+
+    // Sum over threads, scaled for multiplexing.
+    [[nodiscard]] PerfCounters read() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,70 @@
+// pipeline.hpp
+// Created by Francesco on 17/10/2026.
+//
+// End-to-end pipeline benchmark: file read -> decode -> resize -> channel
+// conversion -> encode -> file write, with every phase timed separately on
+// every repetition. Reports per-phase percentiles and the share of wall time
+// each phase takes, for one or more output codec settings.
+#pragma once
+
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "resize.hpp"
+
+enum class Codec { Png, Jpg };
+
+struct CodecSetting {
+    Codec codec = Codec::Png;
+    int level = 3; // PNG compression level 0..9, JPG quality 1..100
+};
+
+enum class PipelinePhase { Read, Decode, Resize, Convert, Encode, Write };
+inline constexpr int pipeline_phase_count = 6;
+
+struct PipelineSpec {
+    std::string input_path;    // image file, or a synthetic: spec (encoded to PNG once)
+    std::string output_prefix; // outputs are <prefix>.png / <prefix>.jpg
+    int out_w = 0;
+    int out_h = 0;
+    ResizeMethod method = ResizeMethod::Bilinear;
+    Backend backend = Backend::Sequential;
+    int threads = 0;
+    int warmup = 2;
+    int runs = 10;
+    std::vector<CodecSetting> codecs = {{Codec::Png, 3}};
+};
+
+struct PhaseStats {
+    double mean_ms = 0.0;
+    double median_ms = 0.0;
+    double p90_ms = 0.0;
+    double p99_ms = 0.0;
+    double share = 0.0; // fraction of total wall time over all runs
+};
+
+struct PipelineResult {
+    CodecSetting codec;
+    int in_w = 0, in_h = 0, channels = 0;
+    std::size_t input_bytes = 0;   // encoded input file size
+    std::size_t output_bytes = 0;  // encoded output size
+    std::array<std::vector<double>, pipeline_phase_count> samples; // ms per run, per phase
+    std::vector<double> wall_ms;                                   // ms per run, whole pipeline
+    std::array<PhaseStats, pipeline_phase_count> phases;
+    PhaseStats wall;
+};
+
+std::vector<PipelineResult> run_pipeline_bench(const PipelineSpec& spec, std::ostream& log);
+
+void print_pipeline_summary(const std::vector<PipelineResult>& results, std::ostream& os);
+
+// One row per codec x phase (plus a "total" row); CSV or JSON by extension.
+void write_pipeline_results(const std::vector<PipelineResult>& results, const PipelineSpec& spec,
+                            const std::string& path);
+
+// "png", "png:6", "jpg", "jpg:80"
+CodecSetting parse_codec_setting(const std::string& s);
+std::string codec_setting_name(const CodecSetting& c);
+const char* pipeline_phase_name(PipelinePhase p);
@@ -0,0 +1,80 @@
+// resize_operator.hpp
+// Created by Francesco on 17/10/2026.
+//
+// The resize operator as sparse sampling matrices.
+// Nearest and bilinear resizes are separable: out = Wy * in * Wx^T, where the
+// vertical factor Wy (out_h x in_h) and the horizontal factor Wx (out_w x in_w)
+// have at most two non-zero weights per row. Both factors are stored in CSR form
+// and built from the same row_tap / make_column_map the resize kernels use, so
+// they describe exactly which source pixels every output pixel reads.
+// This makes scaling-attack auditing cheap: the influence of each source pixel
+// on the output is a product of two column sums, no resize needed.
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "image.hpp"
+#include "resize.hpp"
+
+// Compressed sparse rows: the entries of row r are [row_ptr[r], row_ptr[r + 1]).
+struct SparseMatrix {
+    int rows = 0;
+    int cols = 0;
+    std::vector<int> row_ptr;   // rows + 1 offsets
+    std::vector<int> col_idx;   // ascending within a row
+    std::vector<float> val;
+
+    [[nodiscard]] std::size_t nnz() const noexcept { return col_idx.size(); }
+};
+
+struct ResizeOperator {
+    int in_w = 0;
+    int in_h = 0;
+    int out_w = 0;
+    int out_h = 0;
+    ResizeMethod method = ResizeMethod::Nearest;
+    SparseMatrix rows_op; // out_h x in_h
+    SparseMatrix cols_op; // out_w x in_w
+};
+
+// Zero weights are dropped and clamped duplicate taps merged, so a row holds one
+// entry (weight 1) or two entries (1 - w, w). Weights can be negative where
+// bilinear upscaling extrapolates at the left/top border.
+ResizeOperator resize_operator(int in_w, int in_h, int out_w, int out_h, ResizeMethod method);
+
+// How much each source pixel contributes to the output: the sum over all output
+// pixels of |weight| (per channel; channels do not mix). Separable, so it is
+// stored as one factor per source column and per source row.
+struct InfluenceMap {
+    int width = 0;                    // source size
+    int height = 0;
+    std::vector<float> col_weight;    // sum over output columns of |Wx(ox, x)|
+    std::vector<float> row_weight;    // sum over output rows of |Wy(oy, y)|
+    std::vector<int> col_count;       // output columns reading source column x
+    std::vector<int> row_count;
+
+    [[nodiscard]] float weight(int x, int y) const { return col_weight[x] * row_weight[y]; }
+    [[nodiscard]] int outputs(int x, int y) const { return col_count[x] * row_count[y]; }
+
+    // Source pixels with a non-zero influence: the only ones an attacker needs to
+    // control to change the output.
+    [[nodiscard]] std::size_t influential_pixels() const;
+    [[nodiscard]] double influential_fraction() const;
+};
+
+InfluenceMap influence_map(const ResizeOperator& op);
+
+// width x height weights, row-major (OpenMP, threads: 0 = default).
+std::vector<float> influence_dense(const InfluenceMap& map, int threads = 0);
+
+// The map as a grayscale image scaled so the largest weight is 255; pixels that
+// influence nothing are 0.
+Image influence_image(const InfluenceMap& map, int threads = 0);
+
+// Applies the operator to every image of the batch (each in_w x in_h, any channel
+// count). Two-entry rows are evaluated as v0 + w * (v1 - v0), the form of the
+// resize kernels, so the bytes equal resize(img, out_w, out_h, method, ...).
+// The (image, output row) pairs of the whole batch are split across the OpenMP
+// team, so many small images parallelize as well as one large one.
+std::vector<Image> apply_resize_operator(const ResizeOperator& op, const std::vector<Image>& batch, int threads = 0);
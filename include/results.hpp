@@ -0,0 +1,67 @@
+// results.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Buffered writer for tidy benchmark tables (one row per configuration).
+// Rows are kept in memory and written in one go on flush(), instead of
+// reopening the output file for every row. The format follows the file
+// extension: ".json" writes a self-describing document, anything else is CSV:
+//
+//   { "environment": { host/build metadata, see metadata.hpp },
+//     "parameters":  { run parameters },
+//     "results":     [ { column: value, ... }, ... ] }
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using ResultValue = std::variant<std::string, std::int64_t, double>;
+
+class ResultWriter {
+public:
+    // CSV files are appended to (header written only if the file is new or empty),
+    // JSON files are rewritten on every flush with all rows collected so far.
+    ResultWriter(std::string path, std::vector<std::string> columns);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    void add_row(std::vector<ResultValue> values);
+    void flush();
+
+    // Writer-specific run parameter, recorded after the process-wide ones (see
+    // set_run_parameters); replaces an earlier value with the same name. JSON only:
+    // CSV files carry no metadata.
+    void set_parameter(const std::string& name, ResultValue value);
+
+    [[nodiscard]] const std::string& path() const noexcept { return path_; }
+    [[nodiscard]] bool is_json() const noexcept { return json_; }
+
+private:
+    std::string path_;
+    std::vector<std::string> columns_;
+    bool json_ = false;
+    std::vector<std::pair<std::string, ResultValue>> params_;
+
+    std::vector<std::vector<ResultValue>> rows_; // all rows (JSON) or pending rows (CSV)
+};
+
+// A result file read back (CSV or JSON written by ResultWriter; a bare JSON array
+// of objects is also accepted). Values are kept as text; JSON null reads as "".
+// Used by tools that post-process results.
+struct ResultTable {
+    std::vector<std::string> columns;
+    std::vector<std::vector<std::string>> rows;
+    std::map<std::string, std::string> environment; // JSON only
+    std::map<std::string, std::string> parameters;  // JSON only
+
+    // Index of a column, or -1 if absent.
+    [[nodiscard]] int column(std::string_view name) const;
+};
+
+ResultTable read_result_table(const std::string& path);
@@ -0,0 +1,66 @@
+// scaling.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Thread-scaling experiments for the OpenMP backend.
+// Strong scaling keeps the output size fixed while the thread count grows;
+// weak scaling grows the output area proportionally to the thread count.
+// For each point we report speedup, parallel efficiency and the Karp-Flatt
+// serial fraction, plus least-squares Amdahl (strong) and Gustafson (weak) fits.
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+#include "resize.hpp"
+
+struct ScalingSpec {
+    int out_w = 0;              // strong size, and weak size at 1 thread
+    int out_h = 0;
+    ResizeMethod method = ResizeMethod::Bilinear;
+    std::vector<int> threads;   // empty => 1..hardware threads
+    ParallelOptions popt;
+
+    int warmup = 2;
+    int runs = 10;
+    int inner_reps = 1;
+
+    bool strong = true;
+    bool weak = true;
+    bool thread_stats = false; // per-thread accounting (BenchOptions::thread_stats)
+};
+
+struct ScalingPoint {
+    int threads = 0;
+    int out_w = 0;
+    int out_h = 0;
+    double mean_ms = 0.0;
+    double stddev_ms = 0.0;
+    double speedup = 0.0;       // strong: T1/Tp; weak: scaled speedup p*T1/Tp
+    double efficiency = 0.0;    // speedup / p
+    double serial_fraction = 0.0; // Karp-Flatt (strong) or Gustafson alpha (weak), per point
+    double imbalance = -1.0;      // thread_stats only, see BenchResult
+    double idle_fraction = -1.0;
+};
+
+struct ScalingReport {
+    std::vector<ScalingPoint> strong;
+    std::vector<ScalingPoint> weak;
+    double amdahl_serial = 0.0;    // fitted over all strong points
+    double gustafson_serial = 0.0; // fitted over all weak points
+};
+
+// Thread count list 1..n, where n is the number of hardware threads.
+std::vector<int> default_thread_ladder();
+
+// Least-squares fits. Points with p == 1 carry no information and are skipped.
+double fit_amdahl_serial_fraction(const std::vector<ScalingPoint>& pts);
+double fit_gustafson_serial_fraction(const std::vector<ScalingPoint>& pts);
+
+ScalingReport run_scaling(const Image& img, const ScalingSpec& spec, std::ostream& log);
+
+// One row per point (kind = strong|weak); CSV or JSON by extension.
+void write_scaling_report(const ScalingReport& rep, const ScalingSpec& spec, const Image& img,
+                          const std::string& path);
+void print_scaling_summary(const ScalingReport& rep, std::ostream& os);
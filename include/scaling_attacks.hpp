@@ -4,6 +4,7 @@
 // Scaling-attack utilities.
 // Implements a downscale->upscale pipeline and computes simple distortion metrics.
 // This is useful to analyze robustness of resizing methods against adversarial scaling artifacts.
+// Only the downscaled image is materialized: the reconstruction is compared row by row.
 #pragma once
 
 #include "image.hpp"
@@ -16,6 +17,9 @@ struct AttackMetrics {
     int max_abs = 0;         // max absolute difference (0..255)
 };
 
+// Resizes src to down_w x down_h with down_method, scales it back with up_method
+// and compares the result with src. Peak extra memory is the downscaled image plus
+// a few rows per thread.
 AttackMetrics down_up_metrics(
     const Image& src,
     int down_w, int down_h,
@@ -24,3 +28,24 @@ AttackMetrics down_up_metrics(
     Backend backend,
     int threads
 );
+
+// Compares src with down upscaled to src's size by up_method, generating the
+// upscaled rows on the fly (same bytes as resize()). OpenMP backend: rows are
+// split across threads, each accumulating its own integer sums.
+// row_step > 1 compares only every row_step-th row: a cheap estimate.
+AttackMetrics reconstruction_metrics(
+    const Image& src,
+    const Image& down,
+    ResizeMethod up_method,
+    Backend backend,
+    int threads,
+    int row_step = 1
+);
+
+// Materializes the upscaled image (sequential resize + error_metrics); for validation.
+AttackMetrics down_up_metrics_reference(
+    const Image& src,
+    int down_w, int down_h,
+    ResizeMethod down_method,
+    ResizeMethod up_method
+);
@@ -0,0 +1,35 @@
+// spectral.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Spectral scaling-attack detector.
+// An attack image carries its payload on the lattice of source pixels the
+// downscaler samples, one every (source / target) pixels. That lattice shows up
+// in the 2D spectrum as peaks at the multiples of the sampling frequency, which
+// natural images do not have. The detector averages the power spectrum of a few
+// tiles of the luma plane and compares the peak power at each lattice
+// frequency with the power at a control point half a lattice step away; both
+// are measured against the median of their local neighbourhood.
+#pragma once
+
+#include "image.hpp"
+
+struct SpectralSpec {
+    int tile = 256;              // FFT tile side; halved until the image holds it
+    int max_tiles = 4;           // tiles analyzed, spread evenly over the image
+    double threshold_db = 6.0;   // attack if the lattice/control excess reaches this
+};
+
+struct SpectralResult {
+    bool applicable = false;     // false when no lattice frequency fits (stride < 2 or image too small)
+    double stride_x = 0.0;       // source pixels per target pixel
+    double stride_y = 0.0;
+    int tile = 0;                // tile side used
+    int tiles = 0;
+    int peaks = 0;               // lattice frequencies evaluated
+    double lattice_db = 0.0;     // median peak excess over the local background at the lattice frequencies
+    double control_db = 0.0;     // same, at the control points
+    double score_db = 0.0;       // median over the lattice frequencies of (lattice - control) excess
+};
+
+// threads: 0 = OpenMP default (used inside each tile's FFT).
+SpectralResult spectral_scan(const Image& img, int target_w, int target_h, const SpectralSpec& spec, int threads = 0);
@@ -0,0 +1,40 @@
+// stats.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Descriptive and robust statistics for benchmark samples.
+// Besides mean/stddev, provides order statistics (median, percentiles),
+// MAD-based outlier rejection and percentile-bootstrap confidence intervals,
+// which are far less sensitive to occasional scheduler hiccups.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+double mean(const std::vector<double>& v);
+double stddev_sample(const std::vector<double>& v, double mu);
+
+// p in [0, 100]; linear interpolation between closest ranks (same as numpy's default).
+double percentile(std::vector<double> v, double p);
+double median(std::vector<double> v);
+
+// Median absolute deviation (raw, not scaled by 1.4826).
+double mad(const std::vector<double>& v, double med);
+
+// Keeps samples with |x - median| <= k * 1.4826 * MAD (i.e. k robust sigmas).
+// If MAD is 0 all samples are kept. rejected (optional) receives the number dropped.
+std::vector<double> reject_outliers_mad(const std::vector<double>& v, double k = 3.5, int* rejected = nullptr);
+
+struct ConfInterval {
+    double lo = 0.0;
+    double hi = 0.0;
+    [[nodiscard]] double half_width() const noexcept { return 0.5 * (hi - lo); }
+};
+
+// Percentile bootstrap CI of the median. Deterministic for a given seed.
+ConfInterval bootstrap_ci_median(const std::vector<double>& v, double confidence = 0.95,
+                                 int resamples = 2000, std::uint32_t seed = 12345u);
+
+// Two-sided Mann-Whitney U test (normal approximation with tie and continuity
+// correction). Returns the p-value for "a and b come from the same distribution";
+// 1.0 if either sample has fewer than two values.
+double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b);
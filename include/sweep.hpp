@@ -0,0 +1,64 @@
+// sweep.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Parameter-grid benchmark engine used by the benchset mode.
+// Expands the Cartesian product of output sizes, methods, backends, thread
+// counts and OpenMP scheduling options, runs it in randomized order (to spread
+// thermal/frequency drift over all configurations) and writes one row per
+// configuration through a buffered ResultWriter.
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "benchmark.hpp"
+#include "image.hpp"
+#include "resize.hpp"
+
+struct SweepSpec {
+    std::vector<std::pair<int, int>> sizes;  // output sizes (w, h)
+    std::vector<ResizeMethod> methods;
+    std::vector<Backend> backends;
+    std::vector<int> threads;                // OpenMP only; 0 = OpenMP default
+    std::vector<OmpSchedule> schedules;      // OpenMP only
+    std::vector<int> chunks;                 // OpenMP only; 0 = schedule default
+    std::vector<AllocMode> allocs;           // output buffer handling; empty = fresh only
+    std::vector<CacheMode> caches;           // input cache state; empty = warm only
+    AffinitySpec affinity;                   // OpenMP thread placement, same for every config
+
+    int warmup = 2;
+    int runs = 10;
+    int inner_reps = 1;
+    BenchOptions bench;
+    std::string samples_path;                // optional raw per-run export (config_id joins)
+
+    bool shuffle = true;
+    std::uint32_t seed = 20260207u;
+};
+
+struct SweepConfig {
+    int out_w = 0;
+    int out_h = 0;
+    ResizeMethod method = ResizeMethod::Nearest;
+    Backend backend = Backend::Sequential;
+    int threads = 0;
+    ParallelOptions popt;
+    AllocMode alloc = AllocMode::Fresh;
+    CacheMode cache = CacheMode::Warm;
+};
+
+// Geometric size ladder: base, base*scale, base*scale^2, ... (rounded at every step,
+// matching the sweep of the automatic experiment).
+std::vector<std::pair<int, int>> geometric_sizes(int base_w, int base_h, int steps, double scale);
+
+// Cartesian product of the spec axes, in canonical (unshuffled) order.
+// Thread/schedule/chunk axes collapse to a single entry for the sequential backend.
+std::vector<SweepConfig> expand_sweep(const SweepSpec& spec);
+
+// Run every configuration on img and write the results to out_path
+// (CSV, or JSON if the path ends with ".json"). Progress goes to log.
+void run_sweep(const Image& img, const SweepSpec& spec, const std::string& out_path, std::ostream& log);
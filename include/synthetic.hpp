@@ -0,0 +1,35 @@
+// synthetic.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Deterministic synthetic test images.
+// Every pixel is a pure function of (seed, x, y, channel), so output does not
+// depend on the thread count and rows are generated in parallel with OpenMP.
+// load_image() accepts "synthetic:WxHxC:pattern:seed" in place of a file path.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "image.hpp"
+
+enum class SyntheticPattern {
+    Gradient,  // smooth ramps (x, y, diagonal) per channel
+    Noise,     // white noise: no spatial correlation, worst case for aliasing
+    Checker,   // 16 px checkerboard: sharp edges at a fixed period
+    Text,      // dense glyph-like strokes: high-frequency content similar to documents
+    Natural    // fractal value noise with a ~1/f amplitude spectrum, like photographs
+};
+
+inline constexpr int synthetic_max_side = 65536;
+
+Image generate_synthetic(int w, int h, int channels, SyntheticPattern pattern,
+                         std::uint64_t seed, int threads = 0);
+
+[[nodiscard]] bool is_synthetic_spec(std::string_view path);
+
+// Parses "synthetic:WxHxC:pattern:seed" (pattern and seed optional: defaults
+// "natural" and 1). requested_channels != 0 overrides C, as in load_image().
+Image load_synthetic(std::string_view spec, int requested_channels = 0);
+
+const char* synthetic_pattern_name(SyntheticPattern p);
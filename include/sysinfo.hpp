@@ -0,0 +1,54 @@
+// sysinfo.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Host introspection helpers (Linux sysfs/procfs; safe fallbacks elsewhere).
+// Used by the benchmark harness to size cache-eviction buffers, to place threads
+// (see affinity.hpp) and to describe the host in result files (see metadata.hpp).
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CacheLevel {
+    int level = 0;
+    std::string type;          // "Data", "Instruction" or "Unified"
+    std::size_t size_bytes = 0;
+};
+
+// Caches visible to CPU 0, in sysfs index order; empty if unknown.
+std::vector<CacheLevel> cpu_caches();
+
+// Size in bytes of the largest data/unified cache visible to CPU 0 (usually the
+// LLC), or 0 if it cannot be determined.
+std::size_t llc_size_bytes();
+
+// One logical CPU (hardware thread) as seen by the OS.
+struct LogicalCpu {
+    int id = 0;       // OS CPU number
+    int package = 0;  // socket
+    int core = 0;     // core id within the package (not necessarily dense)
+    int smt = 0;      // rank among the hardware threads of its core (0 = first sibling)
+};
+
+// Online CPUs this process may run on, from /sys/devices/system/cpu and the
+// process affinity mask, ordered by id. Detected once, on the first call (call it
+// before pinning any thread). Without sysfs every CPU is its own core.
+const std::vector<LogicalCpu>& cpu_topology();
+
+// Linux CPU list syntax: "0-3,8,10-11".
+std::vector<int> parse_cpu_list(std::string_view s);
+
+// CPU model string from /proc/cpuinfo, or "" if not exposed.
+std::string cpu_model_name();
+
+// The SIMD-related extensions (SSE/AVX/AVX-512, NEON/SVE) reported by /proc/cpuinfo,
+// in a fixed order; the full flag list is too long to be useful in result files.
+std::vector<std::string> cpu_isa_extensions();
+
+// "Linux 6.1.0-18-amd64 x86_64" (uname sysname, release, machine), or "".
+std::string kernel_release();
+
+// cpufreq scaling governor of CPU 0 ("performance", "powersave", ...), or "".
+std::string cpu_governor();
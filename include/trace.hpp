@@ -0,0 +1,184 @@
+// trace.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Low-overhead timeline tracing in the Chrome trace-event format (loadable in
+// chrome://tracing and ui.perfetto.dev).
+//
+// Every thread appends complete ("X") events to its own buffer, registered once
+// under a lock and never shared while tracing, so recording an event takes no
+// lock. Tracing is switched on per process (--trace PATH) and the buffers are
+// written out by TraceSession when the program has finished its work.
+//
+// The TRACE_* macros compile to nothing when RESIZER_TRACE is 0 (CMake option
+// RESIZER_TRACING=OFF); otherwise a disabled trace costs one relaxed load per
+// scope or row.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef RESIZER_TRACE
+  #define RESIZER_TRACE 1
+#endif
+
+// Event categories (Chrome's "cat" field).
+namespace trace_cat {
+    inline constexpr const char* resize  = "resize";
+    inline constexpr const char* io      = "io";
+    inline constexpr const char* bench   = "bench";
+    inline constexpr const char* metrics = "metrics";
+}
+
+struct TraceEvent {
+    const char* name = nullptr;  // string literals only: stored by pointer
+    const char* cat = nullptr;
+    std::int64_t begin_ns = 0;   // steady clock; made relative to the session start on output
+    std::int64_t end_ns = 0;
+    const char* arg_names[2] = {nullptr, nullptr};
+    std::int64_t args[2] = {0, 0};
+};
+
+namespace trace_detail {
+    extern std::atomic<bool> enabled;
+
+    inline std::int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(const TraceEvent& e); // appends to the calling thread's buffer
+}
+
+inline bool trace_enabled() {
+#if RESIZER_TRACE
+    return trace_detail::enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+// Label shown for the calling thread ("main", "omp 3", ...); the first call wins.
+void trace_set_thread_name(const std::string& name);
+
+// Enables tracing for the lifetime of the object and writes the trace to path
+// when finish() is called (or on destruction, errors then go to stderr).
+// An empty path leaves tracing off. Throws if tracing was compiled out.
+class TraceSession {
+public:
+    explicit TraceSession(std::string path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+    // Stops recording and writes the trace; returns the number of events written.
+    std::size_t finish();
+
+private:
+    std::string path_;
+    bool active_ = false;
+};
+
+// Times the enclosing scope as one event.
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* cat,
+               const char* a0 = nullptr, std::int64_t v0 = 0,
+               const char* a1 = nullptr, std::int64_t v1 = 0) {
+        if (!trace_enabled()) return;
+        e_.name = name;
+        e_.cat = cat;
+        e_.arg_names[0] = a0;
+        e_.args[0] = v0;
+        e_.arg_names[1] = a1;
+        e_.args[1] = v1;
+        e_.begin_ns = trace_detail::now_ns();
+    }
+
+    ~TraceScope() {
+        if (e_.name == nullptr) return;
+        e_.end_ns = trace_detail::now_ns();
+        trace_detail::record(e_);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceEvent e_;
+};
+
+// Coalesces the rows one thread processes inside a work-shared loop into
+// contiguous bands: call row(y) before each row and finish() after the loop
+// (before any barrier, so waiting is not counted as work).
+class RowBandTracer {
+public:
+    explicit RowBandTracer(const char* name) : name_(name), on_(trace_enabled()) {}
+    ~RowBandTracer() { finish(); }
+
+    RowBandTracer(const RowBandTracer&) = delete;
+    RowBandTracer& operator=(const RowBandTracer&) = delete;
+
+    void row(int y) {
+        if (!on_) return;
+        if (first_ >= 0 && y == next_) {
+            ++next_;
+            return;
+        }
+        const std::int64_t t = trace_detail::now_ns();
+        emit(t);
+        first_ = y;
+        next_ = y + 1;
+        begin_ns_ = t;
+    }
+
+    void finish() {
+        if (!on_) return;
+        emit(trace_detail::now_ns());
+        first_ = -1;
+    }
+
+private:
+    void emit(std::int64_t end_ns) {
+        if (first_ < 0) return;
+        TraceEvent e;
+        e.name = name_;
+        e.cat = trace_cat::resize;
+        e.begin_ns = begin_ns_;
+        e.end_ns = end_ns;
+        e.arg_names[0] = "first_row";
+        e.args[0] = first_;
+        e.arg_names[1] = "rows";
+        e.args[1] = next_ - first_;
+        trace_detail::record(e);
+    }
+
+    const char* name_;
+    bool on_;
+    int first_ = -1;
+    int next_ = 0;
+    std::int64_t begin_ns_ = 0;
+};
+
+#define RESIZER_TRACE_CONCAT_(a, b) a##b
+#define RESIZER_TRACE_CONCAT(a, b) RESIZER_TRACE_CONCAT_(a, b)
+
+#if RESIZER_TRACE
+  #define TRACE_SCOPE(name, cat) \
+      TraceScope RESIZER_TRACE_CONCAT(trace_scope_, __LINE__)(name, cat)
+  #define TRACE_SCOPE_ARGS(name, cat, a0, v0, a1, v1) \
+      TraceScope RESIZER_TRACE_CONCAT(trace_scope_, __LINE__)(name, cat, a0, static_cast<std::int64_t>(v0), \
+                                                                 a1, static_cast<std::int64_t>(v1))
+  #define TRACE_ROW_BANDS(var, name) RowBandTracer var(name)
+  #define TRACE_ROW(var, y) (var).row(y)
+  #define TRACE_ROW_FINISH(var) (var).finish()
+#else
+  #define TRACE_SCOPE(name, cat) ((void)0)
+  #define TRACE_SCOPE_ARGS(name, cat, a0, v0, a1, v1) ((void)0)
+  #define TRACE_ROW_BANDS(var, name) ((void)0)
+  #define TRACE_ROW(var, y) ((void)0)
+  #define TRACE_ROW_FINISH(var) ((void)0)
+#endif
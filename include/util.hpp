@@ -7,9 +7,16 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
 
 std::string to_lower(std::string s);
 
 bool ends_with_icase(std::string_view s, std::string_view suffix);
 
 int parse_int(std::string_view s, std::string_view name);
+
+// Split on sep; empty items are dropped ("a,,b" -> {"a","b"}).
+std::vector<std::string> split(std::string_view s, char sep);
+
+// Comma-separated integer list, e.g. "1,2,4,8".
+std::vector<int> parse_int_list(std::string_view s, std::string_view name);
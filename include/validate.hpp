@@ -7,11 +7,28 @@
 #pragma once
 
 #include "image.hpp"
+#include <array>
 #include <cstdint>
 
 struct DiffStats {
     std::uint64_t different_values = 0; // number of channel values that differ
     int max_abs_diff = 0;              // max |a-b| over all channel values (0..255)
+    std::uint64_t sum_abs_diff = 0;    // sum of |a-b| (SAD)
+    std::array<std::uint64_t, 256> histogram{}; // histogram[d] = channel values with |a-b| == d
+
+    // First differing channel value in row-major order; -1 if the images are equal.
+    int first_x = -1;
+    int first_y = -1;
+    int first_c = -1;
+
+    [[nodiscard]] double mean_abs_diff() const;
+    [[nodiscard]] bool operator==(const DiffStats&) const = default;
 };
 
-DiffStats compare_images(const Image& a, const Image& b);
+// SIMD byte comparison, parallelized over fixed-size chunks with OpenMP
+// (threads: 0 = OpenMP default). Chunk partials are combined in chunk order, so
+// the result does not depend on the thread count and equals compare_images_reference.
+DiffStats compare_images(const Image& a, const Image& b, int threads = 0);
+
+// Single-threaded scalar reference, one channel value at a time.
+DiffStats compare_images_reference(const Image& a, const Image& b);
@@ -0,0 +1,64 @@
+// yuv.hpp
+// Created by Francesco on 17/10/2026.
+//
+// Planar YUV 4:2:0 / 4:2:2 images.
+// Luma and chroma planes are stored as separate 1-channel Image objects and are
+// resized independently (no round trip through RGB). Chroma siting is honoured
+// when mapping output chroma samples back to the source plane.
+#pragma once
+
+#include <string>
+
+#include "image.hpp"
+#include "resize.hpp"
+
+enum class ChromaFormat {
+    Yuv420, // chroma subsampled 2x horizontally and 2x vertically (I420)
+    Yuv422  // chroma subsampled 2x horizontally only (I422)
+};
+
+// Horizontal position of chroma samples relative to luma samples.
+// Vertical siting for 4:2:0 is always "between lines" (MPEG-2/H.264/JPEG agree on this).
+enum class ChromaSiting {
+    Center, // JPEG / MPEG-1: chroma sample sits between two luma samples
+    Left    // MPEG-2 / H.264 / HEVC default: co-sited with the even luma sample
+};
+
+struct YuvImage {
+    int width  = 0;  // luma width
+    int height = 0;  // luma height
+    ChromaFormat format = ChromaFormat::Yuv420;
+    ChromaSiting siting = ChromaSiting::Center;
+
+    Image y; // width x height
+    Image u; // chroma_width() x chroma_height()
+    Image v;
+
+    YuvImage() = default;
+    YuvImage(int w, int h, ChromaFormat f, ChromaSiting s = ChromaSiting::Center);
+
+    [[nodiscard]] int chroma_width()  const noexcept { return (width + 1) / 2; }
+    [[nodiscard]] int chroma_height() const noexcept {
+        return (format == ChromaFormat::Yuv420) ? (height + 1) / 2 : height;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return y.empty(); }
+
+    [[nodiscard]] size_t size_bytes() const noexcept {
+        return y.size_bytes() + u.size_bytes() + v.size_bytes();
+    }
+};
+
+// Resize all three planes. With Backend::OpenMP the rows of the three planes are
+// distributed in a single parallel loop, so small chroma planes do not serialize.
+YuvImage resize_yuv(const YuvImage& in, int out_w, int out_h,
+                    ResizeMethod method, Backend backend, int threads);
+
+// BT.601 full-range conversion. Chroma is upsampled bilinearly at its siting
+// phase, one row at a time (no intermediate full-size chroma planes).
+Image yuv_to_rgb(const YuvImage& in, int threads = 0);
+
+// Raw planar files (Y plane, then U, then V; no header), i.e. I420 / I422.
+YuvImage load_yuv_raw(const std::string& path, int w, int h, ChromaFormat format,
+                      ChromaSiting siting = ChromaSiting::Center);
+void save_yuv_raw(const YuvImage& img, const std::string& path);
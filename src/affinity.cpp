@@ -0,0 +1,144 @@
+// affinity.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the thread placement policies.
+#include "affinity.hpp"
+
+#include "util.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+
+const char* affinity_policy_name(AffinityPolicy p) {
+    switch (p) {
+        case AffinityPolicy::None:    return "none";
+        case AffinityPolicy::Compact: return "compact";
+        case AffinityPolicy::Scatter: return "scatter";
+        case AffinityPolicy::Cores:   return "cores";
+        case AffinityPolicy::List:    return "list";
+    }
+    return "unknown";
+}
+
+AffinitySpec parse_affinity(const std::string& s) {
+    const std::string v = to_lower(s);
+    AffinitySpec spec;
+    if (v == "none")                                   spec.policy = AffinityPolicy::None;
+    else if (v == "compact" || v == "close")           spec.policy = AffinityPolicy::Compact;
+    else if (v == "scatter" || v == "spread")          spec.policy = AffinityPolicy::Scatter;
+    else if (v == "cores" || v == "physical")          spec.policy = AffinityPolicy::Cores;
+    else if (!v.empty() && v.find_first_not_of("0123456789,-") == std::string::npos) {
+        spec.policy = AffinityPolicy::List;
+        spec.cpus = parse_cpu_list(v);
+        if (spec.cpus.empty()) throw std::invalid_argument("Empty CPU list: " + s);
+    } else {
+        throw std::invalid_argument("Unknown affinity policy: " + s);
+    }
+    return spec;
+}
+
+std::vector<int> affinity_cpu_order(const AffinitySpec& spec, const std::vector<LogicalCpu>& topo) {
+    if (spec.policy == AffinityPolicy::None) return {};
+
+    if (spec.policy == AffinityPolicy::List) {
+        for (int c : spec.cpus) {
+            const bool known = std::any_of(topo.begin(), topo.end(), [c](const LogicalCpu& l) { return l.id == c; });
+            if (!known) throw std::invalid_argument("CPU " + std::to_string(c) + " is not online or not allowed for this process");
+        }
+        return spec.cpus;
+    }
+
+    // Dense core rank within each package, so scatter interleaves packages evenly
+    // even when core ids have gaps.
+    std::map<std::pair<int, int>, int> core_rank;
+    {
+        std::map<int, std::vector<int>> cores_of;
+        for (const LogicalCpu& c : topo) cores_of[c.package].push_back(c.core);
+        for (auto& [pkg, cores] : cores_of) {
+            std::sort(cores.begin(), cores.end());
+            cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+            for (size_t i = 0; i < cores.size(); ++i) core_rank[{pkg, cores[i]}] = static_cast<int>(i);
+        }
+    }
+
+    std::vector<LogicalCpu> cpus = topo;
+    if (spec.policy == AffinityPolicy::Cores) {
+        std::erase_if(cpus, [](const LogicalCpu& c) { return c.smt != 0; });
+    }
+
+    auto key = [&](const LogicalCpu& c) {
+        const int rank = core_rank[{c.package, c.core}];
+        if (spec.policy == AffinityPolicy::Scatter) return std::make_tuple(c.smt, rank, c.package, c.id);
+        return std::make_tuple(c.package, rank, c.smt, c.id);
+    };
+    std::sort(cpus.begin(), cpus.end(), [&](const LogicalCpu& a, const LogicalCpu& b) { return key(a) < key(b); });
+
+    std::vector<int> order;
+    order.reserve(cpus.size());
+    for (const LogicalCpu& c : cpus) order.push_back(c.id);
+    return order;
+}
+
+std::vector<int> affinity_cpu_order(const AffinitySpec& spec) {
+    return affinity_cpu_order(spec, cpu_topology());
+}
+
+#if defined(__linux__)
+namespace {
+// Per-thread pinning state: the CPU the thread is pinned to (-1 = not pinned by
+// us) and the mask it had before the first pin_current_thread call.
+struct PinState {
+    int pinned = -1;
+    bool saved = false;
+    cpu_set_t original;
+};
+thread_local PinState pin_state;
+} // namespace
+#endif
+
+bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    PinState& st = pin_state;
+    if (st.pinned == cpu) return true;
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+
+    if (!st.saved) {
+        CPU_ZERO(&st.original);
+        if (sched_getaffinity(0, sizeof(st.original), &st.original) != 0) return false;
+        st.saved = true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) return false;
+    st.pinned = cpu;
+    return true;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void unpin_current_thread() {
+#if defined(__linux__)
+    PinState& st = pin_state;
+    if (st.pinned < 0 || !st.saved) return;
+    if (sched_setaffinity(0, sizeof(st.original), &st.original) == 0) st.pinned = -1;
+#endif
+}
+
+std::string affinity_mapping(const std::vector<int>& cpus, int threads) {
+    if (cpus.empty()) return "os";
+    std::string s;
+    for (int t = 0; t < threads; ++t) {
+        if (t) s += ' ';
+        s += std::to_string(t) + ":" + std::to_string(cpus[static_cast<size_t>(t) % cpus.size()]);
+    }
+    return s;
+}
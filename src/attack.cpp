@@ -0,0 +1,183 @@
+// attack.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the scaling-attack sweep.
+#include "attack.hpp"
+
+#include "resize_operator.hpp"
+#include "results.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
+
+// Configurations sharing one downscaled image.
+struct AttackGroup {
+    std::size_t ratio = 0;
+    ResizeMethod down_method = ResizeMethod::Nearest;
+    std::vector<std::size_t> pairs; // indices into spec.method_pairs
+};
+
+std::string ratio_name(double rx, double ry) {
+    auto num = [](double v) {
+        std::ostringstream oss;
+        oss << v;
+        return oss.str();
+    };
+    return (rx == ry) ? num(rx) : num(rx) + "x" + num(ry);
+}
+
+} // namespace
+
+std::pair<int, int> attack_down_size(int w, int h, double ratio_x, double ratio_y) {
+    const int dw = std::max(1, static_cast<int>(std::lround(static_cast<double>(w) / ratio_x)));
+    const int dh = std::max(1, static_cast<int>(std::lround(static_cast<double>(h) / ratio_y)));
+    return {dw, dh};
+}
+
+std::vector<AttackResult> run_attack_grid(const Image& src, const AttackSpec& spec, std::ostream& log) {
+    if (src.empty()) throw std::invalid_argument("attack: empty source image");
+    if (spec.ratios.empty() || spec.method_pairs.empty()) throw std::invalid_argument("attack: empty grid");
+
+    const std::size_t npairs = spec.method_pairs.size();
+    std::vector<AttackResult> results(spec.ratios.size() * npairs);
+    std::vector<AttackGroup> groups;
+    for (std::size_t r = 0; r < spec.ratios.size(); ++r) {
+        for (ResizeMethod dm : {ResizeMethod::Nearest, ResizeMethod::Bilinear}) {
+            AttackGroup g{r, dm, {}};
+            for (std::size_t p = 0; p < npairs; ++p) {
+                if (spec.method_pairs[p].first == dm) g.pairs.push_back(p);
+            }
+            if (!g.pairs.empty()) groups.push_back(std::move(g));
+        }
+    }
+
+    int team = 1;
+#if HAVE_OPENMP
+    if (spec.threads > 0) omp_set_num_threads(spec.threads);
+    team = omp_get_max_threads();
+#endif
+    const bool across = static_cast<int>(groups.size()) >= team;
+    log << "Attack grid: " << results.size() << " configurations in " << groups.size()
+        << " downscale groups, " << team << " threads, parallel across "
+        << (across ? "groups" : "rows") << "\n";
+
+    auto run_group = [&](const AttackGroup& g, Backend backend, int threads) {
+        const auto [rx, ry] = spec.ratios[g.ratio];
+        const auto [dw, dh] = attack_down_size(src.width, src.height, rx, ry);
+        TRACE_SCOPE_ARGS("attack group", trace_cat::metrics, "down_w", dw, "down_h", dh);
+
+        const double t0 = now_ms();
+        const Image down = resize(src, dw, dh, g.down_method, backend, threads);
+        const double down_ms = now_ms() - t0;
+        const double influential =
+            influence_map(resize_operator(src.width, src.height, dw, dh, g.down_method)).influential_fraction();
+
+        for (std::size_t p : g.pairs) {
+            const double t1 = now_ms();
+            AttackResult& r = results[g.ratio * npairs + p];
+            r.ratio_x = rx;
+            r.ratio_y = ry;
+            r.down_w = dw;
+            r.down_h = dh;
+            r.down_method = g.down_method;
+            r.up_method = spec.method_pairs[p].second;
+            r.influential_fraction = influential;
+            r.metrics = reconstruction_metrics(src, down, r.up_method, backend, threads);
+            r.ms = down_ms + (now_ms() - t1);
+        }
+    };
+
+    if (across) {
+        const long long ngroups = static_cast<long long>(groups.size());
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (long long i = 0; i < ngroups; ++i) {
+            run_group(groups[static_cast<std::size_t>(i)], Backend::Sequential, 1);
+        }
+    } else {
+        for (const AttackGroup& g : groups) run_group(g, Backend::OpenMP, spec.threads);
+    }
+    return results;
+}
+
+void write_attack_results(const std::vector<AttackResult>& results, const Image& src, const std::string& path) {
+    using I = std::int64_t;
+    ResultWriter writer(path, {
+        "in_w", "in_h", "channels", "ratio_x", "ratio_y", "down_w", "down_h", "down_method", "up_method",
+        "mae", "rmse", "psnr", "max_abs", "influential_fraction", "ms"
+    });
+    for (const AttackResult& r : results) {
+        writer.add_row({
+            static_cast<I>(src.width), static_cast<I>(src.height), static_cast<I>(src.channels),
+            r.ratio_x, r.ratio_y, static_cast<I>(r.down_w), static_cast<I>(r.down_h),
+            std::string(method_name(r.down_method)), std::string(method_name(r.up_method)),
+            r.metrics.mae, r.metrics.rmse, r.metrics.psnr, static_cast<I>(r.metrics.max_abs),
+            r.influential_fraction, r.ms
+        });
+    }
+    writer.flush();
+}
+
+void print_attack_summary(const std::vector<AttackResult>& results, int top, std::ostream& os) {
+    std::vector<const AttackResult*> ranked;
+    for (const AttackResult& r : results) ranked.push_back(&r);
+    std::stable_sort(ranked.begin(), ranked.end(), [](const AttackResult* a, const AttackResult* b) {
+        if (a->metrics.psnr != b->metrics.psnr) return a->metrics.psnr < b->metrics.psnr;
+        return a->metrics.mae > b->metrics.mae;
+    });
+    if (top > 0 && ranked.size() > static_cast<std::size_t>(top)) ranked.resize(static_cast<std::size_t>(top));
+
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+    os << "\nMOST VULNERABLE CONFIGURATIONS (lowest down->up PSNR: most source content discarded;\n"
+       << " read_pct: share of source pixels the downscale reads at all)\n"
+       << "  rank    ratio         down       down->up    psnr_db       mae      rmse  max_abs  read_pct\n";
+    int rank = 1;
+    for (const AttackResult* r : ranked) {
+        os << "  " << std::setw(4) << rank++
+           << "  " << std::setw(7) << ratio_name(r->ratio_x, r->ratio_y)
+           << "  " << std::setw(11) << (std::to_string(r->down_w) + "x" + std::to_string(r->down_h))
+           << "  " << std::setw(17)
+           << (std::string(method_name(r->down_method)) + "->" + method_name(r->up_method))
+           << std::fixed << std::setprecision(2)
+           << "  " << std::setw(9) << r->metrics.psnr
+           << "  " << std::setw(8) << r->metrics.mae
+           << "  " << std::setw(8) << r->metrics.rmse
+           << "  " << std::setw(7) << r->metrics.max_abs
+           << "  " << std::setw(8) << 100.0 * r->influential_fraction << "\n";
+        os.flags(flags);
+    }
+    os.precision(prec);
+}
+
+std::pair<double, double> parse_attack_ratio(const std::string& s) {
+    const std::vector<std::string> parts = split(to_lower(s), 'x');
+    if (parts.empty() || parts.size() > 2) throw std::invalid_argument("Invalid attack ratio: " + s);
+
+    auto number = [&](const std::string& v) {
+        try {
+            std::size_t idx = 0;
+            const double d = std::stod(v, &idx);
+            if (idx != v.size() || !(d >= 1.0)) throw std::invalid_argument("range");
+            return d;
+        } catch (...) {
+            throw std::invalid_argument("Attack ratio must be a number >= 1 (or RXxRY): " + s);
+        }
+    };
+    const double rx = number(parts[0]);
+    return {rx, (parts.size() == 2) ? number(parts[1]) : rx};
+}
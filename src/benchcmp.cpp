@@ -0,0 +1,320 @@
+// benchcmp.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the benchmark comparison / regression gate.
+#include "benchcmp.hpp"
+
+#include "benchmark.hpp"
+#include "results.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+namespace {
+
+// Columns that describe a measurement rather than a configuration.
+bool is_result_column(const std::string& c) {
+    static const std::vector<std::string> extra = {"config_id", "exec_order", "warmup", "mpix_per_s", "cpu_map"};
+    const std::vector<std::string> bench = bench_result_columns();
+    return std::find(bench.begin(), bench.end(), c) != bench.end() ||
+           std::find(extra.begin(), extra.end(), c) != extra.end();
+}
+
+bool metric_lower_is_better(const std::string& m) {
+    return !(m == "mpix_per_s" || m == "bandwidth_gbs" || m == "ipc");
+}
+
+double to_number(const std::string& s) {
+    if (s.empty()) return std::numeric_limits<double>::quiet_NaN();
+    try {
+        size_t idx = 0;
+        const double v = std::stod(s, &idx);
+        return (idx == s.size()) ? v : std::numeric_limits<double>::quiet_NaN();
+    } catch (...) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+std::vector<int> column_indices(const ResultTable& t, const std::vector<std::string>& names, const std::string& path) {
+    std::vector<int> idx;
+    for (const std::string& n : names) {
+        const int c = t.column(n);
+        if (c < 0) throw std::invalid_argument("benchcmp: column '" + n + "' not found in " + path);
+        idx.push_back(c);
+    }
+    return idx;
+}
+
+std::string join_key(const std::vector<std::string>& row, const std::vector<int>& idx) {
+    std::string k;
+    for (size_t i = 0; i < idx.size(); ++i) {
+        if (i) k += '/';
+        k += row[static_cast<size_t>(idx[i])];
+    }
+    return k;
+}
+
+// Raw samples grouped by the key columns of the samples file (every column
+// except sample/ms/outlier); outliers flagged by the harness are dropped, as
+// they are for the summary statistics.
+struct SampleIndex {
+    std::vector<std::string> key_columns;
+    std::map<std::string, std::vector<double>> by_key;
+};
+
+SampleIndex load_samples(const std::string& path) {
+    SampleIndex si;
+    if (path.empty()) return si;
+
+    const ResultTable t = read_result_table(path);
+    const int ms = t.column("ms");
+    if (ms < 0) throw std::invalid_argument("benchcmp: " + path + " is not a samples file (no 'ms' column)");
+    const int outlier = t.column("outlier");
+
+    for (const std::string& c : t.columns) {
+        if (c != "sample" && c != "ms" && c != "outlier") si.key_columns.push_back(c);
+    }
+    const std::vector<int> kidx = column_indices(t, si.key_columns, path);
+
+    for (const auto& row : t.rows) {
+        if (outlier >= 0 && row[static_cast<size_t>(outlier)] == "1") continue;
+        const double x = to_number(row[static_cast<size_t>(ms)]);
+        if (std::isfinite(x)) si.by_key[join_key(row, kidx)].push_back(x);
+    }
+    return si;
+}
+
+const std::vector<double>* samples_for(const SampleIndex& si, const ResultTable& t,
+                                       const std::vector<std::string>& row) {
+    if (si.key_columns.empty()) return nullptr;
+    std::vector<int> idx;
+    for (const std::string& c : si.key_columns) {
+        const int i = t.column(c);
+        if (i < 0) return nullptr;
+        idx.push_back(i);
+    }
+    const auto it = si.by_key.find(join_key(row, idx));
+    return (it == si.by_key.end()) ? nullptr : &it->second;
+}
+
+} // namespace
+
+const char* cmp_test_name(CmpTest t) {
+    switch (t) {
+        case CmpTest::Auto:        return "auto";
+        case CmpTest::MannWhitney: return "mann-whitney";
+        case CmpTest::CiOverlap:   return "ci-overlap";
+        case CmpTest::None:        return "none";
+    }
+    return "unknown";
+}
+
+const char* cmp_verdict_name(CmpVerdict v) {
+    switch (v) {
+        case CmpVerdict::Same:      return "same";
+        case CmpVerdict::Improved:  return "improved";
+        case CmpVerdict::Regressed: return "REGRESSED";
+        case CmpVerdict::Missing:   return "missing";
+        case CmpVerdict::Invalid:   return "INVALID";
+    }
+    return "unknown";
+}
+
+BenchCmpReport compare_bench_results(const BenchCmpSpec& spec) {
+    if (spec.threshold < 0.0) throw std::invalid_argument("benchcmp: threshold must be >= 0");
+    if (spec.alpha <= 0.0 || spec.alpha >= 1.0) throw std::invalid_argument("benchcmp: alpha must be in (0, 1)");
+
+    const ResultTable base = read_result_table(spec.baseline_path);
+    const ResultTable cand = read_result_table(spec.candidate_path);
+    if (base.rows.empty()) throw std::invalid_argument("benchcmp: no rows in " + spec.baseline_path);
+
+    BenchCmpReport rep;
+
+    // Only fields that identify the machine and the build; date_utc always differs.
+    for (const char* f : {"host", "cpu_model", "physical_cores", "allowed_cpus", "isa", "governor", "os",
+                          "compiler", "cxx_flags", "build_type", "openmp", "git_sha"}) {
+        const auto b = base.environment.find(f);
+        const auto c = cand.environment.find(f);
+        if (b != base.environment.end() && c != cand.environment.end() && b->second != c->second) {
+            rep.env_differences.push_back(std::string(f) + ": " + b->second + " -> " + c->second);
+        }
+    }
+
+    // Files from the legacy sweep only carry mean_ms.
+    rep.metric = spec.metric;
+    if (rep.metric == "median_ms" && (base.column("median_ms") < 0 || cand.column("median_ms") < 0)) {
+        rep.metric = "mean_ms";
+    }
+    rep.lower_is_better = metric_lower_is_better(rep.metric);
+
+    rep.keys = spec.keys;
+    if (rep.keys.empty()) {
+        for (const std::string& c : base.columns) {
+            if (!is_result_column(c) && cand.column(c) >= 0) rep.keys.push_back(c);
+        }
+        if (rep.keys.empty()) throw std::invalid_argument("benchcmp: no common configuration columns; use --keys");
+    }
+
+    const std::vector<int> bkey = column_indices(base, rep.keys, spec.baseline_path);
+    const std::vector<int> ckey = column_indices(cand, rep.keys, spec.candidate_path);
+    const int bm = column_indices(base, {rep.metric}, spec.baseline_path)[0];
+    const int cm = column_indices(cand, {rep.metric}, spec.candidate_path)[0];
+
+    // CI columns are the bootstrap CI of the median, so they only apply to it.
+    const bool ci_usable = rep.metric == "median_ms" &&
+        base.column("ci_lo_ms") >= 0 && base.column("ci_hi_ms") >= 0 &&
+        cand.column("ci_lo_ms") >= 0 && cand.column("ci_hi_ms") >= 0;
+    const bool time_metric = rep.metric.size() > 3 && rep.metric.compare(rep.metric.size() - 3, 3, "_ms") == 0;
+
+    const SampleIndex base_samples = load_samples(spec.baseline_samples);
+    const SampleIndex cand_samples = load_samples(spec.candidate_samples);
+
+    // Result files are appended to, so a key may repeat: the last row wins.
+    std::map<std::string, size_t> cand_rows;
+    for (size_t r = 0; r < cand.rows.size(); ++r) cand_rows[join_key(cand.rows[r], ckey)] = r;
+
+    std::map<std::string, size_t> base_rows;
+    std::vector<std::string> order; // first-seen order of baseline keys
+    for (size_t r = 0; r < base.rows.size(); ++r) {
+        const std::string k = join_key(base.rows[r], bkey);
+        if (base_rows.find(k) == base_rows.end()) order.push_back(k);
+        base_rows[k] = r;
+    }
+
+    for (const std::string& k : order) {
+        const auto& brow = base.rows[base_rows[k]];
+        BenchCmpRow row;
+        row.config = k;
+        row.baseline = to_number(brow[static_cast<size_t>(bm)]);
+
+        const auto it = cand_rows.find(k);
+        if (it == cand_rows.end()) {
+            row.candidate = std::numeric_limits<double>::quiet_NaN();
+            row.verdict = CmpVerdict::Missing;
+            rep.missing++;
+            rep.rows.push_back(row);
+            continue;
+        }
+        const auto& crow = cand.rows[it->second];
+        row.candidate = to_number(crow[static_cast<size_t>(cm)]);
+        if (!std::isfinite(row.candidate) || !std::isfinite(row.baseline)) {
+            // Every comparison with a NaN is false: it would otherwise read as "same".
+            row.verdict = CmpVerdict::Invalid;
+            rep.invalid++;
+            rep.rows.push_back(row);
+            continue;
+        }
+        row.delta = (row.baseline != 0.0) ? row.candidate / row.baseline - 1.0 : 0.0;
+
+        const std::vector<double>* bs = time_metric ? samples_for(base_samples, base, brow) : nullptr;
+        const std::vector<double>* cs = time_metric ? samples_for(cand_samples, cand, crow) : nullptr;
+        const bool have_samples = bs && cs && bs->size() >= 2 && cs->size() >= 2;
+
+        row.test = spec.test;
+        if (row.test == CmpTest::Auto) {
+            row.test = have_samples ? CmpTest::MannWhitney : (ci_usable ? CmpTest::CiOverlap : CmpTest::None);
+        }
+        if (row.test == CmpTest::MannWhitney && !have_samples) {
+            throw std::invalid_argument("benchcmp: no matching samples for " + k + " (pass --baseline-samples/--candidate-samples)");
+        }
+        if (row.test == CmpTest::CiOverlap && !ci_usable) {
+            throw std::invalid_argument("benchcmp: ci-overlap needs median_ms/ci_lo_ms/ci_hi_ms in both files");
+        }
+
+        bool significant = true;
+        if (row.test == CmpTest::MannWhitney) {
+            row.p_value = mann_whitney_p(*bs, *cs);
+            significant = row.p_value < spec.alpha;
+        } else if (row.test == CmpTest::CiOverlap) {
+            const double blo = to_number(brow[static_cast<size_t>(base.column("ci_lo_ms"))]);
+            const double bhi = to_number(brow[static_cast<size_t>(base.column("ci_hi_ms"))]);
+            const double clo = to_number(crow[static_cast<size_t>(cand.column("ci_lo_ms"))]);
+            const double chi = to_number(crow[static_cast<size_t>(cand.column("ci_hi_ms"))]);
+            significant = clo > bhi || chi < blo;
+        }
+
+        const double worse = rep.lower_is_better ? row.delta : -row.delta;
+        if (significant && worse > spec.threshold) {
+            row.verdict = CmpVerdict::Regressed;
+            rep.regressions++;
+        } else if (significant && worse < -spec.threshold) {
+            row.verdict = CmpVerdict::Improved;
+            rep.improvements++;
+        }
+        rep.rows.push_back(row);
+    }
+    return rep;
+}
+
+bool benchcmp_failed(const BenchCmpReport& rep, const BenchCmpSpec& spec) {
+    return rep.regressions > 0 || rep.invalid > 0 || (rep.missing > 0 && !spec.allow_missing);
+}
+
+void print_benchcmp_table(const BenchCmpReport& rep, const BenchCmpSpec& spec, std::ostream& os) {
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+
+    size_t width = 6;
+    for (const BenchCmpRow& r : rep.rows) width = std::max(width, r.config.size());
+
+    std::string key_header;
+    for (size_t i = 0; i < rep.keys.size(); ++i) key_header += (i ? "/" : "") + rep.keys[i];
+
+    os << "Comparing " << rep.metric << " (" << (rep.lower_is_better ? "lower" : "higher") << " is better), "
+       << "threshold " << std::fixed << std::setprecision(1) << 100.0 * spec.threshold << "%, "
+       << "alpha " << std::setprecision(3) << spec.alpha << "\n";
+    os.flags(flags);
+    os << "config: " << key_header << "\n";
+    for (const std::string& d : rep.env_differences) os << "environment differs: " << d << "\n";
+    os << "\n";
+
+    os << "  " << std::left << std::setw(static_cast<int>(width)) << "config" << std::right
+       << "  " << std::setw(12) << "baseline"
+       << "  " << std::setw(12) << "candidate"
+       << "  " << std::setw(8) << "delta"
+       << "  " << std::setw(12) << "test"
+       << "  " << std::setw(8) << "p"
+       << "  verdict\n";
+
+    for (const BenchCmpRow& r : rep.rows) {
+        os << "  " << std::left << std::setw(static_cast<int>(width)) << r.config << std::right
+           << std::fixed << std::setprecision(4)
+           << "  " << std::setw(12) << r.baseline;
+        if (r.verdict == CmpVerdict::Missing || r.verdict == CmpVerdict::Invalid) {
+            os << "  " << std::setw(12);
+            if (r.verdict == CmpVerdict::Missing) os << "-";
+            else os << r.candidate;
+            os << "  " << std::setw(8) << "-"
+               << "  " << std::setw(12) << "-" << "  " << std::setw(8) << "-";
+        } else {
+            os << "  " << std::setw(12) << r.candidate
+               << "  " << std::setw(7) << std::showpos << std::setprecision(1) << 100.0 * r.delta << std::noshowpos << "%"
+               << "  " << std::setw(12) << cmp_test_name(r.test)
+               << "  " << std::setw(8);
+            if (r.p_value >= 0.0) os << std::setprecision(4) << r.p_value;
+            else os << "-";
+        }
+        os << "  " << cmp_verdict_name(r.verdict) << "\n";
+        os.flags(flags);
+    }
+
+    os << "\n" << rep.rows.size() << " configurations: "
+       << rep.regressions << " regressed, " << rep.improvements << " improved, "
+       << rep.missing << " missing from candidate" << (spec.allow_missing ? " (allowed)" : "") << ", "
+       << rep.invalid << " invalid\n";
+    os.precision(prec);
+}
+
+void write_benchcmp_report(const BenchCmpReport& rep, const std::string& path) {
+    ResultWriter writer(path, {"config", "metric", "baseline", "candidate", "delta", "test", "p_value", "verdict"});
+    for (const BenchCmpRow& r : rep.rows) {
+        writer.add_row({r.config, rep.metric, r.baseline, r.candidate, r.delta,
+                        std::string(cmp_test_name(r.test)), r.p_value, std::string(cmp_verdict_name(r.verdict))});
+    }
+    writer.flush();
+}
@@ -2,33 +2,124 @@
 // Created by Francesco on 07/02/2026.
 //
 // Implements benchmarking logic for image resizing.
-// Includes warmup handling, timing collection, statistical analysis
-// (mean, standard deviation, min/max), and CSV result logging.
+// Includes warmup handling, timing collection (fixed or adaptive run count),
+// statistical analysis (see stats.hpp), optional hardware counters and CSV result logging.
 
 #include "benchmark.hpp"
+#include "affinity.hpp"
+#include "stats.hpp"
+#include "sysinfo.hpp"
 #include "timing.hpp"
+#include "trace.hpp"
 
-#include <fstream>
 #include <cmath>
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
 
-static double mean(const std::vector<double>& v) {
-    double s = 0.0;
-    for (double x : v) s += x;
-    return s / static_cast<double>(v.size());
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+  #include <sys/resource.h>
+  #define HAVE_GETRUSAGE 1
+#else
+  #define HAVE_GETRUSAGE 0
+#endif
+
+const char* alloc_mode_name(AllocMode m) {
+    switch (m) {
+        case AllocMode::Fresh:      return "fresh";
+        case AllocMode::Reused:     return "reused";
+        case AllocMode::Prefaulted: return "prefaulted";
+    }
+    return "unknown";
+}
+
+const char* cache_mode_name(CacheMode m) {
+    switch (m) {
+        case CacheMode::Warm:   return "warm";
+        case CacheMode::Flush:  return "flush";
+        case CacheMode::Rotate: return "rotate";
+    }
+    return "unknown";
+}
+
+namespace {
+
+// Target footprint for cache eviction: twice the LLC, or 64 MiB if unknown.
+std::size_t eviction_bytes() {
+    const std::size_t llc = llc_size_bytes();
+    return (llc > 0) ? 2 * llc : (std::size_t{64} << 20);
+}
+
+// Largest cache below the LLC (the per-core L2 on most parts), or 1 MiB if unknown.
+std::size_t private_cache_bytes() {
+    std::size_t best = 0;
+    int llc_level = 0;
+    for (const CacheLevel& c : cpu_caches()) llc_level = std::max(llc_level, c.level);
+    for (const CacheLevel& c : cpu_caches()) {
+        if (c.type != "Instruction" && c.level < llc_level) best = std::max(best, c.size_bytes);
+    }
+    return (best > 0) ? best : (std::size_t{1} << 20);
+}
+
+volatile std::uint8_t g_evict_sink = 0; // keeps the eviction loop from being optimized out
+
+// Touch every cache line of a buffer larger than the LLC (read-modify-write so
+// dirty lines are written back and the input/output are evicted). Each of the
+// team threads streams its own slice, at least twice its private cache, so the
+// L1/L2 of every core the resize runs on are evicted too.
+void evict_caches(int team) {
+    team = std::max(team, 1);
+    const std::size_t slice =
+        (std::max(eviction_bytes() / static_cast<std::size_t>(team), 2 * private_cache_bytes()) + 63) / 64 * 64;
+    static std::vector<std::uint8_t> buf;
+    if (buf.size() < slice * static_cast<std::size_t>(team)) buf.assign(slice * static_cast<std::size_t>(team), 1);
+
+    unsigned acc = 0;
+#if HAVE_OPENMP
+    #pragma omp parallel for num_threads(team) schedule(static, 1) reduction(+ : acc) if (team > 1)
+#endif
+    for (int t = 0; t < team; ++t) {
+        std::uint8_t* p = buf.data() + static_cast<std::size_t>(t) * slice;
+        std::uint8_t a = 0;
+        for (std::size_t i = 0; i < slice; i += 64) {
+            p[i] = static_cast<std::uint8_t>(p[i] + 1);
+            a = static_cast<std::uint8_t>(a + p[i]);
+        }
+        acc += a;
+    }
+    g_evict_sink = static_cast<std::uint8_t>(acc);
 }
 
-static double stddev_sample(const std::vector<double>& v, double mu) {
-    if (v.size() < 2) return 0.0;
-    double s2 = 0.0;
-    for (double x : v) {
-        const double d = x - mu;
-        s2 += d * d;
+double nominal_traffic_bytes(const Image& in, int out_w, int out_h, ResizeMethod method) {
+    const int taps = (method == ResizeMethod::Bilinear) ? 2 : 1;
+    const double rows_read = std::min<double>(in.height, static_cast<double>(taps) * out_h);
+    const double in_row_bytes = static_cast<double>(in.width) * in.channels;
+    const double out_bytes = static_cast<double>(out_w) * out_h * in.channels;
+    return rows_read * in_row_bytes + out_bytes;
+}
+
+struct FaultCount {
+    long minor = 0;
+    long major = 0;
+};
+
+FaultCount read_faults() {
+    FaultCount f;
+#if HAVE_GETRUSAGE
+    rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        f.minor = ru.ru_minflt;
+        f.major = ru.ru_majflt;
     }
-    return std::sqrt(s2 / static_cast<double>(v.size() - 1));
+#endif
+    return f;
 }
 
+} // namespace
+
 BenchResult benchmark_resize(
     const Image& img,
     int out_w, int out_h,
@@ -37,63 +128,292 @@ BenchResult benchmark_resize(
     int threads,
     int warmup,
     int runs,
-    int inner_reps
+    int inner_reps,
+    const ParallelOptions& popt,
+    const BenchOptions& bopt
 ) {
     if (inner_reps <= 0) inner_reps = 1;
+    if (runs <= 0) throw std::invalid_argument("benchmark_resize: runs must be > 0");
+    if (img.empty()) throw std::invalid_argument("benchmark_resize: input image is empty");
+    if (out_w <= 0 || out_h <= 0) throw std::invalid_argument("benchmark_resize: output size must be > 0");
 
-    std::vector<double> samples;
-    samples.reserve(runs);
+    std::unique_ptr<PerfCounterSet> counters;
+    if (bopt.perf_counters) {
+        // Open on the same team size the backend will use, before warmup so the
+        // OpenMP pool already exists when the measured runs start.
+        counters = std::make_unique<PerfCounterSet>(backend == Backend::OpenMP ? threads : 1);
+    }
+
+    // An earlier pinned configuration may have left this thread on one CPU; the
+    // sequential backend runs here, and the OpenMP workers unpin in the row loop.
+    if (popt.cpus.empty()) unpin_current_thread();
+
+    // Reused mode: allocated (and faulted in) once, outside every timed region.
+    Image reused;
+    if (bopt.alloc == AllocMode::Reused) reused = Image(out_w, out_h, img.channels);
+
+    // Prefaulted mode: fresh buffers for the next run, prepared before the timer starts.
+    std::vector<Image> prepared;
+    auto prepare = [&]() {
+        prepared.clear();
+        for (int k = 0; k < inner_reps; ++k) prepared.emplace_back(out_w, out_h, img.channels);
+    };
+
+    // Rotate mode: enough input copies that their total size exceeds the eviction
+    // footprint, so by the time a copy is reused it has left the cache. Sized by
+    // bytes with no cap: small inputs need many copies (about eviction_bytes total).
+    std::vector<Image> copies;
+    size_t next_copy = 0;
+    if (bopt.cache == CacheMode::Rotate) {
+        const size_t need = (eviction_bytes() + img.size_bytes() - 1) / img.size_bytes();
+        copies.assign(std::max<size_t>(need + 1, 2), img);
+    }
+
+    // Flush mode evicts from as many threads as the resize team.
+    int team = 1;
+#if HAVE_OPENMP
+    if (backend == Backend::OpenMP) team = (threads > 0) ? threads : omp_get_max_threads();
+#endif
+
+    const ParallelOptions* call_popt = &popt; // switched to the accounting options after warmup
+    auto call = [&](int k, const Image& src) {
+        switch (bopt.alloc) {
+            case AllocMode::Fresh: {
+                Image out = resize(src, out_w, out_h, method, backend, threads, *call_popt);
+                break;
+            }
+            case AllocMode::Reused:
+                resize_into(src, reused, method, backend, threads, *call_popt);
+                break;
+            case AllocMode::Prefaulted:
+                resize_into(src, prepared[static_cast<size_t>(k)], method, backend, threads, *call_popt);
+                break;
+        }
+    };
+
+    auto run_inner = [&]() {
+        for (int k = 0; k < inner_reps; ++k) call(k, img);
+    };
 
     // Warmup
     for (int i = 0; i < warmup; ++i) {
-        for (int k = 0; k < inner_reps; ++k) {
-            Image out = resize(img, out_w, out_h, method, backend, threads);
-        }
+        TRACE_SCOPE("warmup", trace_cat::bench);
+        if (bopt.alloc == AllocMode::Prefaulted) prepare();
+        run_inner();
     }
 
-    // Measured runs
-    for (int i = 0; i < runs; ++i) {
+    if (counters) counters->reset();
+
+    // Thread accounting covers the measured runs only.
+    WorkAccounting accounting;
+    ParallelOptions run_popt = popt;
+    if (bopt.thread_stats && backend == Backend::OpenMP) run_popt.accounting = &accounting;
+    call_popt = &run_popt;
+
+    FaultCount faults_total;
+
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(bopt.adaptive ? std::max(runs, bopt.max_runs) : runs));
+
+    // Timed region wrapper: wall clock, page faults and (optionally) counters.
+    auto timed = [&](auto&& body) {
+        const FaultCount f0 = read_faults();
+        if (counters) counters->start();
         const double t0 = now_ms();
 
-        for (int k = 0; k < inner_reps; ++k) {
-            Image out = resize(img, out_w, out_h, method, backend, threads);
-        }
+        body();
 
         const double t1 = now_ms();
-        const double elapsed = (t1 - t0) / inner_reps;  // normalize
-        samples.push_back(elapsed);
+        if (counters) counters->stop();
+        const FaultCount f1 = read_faults();
+
+        faults_total.minor += f1.minor - f0.minor;
+        faults_total.major += f1.major - f0.major;
+        return t1 - t0;
+    };
+
+    auto measure_once = [&]() {
+        TRACE_SCOPE_ARGS("measured run", trace_cat::bench, "run", samples.size(), "inner_reps", inner_reps);
+        if (bopt.alloc == AllocMode::Prefaulted) prepare();
+
+        double elapsed = 0.0;
+        if (bopt.cache == CacheMode::Warm) {
+            elapsed = timed(run_inner);
+        } else {
+            // Cold modes: every call starts cold, so each one is timed on its own.
+            for (int k = 0; k < inner_reps; ++k) {
+                const Image* src = &img;
+                if (bopt.cache == CacheMode::Flush) {
+                    TRACE_SCOPE("cache flush", trace_cat::bench);
+                    evict_caches(team);
+                } else {
+                    src = &copies[next_copy];
+                    next_copy = (next_copy + 1) % copies.size();
+                }
+                elapsed += timed([&]() { call(k, *src); });
+            }
+        }
+        samples.push_back(elapsed / inner_reps);  // normalize
+    };
+
+    // Measured runs
+    const double start_ms = now_ms();
+    for (int i = 0; i < runs; ++i) measure_once();
+
+    bool converged = true;
+    if (bopt.adaptive) {
+        const int max_runs = std::max(runs, bopt.max_runs);
+        converged = false;
+        int next_check = runs;
+        while (true) {
+            if (static_cast<int>(samples.size()) >= next_check) {
+                const std::vector<double> kept = reject_outliers_mad(samples, bopt.outlier_k);
+                const double med = median(kept);
+                const ConfInterval ci = bootstrap_ci_median(kept, 0.95, 500);
+                if (med > 0.0 && ci.half_width() / med <= bopt.ci_target) {
+                    converged = true;
+                    break;
+                }
+                // Bootstrapping is O(n * resamples): check in geometrically growing steps.
+                next_check = static_cast<int>(samples.size()) + std::max(5, static_cast<int>(samples.size()) / 4);
+            }
+            if (static_cast<int>(samples.size()) >= max_runs) break;
+            if (now_ms() - start_ms >= bopt.time_budget_ms) break;
+            measure_once();
+        }
     }
 
     BenchResult r{};
-    r.runs = runs;
+    r.runs = static_cast<int>(samples.size());
     r.mean_ms   = mean(samples);
     r.stddev_ms = stddev_sample(samples, r.mean_ms);
     r.min_ms    = *std::min_element(samples.begin(), samples.end());
     r.max_ms    = *std::max_element(samples.begin(), samples.end());
 
+    const std::vector<double> kept = reject_outliers_mad(samples, bopt.outlier_k, &r.outliers);
+    r.median_ms = median(kept);
+    r.p90_ms    = percentile(kept, 90.0);
+    r.p99_ms    = percentile(kept, 99.0);
+    r.mad_ms    = mad(kept, r.median_ms);
+    const ConfInterval ci = bootstrap_ci_median(kept);
+    r.ci_lo_ms  = ci.lo;
+    r.ci_hi_ms  = ci.hi;
+    r.converged = converged;
+
+    r.bytes_per_call = nominal_traffic_bytes(img, out_w, out_h, method);
+    r.bandwidth_gbs = (r.median_ms > 0.0) ? r.bytes_per_call / (r.median_ms * 1.0e6) : 0.0;
+
+    const double calls = static_cast<double>(r.runs) * inner_reps;
+    r.minor_faults = static_cast<double>(faults_total.minor) / calls;
+    r.major_faults = static_cast<double>(faults_total.major) / calls;
+
+    if (counters) {
+        r.perf_status = counters->status();
+        const PerfCounters total = counters->read();
+        const std::int64_t calls = static_cast<std::int64_t>(r.runs) * inner_reps;
+        auto per_call = [calls](std::int64_t v) { return (v < 0 || calls <= 0) ? v : v / calls; };
+        r.perf.cycles        = per_call(total.cycles);
+        r.perf.instructions  = per_call(total.instructions);
+        r.perf.l1d_misses    = per_call(total.l1d_misses);
+        r.perf.llc_misses    = per_call(total.llc_misses);
+        r.perf.branch_misses = per_call(total.branch_misses);
+        r.perf.dtlb_misses   = per_call(total.dtlb_misses);
+    }
+
+    if (accounting.calls > 0 && !accounting.threads.empty()) {
+        const double n = static_cast<double>(accounting.calls);
+        r.imbalance = accounting.imbalance();
+        r.idle_fraction = accounting.idle_fraction();
+
+        double busy = 0.0, wait = 0.0;
+        r.busy_max_ms = 0.0;
+        for (const ThreadWork& t : accounting.threads) {
+            ThreadWork avg;
+            avg.busy_ms = t.busy_ms / n;
+            avg.wait_ms = t.wait_ms / n;
+            avg.rows = static_cast<std::int64_t>(std::llround(static_cast<double>(t.rows) / n));
+            busy += avg.busy_ms;
+            wait += avg.wait_ms;
+            r.busy_max_ms = std::max(r.busy_max_ms, avg.busy_ms);
+            r.threads.push_back(avg);
+        }
+        r.busy_mean_ms = busy / static_cast<double>(r.threads.size());
+        r.wait_mean_ms = wait / static_cast<double>(r.threads.size());
+    }
+
+    r.samples = std::move(samples);
     return r;
 }
 
-void append_csv_row(const std::string& csv_path,
-                    const std::string& header_if_new,
-                    const std::string& row) {
-    // If file doesn't exist or is empty, write header first.
-    bool write_header = false;
-    {
-        std::ifstream in(csv_path, std::ios::binary);
-        if (!in.good()) {
-            write_header = true;
-        } else {
-            in.seekg(0, std::ios::end);
-            write_header = (in.tellg() == 0);
-        }
+std::string thread_rows_summary(const BenchResult& r) {
+    if (r.threads.empty()) return "-";
+    std::string s;
+    for (const ThreadWork& t : r.threads) {
+        if (!s.empty()) s += ' ';
+        s += std::to_string(t.rows);
     }
+    return s;
+}
+
+std::vector<std::string> bench_result_columns() {
+    return {
+        "runs", "mean_ms", "stddev_ms", "min_ms", "max_ms",
+        "median_ms", "p90_ms", "p99_ms", "mad_ms", "ci_lo_ms", "ci_hi_ms", "outliers", "converged",
+        "bytes_per_call", "bandwidth_gbs", "minor_faults", "major_faults",
+        "cycles", "instructions", "ipc", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses",
+        "imbalance", "idle_fraction", "busy_mean_ms", "busy_max_ms", "wait_mean_ms", "thread_rows"
+    };
+}
+
+void append_bench_result(std::vector<ResultValue>& row, const BenchResult& r) {
+    row.emplace_back(static_cast<std::int64_t>(r.runs));
+    row.emplace_back(r.mean_ms);
+    row.emplace_back(r.stddev_ms);
+    row.emplace_back(r.min_ms);
+    row.emplace_back(r.max_ms);
+    row.emplace_back(r.median_ms);
+    row.emplace_back(r.p90_ms);
+    row.emplace_back(r.p99_ms);
+    row.emplace_back(r.mad_ms);
+    row.emplace_back(r.ci_lo_ms);
+    row.emplace_back(r.ci_hi_ms);
+    row.emplace_back(static_cast<std::int64_t>(r.outliers));
+    row.emplace_back(static_cast<std::int64_t>(r.converged ? 1 : 0));
+    row.emplace_back(r.bytes_per_call);
+    row.emplace_back(r.bandwidth_gbs);
+    row.emplace_back(r.minor_faults);
+    row.emplace_back(r.major_faults);
+
+    const PerfCounters& p = r.perf;
+    row.emplace_back(p.cycles);
+    row.emplace_back(p.instructions);
+    row.emplace_back(p.ipc());
+    row.emplace_back(p.l1d_misses);
+    row.emplace_back(p.llc_misses);
+    row.emplace_back(p.branch_misses);
+    row.emplace_back(p.dtlb_misses);
+
+    row.emplace_back(r.imbalance);
+    row.emplace_back(r.idle_fraction);
+    row.emplace_back(r.busy_mean_ms);
+    row.emplace_back(r.busy_max_ms);
+    row.emplace_back(r.wait_mean_ms);
+    row.emplace_back(thread_rows_summary(r));
+}
+
+void write_samples(ResultWriter& writer, const std::vector<ResultValue>& key,
+                   const BenchResult& r, double outlier_k) {
+    const double med = median(r.samples);
+    const double sigma = 1.4826 * mad(r.samples, med);
 
-    std::ofstream out(csv_path, std::ios::app);
-    if (!out) throw std::runtime_error("append_csv_row: cannot open file: " + csv_path);
+    for (size_t i = 0; i < r.samples.size(); ++i) {
+        const double x = r.samples[i];
+        const bool outlier = sigma > 0.0 && std::fabs(x - med) > outlier_k * sigma;
 
-    if (write_header && !header_if_new.empty()) {
-        out << header_if_new << "\n";
+        std::vector<ResultValue> row = key;
+        row.emplace_back(static_cast<std::int64_t>(i));
+        row.emplace_back(x);
+        row.emplace_back(static_cast<std::int64_t>(outlier ? 1 : 0));
+        writer.add_row(std::move(row));
     }
-    out << row << "\n";
 }
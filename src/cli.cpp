@@ -2,14 +2,16 @@
 // Created by Francesco on 08/02/2026.
 //
 // CLI parsing implementation.
-// Supports: run, bench, validate, benchset. Produces helpful usage text on invalid input.
+// Supports: run, bench, validate, benchset, scaling, yuv, benchcmp, pipeline, metrics, attack, detect, conformance, hash. Produces helpful usage text on invalid input.
 #include "cli.hpp"
 
 #include "config.hpp"
+#include "dispatch.hpp"
 #include "util.hpp"
 
 #include <stdexcept>
 #include <cstdlib>
+#include <cstdint>
 
 static ResizeMethod parse_method(std::string s) {
     s = to_lower(std::move(s));
@@ -25,6 +27,37 @@ static Backend parse_backend(std::string s) {
     throw std::invalid_argument("Unknown backend: " + s);
 }
 
+static OmpSchedule parse_schedule(std::string s) {
+    s = to_lower(std::move(s));
+    if (s == "static")  return OmpSchedule::Static;
+    if (s == "dynamic") return OmpSchedule::Dynamic;
+    if (s == "guided")  return OmpSchedule::Guided;
+    throw std::invalid_argument("Unknown schedule: " + s);
+}
+
+static ChromaFormat parse_chroma_format(std::string s) {
+    s = to_lower(std::move(s));
+    if (s == "420" || s == "i420") return ChromaFormat::Yuv420;
+    if (s == "422" || s == "i422") return ChromaFormat::Yuv422;
+    throw std::invalid_argument("Unknown chroma format: " + s);
+}
+
+static ChromaSiting parse_chroma_siting(std::string s) {
+    s = to_lower(std::move(s));
+    if (s == "center") return ChromaSiting::Center;
+    if (s == "left")   return ChromaSiting::Left;
+    throw std::invalid_argument("Unknown chroma siting: " + s);
+}
+
+static CmpTest parse_cmp_test(std::string s) {
+    s = to_lower(std::move(s));
+    if (s == "auto") return CmpTest::Auto;
+    if (s == "mwu" || s == "mann-whitney") return CmpTest::MannWhitney;
+    if (s == "ci" || s == "ci-overlap") return CmpTest::CiOverlap;
+    if (s == "none") return CmpTest::None;
+    throw std::invalid_argument("Unknown comparison test: " + s);
+}
+
 static double parse_double(const std::string& s, const std::string& name) {
     try {
         size_t idx = 0;
@@ -36,18 +69,165 @@ static double parse_double(const std::string& s, const std::string& name) {
     }
 }
 
+// Index of the first "--option" argument (named options always follow the positionals).
+static int first_option_index(int argc, char** argv) {
+    for (int i = 2; i < argc; ++i) {
+        if (std::string(argv[i]).rfind("--", 0) == 0) return i;
+    }
+    return argc;
+}
+
+// Options shared by every benchmarking mode. Returns false if flag is not one of them;
+// i is advanced past the option's value when it takes one.
+static bool parse_bench_option(int argc, char** argv, int& i, CliOptions& opt) {
+    const std::string flag = argv[i];
+    auto value = [&]() -> std::string {
+        if (i + 1 >= argc) throw std::invalid_argument("missing value for " + flag);
+        return argv[++i];
+    };
+
+    BenchOptions& bopt = opt.bench;
+    if (flag == "--perf") {
+        bopt.perf_counters = true;
+    } else if (flag == "--thread-stats") {
+        bopt.thread_stats = true;
+    } else if (flag == "--adaptive") {
+        bopt.adaptive = true;
+    } else if (flag == "--ci-target") {
+        bopt.ci_target = parse_double(value(), "ci-target");
+        if (bopt.ci_target <= 0.0) throw std::invalid_argument("--ci-target must be > 0");
+    } else if (flag == "--budget-ms") {
+        bopt.time_budget_ms = parse_double(value(), "budget-ms");
+    } else if (flag == "--max-runs") {
+        bopt.max_runs = parse_int(value(), "max-runs");
+    } else if (flag == "--outlier-k") {
+        bopt.outlier_k = parse_double(value(), "outlier-k");
+    } else if (flag == "--samples") {
+        opt.samples_path = value();
+    } else if (flag == "--alloc") {
+        opt.alloc_modes.clear();
+        for (const std::string& v : split(to_lower(value()), ',')) {
+            if (v == "all") {
+                opt.alloc_modes = {AllocMode::Fresh, AllocMode::Reused, AllocMode::Prefaulted};
+            } else if (v == "fresh") {
+                opt.alloc_modes.push_back(AllocMode::Fresh);
+            } else if (v == "reused") {
+                opt.alloc_modes.push_back(AllocMode::Reused);
+            } else if (v == "prefaulted") {
+                opt.alloc_modes.push_back(AllocMode::Prefaulted);
+            } else {
+                throw std::invalid_argument("Unknown alloc mode: " + v);
+            }
+        }
+        if (opt.alloc_modes.empty()) throw std::invalid_argument("--alloc: empty list");
+    } else if (flag == "--cache") {
+        opt.cache_modes.clear();
+        for (const std::string& v : split(to_lower(value()), ',')) {
+            if (v == "all") {
+                opt.cache_modes = {CacheMode::Warm, CacheMode::Flush, CacheMode::Rotate};
+            } else if (v == "warm") {
+                opt.cache_modes.push_back(CacheMode::Warm);
+            } else if (v == "flush" || v == "cold") {
+                opt.cache_modes.push_back(CacheMode::Flush);
+            } else if (v == "rotate") {
+                opt.cache_modes.push_back(CacheMode::Rotate);
+            } else {
+                throw std::invalid_argument("Unknown cache mode: " + v);
+            }
+        }
+        if (opt.cache_modes.empty()) throw std::invalid_argument("--cache: empty list");
+    } else if (flag == "--affinity") {
+        opt.affinity = parse_affinity(value());
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void print_usage(std::ostream& os) {
     os
         << "Usage:\n"
         << "  Image_resizer_PP_Lab2 run <input> <output_png|output_jpg> <out_w> <out_h> <nearest|bilinear> <seq|omp> [threads]\n"
-        << "  Image_resizer_PP_Lab2 bench <input> <out_w> <out_h> <nearest|bilinear> <seq|omp> [threads] [warmup] [runs] [csv_path]\n"
-        << "  Image_resizer_PP_Lab2 validate <input> <out_w> <out_h> <nearest|bilinear> [threads]\n"
-        << "  Image_resizer_PP_Lab2 benchset <input> <base_w> <base_h> <steps> <scale> <nearest|bilinear> <seq|omp> [threads] [warmup] [runs] [csv_path]\n"
+        << "        [--manifest PATH]  appends the output's pixel hash to a golden manifest (see hash)\n"
+        << "        [--affinity P]  pins the OpenMP threads (see bench options)\n"
+        << "  Image_resizer_PP_Lab2 bench <input> <out_w> <out_h> <nearest|bilinear> <seq|omp> [threads] [warmup] [runs] [csv_path] [bench options]\n"
+        << "  Image_resizer_PP_Lab2 validate <input> <out_w> <out_h> <nearest|bilinear> [threads] [--reference]\n"
+        << "        --reference also runs the scalar single-threaded comparison and checks that both agree\n"
+        << "  Image_resizer_PP_Lab2 benchset <input> <base_w> <base_h> <steps> <scale> <methods> <backends> [threads] [warmup] [runs] [csv_path|json_path]\n"
+        << "        methods/backends/threads are comma lists (e.g. nearest,bilinear seq,omp 1,2,4,8); options:\n"
+        << "        --sizes WxH,... (replaces base/steps/scale)  --threads 1,2,4  --schedule static,dynamic,guided\n"
+        << "        --chunk 0,16,64  --inner N  --seed N  --no-shuffle  [bench options]\n"
+        << "  Image_resizer_PP_Lab2 scaling <input> <out_w> <out_h> <nearest|bilinear> [threads] [warmup] [runs] [csv_path]\n"
+        << "        threads defaults to 1..hardware threads; options: --strong-only --weak-only --schedule S --chunk N --inner N --affinity P\n"
+        << "        --thread-stats (adds imbalance and idle fraction per thread count)\n"
+        << "  Image_resizer_PP_Lab2 yuv <input.yuv> <in_w> <in_h> <420|422> <output_yuv|output_png|output_jpg> <out_w> <out_h> <nearest|bilinear> <seq|omp> [threads] [center|left]\n"
+        << "  Image_resizer_PP_Lab2 pipeline <input> <output_prefix> <out_w> <out_h> <nearest|bilinear> <seq|omp> [threads] [warmup] [runs] [csv_path]\n"
+        << "        [--codecs png,png:9,jpg:80,...]  times read/decode/resize/convert/encode/write separately\n"
+        << "  Image_resizer_PP_Lab2 benchcmp <baseline.csv|json> <candidate.csv|json> [--threshold F] [--alpha A] [--metric COL]\n"
+        << "        [--keys c1,c2,...] [--test auto|mwu|ci|none] [--baseline-samples P] [--candidate-samples P] [--out P]\n"
+        << "        [--allow-missing]  exits with status 3 if any configuration regressed by more than the threshold\n"
+        << "        (default 0.05), has a non-finite metric, or is missing from the candidate (unless --allow-missing)\n"
+        << "  Image_resizer_PP_Lab2 metrics <reference> <distorted> [threads] [--metrics psnr,ssim,ms-ssim] [--reference]\n"
+        << "        full-reference quality (default: all three); --reference also runs the scalar double-precision SSIM\n"
+        << "  Image_resizer_PP_Lab2 attack <input> [threads] [csv_path] [--ratios 2,3,4,2x3] [--pairs nearest:bilinear,...|all] [--top N]\n"
+        << "        down->up reconstruction error (MAE/RMSE/PSNR/max) per ratio and down:up method pair, ranked\n"
+        << "        by vulnerability (defaults: ratios 2,3,4,5,8, all four pairs, attack.csv)\n"
+        << "  Image_resizer_PP_Lab2 detect <dir> [threads] [csv_path] [--size WxH] [--methods nearest,bilinear] [--threshold DB]\n"
+        << "        [--margin DB] [--coarse-step N] [--recursive]  flags images whose downscale to the model size\n"
+        << "        (default 224x224) reconstructs below the PSNR threshold (default 20 dB); a coarse pass over every\n"
+        << "        coarse-step-th row (default 8) accepts clearly benign files early. Exits with status 3 if any\n"
+        << "        attack is found (default detect.csv)\n"
+        << "        [--no-spectral] [--spectral-threshold DB] [--spectral-tile N] [--spectral-tiles N]  the spectral\n"
+        << "        detector (on by default) FFTs a few tiles (default 4 of 256x256) and flags files whose spectrum\n"
+        << "        peaks at the sampling lattice by at least the threshold (default 6 dB) over control points\n"
+        << "  Image_resizer_PP_Lab2 conformance [cases] [seed] [csv_path] [--kernels k1,k2,...] [--max-side N] [--list]\n"
+        << "        runs every registered resize kernel (method x ISA x backend x precision) on randomized cases\n"
+        << "        (random, 1-pixel, extreme ratios, odd strides; default 200 cases, seed 1, max side 257) and checks\n"
+        << "        each against the per-pixel scalar reference; exits with status 3 if any exceeds its max-abs budget\n"
+        << "  Image_resizer_PP_Lab2 hash <input|dir>... [--threads N] [--manifest PATH] [--check PATH] [--golden DIR] [--recursive]\n"
+        << "        128-bit content hash of the decoded pixels and shape; --manifest records them, --check compares\n"
+        << "        them with a manifest (exits with status 3 on any mismatch or missing entry) and --golden DIR\n"
+        << "        diffs mismatching images against DIR/<file name> with compare_images\n"
+        << "\nAny <input> may be synthetic:WxHxC:pattern:seed (pattern: gradient|noise|checker|text|natural,\n"
+        << "sides up to 65536), e.g. synthetic:8192x8192x3:natural:42\n"
+        << "\nAny mode accepts --trace PATH: writes a Chrome trace-event timeline (chrome://tracing, ui.perfetto.dev)\n"
+        << "with the row bands each OpenMP thread processed, barrier waits, benchmark runs and I/O/encode phases.\n"
+        << "\nAny mode accepts --isa LEVEL: runs the resampling row kernels built for baseline, v2, v3 or v4\n"
+        << "(x86-64 microarchitecture levels) instead of the best one the CPU supports (auto); the RESIZER_ISA\n"
+        << "environment variable does the same. The level in use is recorded as isa_level in JSON results.\n"
+        << "\nResult paths ending in .json get a self-describing file: host (CPU, caches, ISA, kernel, governor),\n"
+        << "build (compiler, flags, OpenMP, git revision) and run parameters next to the results; other paths are CSV.\n"
+        << "\nBench options (bench, benchset):\n"
+        << "  --perf                 record hardware counters (cycles, IPC, cache/branch/dTLB misses) via perf_event_open\n"
+        << "  --thread-stats         OpenMP: per-thread busy time, rows and barrier wait; reports the\n"
+        << "                         imbalance ratio (max/mean busy) and the idle fraction of the team\n"
+        << "  --adaptive             keep sampling until the median's 95% CI is tight enough\n"
+        << "  --ci-target F          relative CI half-width target for --adaptive (default 0.02)\n"
+        << "  --budget-ms MS         time budget for --adaptive (default 10000)\n"
+        << "  --max-runs N           run cap for --adaptive (default 1000)\n"
+        << "  --outlier-k K          MAD outlier threshold in robust sigmas (default 3.5)\n"
+        << "  --samples PATH         export raw per-run samples (CSV or .json)\n"
+        << "  --alloc LIST           output buffers: fresh,reused,prefaulted or all (default fresh);\n"
+        << "                         page faults per call are recorded via getrusage\n"
+        << "  --cache LIST           input cache state: warm,flush,rotate or all (default warm);\n"
+        << "                         flush streams a buffer > LLC before each call, rotate cycles input copies\n"
+        << "  --affinity P           pin OpenMP threads: none (default), compact, scatter, cores (one per\n"
+        << "                         physical core) or a CPU list such as 0,2,4-7; topology from sysfs\n"
         << "\nExamples:\n"
         << "  Image_resizer_PP_Lab2 run lena.png out.png 1920 1080 bilinear omp 12\n"
         << "  Image_resizer_PP_Lab2 bench lena.png 3840 2160 bilinear omp 12 2 10 results.csv\n"
         << "  Image_resizer_PP_Lab2 validate lena.png 1024 1024 bilinear 12\n"
-        << "  Image_resizer_PP_Lab2 benchset lena.png 512 512 6 1.5 bilinear omp 12 2 10 sweep.csv\n";
+        << "  Image_resizer_PP_Lab2 benchset lena.png 512 512 6 1.5 bilinear omp 12 2 10 sweep.csv\n"
+        << "  Image_resizer_PP_Lab2 benchset lena.png 0 0 0 0 nearest,bilinear seq,omp 1,4,12 2 10 grid.json --sizes 1920x1080,3840x2160 --schedule static,dynamic\n"
+        << "  Image_resizer_PP_Lab2 scaling lena.png 1920 1080 bilinear 1,2,4,8,12 2 10 scaling.csv\n"
+        << "  Image_resizer_PP_Lab2 yuv clip.yuv 3840 2160 420 half.yuv 1920 1080 bilinear omp 12 left\n"
+        << "  Image_resizer_PP_Lab2 pipeline photo.jpg out/thumb 640 480 bilinear omp 8 2 20 pipeline.csv --codecs png:1,png:6,jpg:85\n"
+        << "  Image_resizer_PP_Lab2 metrics photo.png photo_q80.jpg 8 --metrics ssim\n"
+        << "  Image_resizer_PP_Lab2 attack photo.png 8 attack.csv --ratios 2,4,7.5,4x2 --pairs nearest:nearest,bilinear:bilinear\n"
+        << "  Image_resizer_PP_Lab2 detect uploads/ 8 detect.csv --size 299x299 --threshold 18 --recursive\n"
+        << "  Image_resizer_PP_Lab2 conformance 1000 42 conformance.csv --kernels seq,omp_static_t3\n"
+        << "  Image_resizer_PP_Lab2 hash out/ --check golden.csv --golden golden/\n"
+        << "  Image_resizer_PP_Lab2 benchcmp main.csv branch.csv --threshold 0.03 --baseline-samples main_s.csv --candidate-samples branch_s.csv\n";
 }
 
 CliOptions parse_cli(int argc, char** argv) {
@@ -63,6 +243,25 @@ CliOptions parse_cli(int argc, char** argv) {
     opt.steps  = 0;
     opt.scale  = 1.0;
 
+    // --trace PATH and --isa LEVEL are accepted by every mode: strip them before the mode-specific parsing.
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) == "--trace") {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for --trace");
+            opt.trace_path = argv[++i];
+            continue;
+        }
+        if (std::string(argv[i]) == "--isa") {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for --isa");
+            opt.isa_level = argv[++i];
+            if (to_lower(opt.isa_level) != "auto") parse_isa_level(opt.isa_level);
+            continue;
+        }
+        args.push_back(argv[i]);
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
     if (argc < 2) {
         opt.mode = RunMode::Help;
         return opt;
@@ -71,7 +270,8 @@ CliOptions parse_cli(int argc, char** argv) {
     const std::string mode = to_lower(argv[1]);
 
     if (mode == "run") {
-        if (argc < 8) {
+        const int npos = first_option_index(argc, argv);
+        if (npos < 8) {
             opt.mode = RunMode::Help;
             return opt;
         }
@@ -82,12 +282,23 @@ CliOptions parse_cli(int argc, char** argv) {
         opt.out_h = parse_int(argv[5], "out_h");
         opt.method  = parse_method(argv[6]);
         opt.backend = parse_backend(argv[7]);
-        if (argc >= 9) opt.threads = parse_int(argv[8], "threads");
+        if (npos >= 9) opt.threads = parse_int(argv[8], "threads");
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (flag == "--manifest" && i + 1 < argc) {
+                opt.manifest_path = argv[++i];
+            } else if (flag == "--affinity" && i + 1 < argc) {
+                opt.affinity = parse_affinity(argv[++i]);
+            } else {
+                throw std::invalid_argument("run: unknown option or missing value: " + flag);
+            }
+        }
         return opt;
     }
 
     if (mode == "bench") {
-        if (argc < 7) {
+        const int npos = first_option_index(argc, argv);
+        if (npos < 7) {
             opt.mode = RunMode::Help;
             return opt;
         }
@@ -98,17 +309,25 @@ CliOptions parse_cli(int argc, char** argv) {
         opt.method  = parse_method(argv[5]);
         opt.backend = parse_backend(argv[6]);
 
-        if (argc >= 8)  opt.threads = parse_int(argv[7], "threads");
-        if (argc >= 9)  opt.warmup  = parse_int(argv[8], "warmup");
-        if (argc >= 10) opt.runs    = parse_int(argv[9], "runs");
-        if (argc >= 11) opt.csv_path = argv[10];
+        if (npos >= 8)  opt.threads = parse_int(argv[7], "threads");
+        if (npos >= 9)  opt.warmup  = parse_int(argv[8], "warmup");
+        if (npos >= 10) opt.runs    = parse_int(argv[9], "runs");
+        if (npos >= 11) opt.csv_path = argv[10];
+
+        for (int i = npos; i < argc; ++i) {
+            if (!parse_bench_option(argc, argv, i, opt)) {
+                throw std::invalid_argument("bench: unknown option " + std::string(argv[i]));
+            }
+        }
+        if (opt.runs <= 0) throw std::invalid_argument("bench: runs must be > 0");
 
         return opt;
     }
 
     if (mode == "validate") {
-        // Image_resizer_PP_Lab2 validate <input> <out_w> <out_h> <nearest|bilinear> [threads]
-        if (argc < 6) {
+        // Image_resizer_PP_Lab2 validate <input> <out_w> <out_h> <nearest|bilinear> [threads] [--reference]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 6) {
             opt.mode = RunMode::Help;
             return opt;
         }
@@ -117,14 +336,22 @@ CliOptions parse_cli(int argc, char** argv) {
         opt.out_w = parse_int(argv[3], "out_w");
         opt.out_h = parse_int(argv[4], "out_h");
         opt.method = parse_method(argv[5]);
-        if (argc >= 7) opt.threads = parse_int(argv[6], "threads");
+        if (npos >= 7) opt.threads = parse_int(argv[6], "threads");
+
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (flag == "--reference") opt.compare_reference = true;
+            else throw std::invalid_argument("validate: unknown option " + flag);
+        }
         return opt;
     }
 
     if (mode == "benchset") {
-        // Image_resizer_PP_Lab2 benchset <input> <base_w> <base_h> <steps> <scale> <nearest|bilinear> <seq|omp>
-        //                               [threads] [warmup] [runs] [csv_path]
-        if (argc < 9) {
+        // Image_resizer_PP_Lab2 benchset <input> <base_w> <base_h> <steps> <scale> <methods> <backends>
+        //                               [threads] [warmup] [runs] [csv_path] [--flags...]
+        // methods/backends/threads accept comma-separated lists.
+        const int npos = first_option_index(argc, argv);
+        if (npos < 9) {
             opt.mode = RunMode::Help;
             return opt;
         }
@@ -136,28 +363,508 @@ CliOptions parse_cli(int argc, char** argv) {
         opt.steps  = parse_int(argv[5], "steps");
         opt.scale  = parse_double(argv[6], "scale");
 
-        if (opt.base_w <= 0 || opt.base_h <= 0) {
-            throw std::invalid_argument("benchset: base_w/base_h must be > 0");
+        SweepSpec& sw = opt.sweep;
+        for (const std::string& m : split(argv[7], ',')) sw.methods.push_back(parse_method(m));
+        for (const std::string& b : split(argv[8], ',')) sw.backends.push_back(parse_backend(b));
+
+        // Optional tail
+        if (npos >= 10) sw.threads  = parse_int_list(argv[9], "threads");
+        if (npos >= 11) opt.warmup  = parse_int(argv[10], "warmup");
+        if (npos >= 12) opt.runs    = parse_int(argv[11], "runs");
+        if (npos >= 13) opt.csv_path = argv[12];
+
+        // Named options
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("benchset: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--sizes") {
+                for (const std::string& item : split(value(), ',')) {
+                    const std::vector<std::string> wh = split(to_lower(item), 'x');
+                    if (wh.size() != 2) throw std::invalid_argument("benchset: size must be WxH: " + item);
+                    sw.sizes.emplace_back(parse_int(wh[0], "size width"), parse_int(wh[1], "size height"));
+                }
+            } else if (flag == "--threads") {
+                sw.threads = parse_int_list(value(), "threads");
+            } else if (flag == "--schedule") {
+                for (const std::string& v : split(value(), ',')) sw.schedules.push_back(parse_schedule(v));
+            } else if (flag == "--chunk") {
+                sw.chunks = parse_int_list(value(), "chunk");
+            } else if (flag == "--inner") {
+                sw.inner_reps = parse_int(value(), "inner");
+            } else if (flag == "--seed") {
+                sw.seed = static_cast<std::uint32_t>(parse_int(value(), "seed"));
+            } else if (flag == "--no-shuffle") {
+                sw.shuffle = false;
+            } else if (parse_bench_option(argc, argv, i, opt)) {
+                // handled
+            } else {
+                throw std::invalid_argument("benchset: unknown option " + flag);
+            }
         }
-        if (opt.steps <= 0) {
-            throw std::invalid_argument("benchset: steps must be > 0");
+
+        if (sw.sizes.empty()) {
+            if (opt.base_w <= 0 || opt.base_h <= 0) {
+                throw std::invalid_argument("benchset: base_w/base_h must be > 0");
+            }
+            if (opt.steps <= 0) {
+                throw std::invalid_argument("benchset: steps must be > 0");
+            }
+            if (opt.scale <= 1.0) {
+                throw std::invalid_argument("benchset: scale must be > 1.0 (e.g., 1.25, 1.5, 2.0)");
+            }
+            sw.sizes = geometric_sizes(opt.base_w, opt.base_h, opt.steps, opt.scale);
         }
-        if (opt.scale <= 1.0) {
-            throw std::invalid_argument("benchset: scale must be > 1.0 (e.g., 1.25, 1.5, 2.0)");
+        if (opt.warmup < 0 || opt.runs <= 0 || sw.inner_reps <= 0) {
+            throw std::invalid_argument("benchset: warmup must be >= 0, runs and --inner must be > 0");
         }
+        sw.warmup = opt.warmup;
+        sw.runs = opt.runs;
+        sw.bench = opt.bench;
+        sw.samples_path = opt.samples_path;
+        sw.allocs = opt.alloc_modes;
+        sw.caches = opt.cache_modes;
+        sw.affinity = opt.affinity;
 
-        opt.method  = parse_method(argv[7]);
-        opt.backend = parse_backend(argv[8]);
+        opt.method  = sw.methods.front();
+        opt.backend = sw.backends.front();
+        if (!sw.threads.empty()) opt.threads = sw.threads.front();
 
-        // Optional tail
-        if (argc >= 10) opt.threads = parse_int(argv[9], "threads");
-        if (argc >= 11) opt.warmup  = parse_int(argv[10], "warmup");
-        if (argc >= 12) opt.runs    = parse_int(argv[11], "runs");
-        if (argc >= 13) opt.csv_path = argv[12];
+        return opt;
+    }
+
+    if (mode == "scaling") {
+        // Image_resizer_PP_Lab2 scaling <input> <out_w> <out_h> <nearest|bilinear>
+        //                              [threads] [warmup] [runs] [csv_path] [--flags...]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 6) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Scaling;
+        opt.input_path = argv[2];
+        opt.csv_path = "scaling.csv";
+
+        ScalingSpec& sc = opt.scaling;
+        sc.out_w  = parse_int(argv[3], "out_w");
+        sc.out_h  = parse_int(argv[4], "out_h");
+        sc.method = parse_method(argv[5]);
+        if (npos >= 7)  sc.threads   = parse_int_list(argv[6], "threads");
+        if (npos >= 8)  opt.warmup   = parse_int(argv[7], "warmup");
+        if (npos >= 9)  opt.runs     = parse_int(argv[8], "runs");
+        if (npos >= 10) opt.csv_path = argv[9];
+
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("scaling: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--strong-only") {
+                sc.weak = false;
+            } else if (flag == "--weak-only") {
+                sc.strong = false;
+            } else if (flag == "--schedule") {
+                sc.popt.schedule = parse_schedule(value());
+            } else if (flag == "--chunk") {
+                sc.popt.chunk = parse_int(value(), "chunk");
+            } else if (flag == "--inner") {
+                sc.inner_reps = parse_int(value(), "inner");
+            } else if (flag == "--affinity") {
+                opt.affinity = parse_affinity(value());
+            } else if (flag == "--thread-stats") {
+                sc.thread_stats = true;
+            } else {
+                throw std::invalid_argument("scaling: unknown option " + flag);
+            }
+        }
+
+        if (sc.out_w <= 0 || sc.out_h <= 0) throw std::invalid_argument("scaling: out_w/out_h must be > 0");
+        if (!sc.strong && !sc.weak) throw std::invalid_argument("scaling: --strong-only and --weak-only are exclusive");
+        for (int t : sc.threads) {
+            if (t <= 0) throw std::invalid_argument("scaling: thread counts must be > 0");
+        }
+        sc.warmup = opt.warmup;
+        sc.runs = opt.runs;
+
+        opt.out_w = sc.out_w;
+        opt.out_h = sc.out_h;
+        opt.method = sc.method;
+        opt.backend = Backend::OpenMP;
+        return opt;
+    }
+
+    if (mode == "yuv") {
+        // Image_resizer_PP_Lab2 yuv <input.yuv> <in_w> <in_h> <420|422> <output> <out_w> <out_h>
+        //                          <nearest|bilinear> <seq|omp> [threads] [center|left]
+        if (argc < 11) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Yuv;
+        opt.input_path = argv[2];
+        opt.in_w = parse_int(argv[3], "in_w");
+        opt.in_h = parse_int(argv[4], "in_h");
+        opt.chroma_format = parse_chroma_format(argv[5]);
+        opt.output_path = argv[6];
+        opt.out_w = parse_int(argv[7], "out_w");
+        opt.out_h = parse_int(argv[8], "out_h");
+        opt.method  = parse_method(argv[9]);
+        opt.backend = parse_backend(argv[10]);
+        if (argc >= 12) opt.threads = parse_int(argv[11], "threads");
+        if (argc >= 13) opt.chroma_siting = parse_chroma_siting(argv[12]);
+        return opt;
+    }
+
+    if (mode == "pipeline") {
+        // Image_resizer_PP_Lab2 pipeline <input> <output_prefix> <out_w> <out_h> <nearest|bilinear> <seq|omp>
+        //                               [threads] [warmup] [runs] [csv_path] [--codecs list]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 8) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Pipeline;
+        opt.input_path  = argv[2];
+        opt.output_path = argv[3];
+        opt.out_w   = parse_int(argv[4], "out_w");
+        opt.out_h   = parse_int(argv[5], "out_h");
+        opt.method  = parse_method(argv[6]);
+        opt.backend = parse_backend(argv[7]);
+        if (npos >= 9)  opt.threads  = parse_int(argv[8], "threads");
+        if (npos >= 10) opt.warmup   = parse_int(argv[9], "warmup");
+        if (npos >= 11) opt.runs     = parse_int(argv[10], "runs");
+        opt.csv_path = (npos >= 12) ? argv[11] : "pipeline.csv";
+
+        PipelineSpec& ps = opt.pipeline;
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (flag == "--codecs" && i + 1 < argc) {
+                ps.codecs.clear();
+                for (const std::string& c : split(argv[++i], ',')) ps.codecs.push_back(parse_codec_setting(c));
+            } else {
+                throw std::invalid_argument("pipeline: unknown option or missing value: " + flag);
+            }
+        }
+
+        ps.input_path = opt.input_path;
+        ps.output_prefix = opt.output_path;
+        ps.out_w = opt.out_w;
+        ps.out_h = opt.out_h;
+        ps.method = opt.method;
+        ps.backend = opt.backend;
+        ps.threads = opt.threads;
+        ps.warmup = opt.warmup;
+        ps.runs = opt.runs;
+        return opt;
+    }
+
+    if (mode == "benchcmp") {
+        // Image_resizer_PP_Lab2 benchcmp <baseline> <candidate> [--flags...]
+        const int npos = first_option_index(argc, argv);
+        if (npos != 4) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::BenchCmp;
+        opt.csv_path.clear();
+
+        BenchCmpSpec& bc = opt.benchcmp;
+        bc.baseline_path = argv[2];
+        bc.candidate_path = argv[3];
+
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("benchcmp: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--threshold") {
+                bc.threshold = parse_double(value(), "threshold");
+            } else if (flag == "--alpha") {
+                bc.alpha = parse_double(value(), "alpha");
+            } else if (flag == "--metric") {
+                bc.metric = value();
+            } else if (flag == "--keys") {
+                bc.keys = split(value(), ',');
+            } else if (flag == "--test") {
+                bc.test = parse_cmp_test(value());
+            } else if (flag == "--baseline-samples") {
+                bc.baseline_samples = value();
+            } else if (flag == "--candidate-samples") {
+                bc.candidate_samples = value();
+            } else if (flag == "--out") {
+                opt.csv_path = value();
+            } else if (flag == "--allow-missing") {
+                bc.allow_missing = true;
+            } else {
+                throw std::invalid_argument("benchcmp: unknown option " + flag);
+            }
+        }
+        return opt;
+    }
+
+    if (mode == "metrics") {
+        // Image_resizer_PP_Lab2 metrics <reference> <distorted> [threads] [--flags...]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 4) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Metrics;
+        opt.input_path = argv[2];
+        opt.distorted_path = argv[3];
+        if (npos >= 5) opt.threads = parse_int(argv[4], "threads");
+
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (flag == "--metrics" && i + 1 < argc) {
+                opt.metric_psnr = opt.metric_ssim = opt.metric_ms_ssim = false;
+                for (const std::string& m : split(to_lower(argv[++i]), ',')) {
+                    if (m == "psnr") opt.metric_psnr = true;
+                    else if (m == "ssim") opt.metric_ssim = true;
+                    else if (m == "ms-ssim" || m == "msssim") opt.metric_ms_ssim = true;
+                    else throw std::invalid_argument("metrics: unknown metric " + m);
+                }
+            } else if (flag == "--reference") {
+                opt.compare_reference = true;
+            } else {
+                throw std::invalid_argument("metrics: unknown option or missing value: " + flag);
+            }
+        }
+        return opt;
+    }
+
+    if (mode == "attack") {
+        // Image_resizer_PP_Lab2 attack <input> [threads] [csv_path] [--flags...]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 3) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Attack;
+        opt.input_path = argv[2];
+        opt.backend = Backend::OpenMP;
+        if (npos >= 4) opt.threads = parse_int(argv[3], "threads");
+        opt.csv_path = (npos >= 5) ? argv[4] : "attack.csv";
+
+        AttackSpec& as = opt.attack;
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("attack: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--ratios") {
+                as.ratios.clear();
+                for (const std::string& r : split(value(), ',')) as.ratios.push_back(parse_attack_ratio(r));
+            } else if (flag == "--pairs") {
+                const std::string v = to_lower(value());
+                if (v != "all") {
+                    as.method_pairs.clear();
+                    for (const std::string& p : split(v, ',')) {
+                        const std::vector<std::string> du = split(p, ':');
+                        if (du.size() != 2) throw std::invalid_argument("attack: pair must be down:up: " + p);
+                        as.method_pairs.emplace_back(parse_method(du[0]), parse_method(du[1]));
+                    }
+                }
+            } else if (flag == "--top") {
+                as.top = parse_int(value(), "top");
+            } else {
+                throw std::invalid_argument("attack: unknown option " + flag);
+            }
+        }
+        if (as.ratios.empty() || as.method_pairs.empty()) throw std::invalid_argument("attack: empty ratio or pair list");
+        as.threads = opt.threads;
+        return opt;
+    }
 
+    if (mode == "detect") {
+        // Image_resizer_PP_Lab2 detect <dir> [threads] [csv_path] [--flags...]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 3) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Detect;
+        opt.backend = Backend::OpenMP;
+        if (npos >= 4) opt.threads = parse_int(argv[3], "threads");
+        opt.csv_path = (npos >= 5) ? argv[4] : "detect.csv";
+
+        DetectSpec& ds = opt.detect;
+        ds.input_dir = argv[2];
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("detect: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--size") {
+                const std::string v = value();
+                const std::vector<std::string> wh = split(to_lower(v), 'x');
+                if (wh.size() != 2) throw std::invalid_argument("detect: size must be WxH: " + v);
+                ds.target_w = parse_int(wh[0], "size width");
+                ds.target_h = parse_int(wh[1], "size height");
+            } else if (flag == "--methods") {
+                ds.methods.clear();
+                for (const std::string& m : split(value(), ',')) ds.methods.push_back(parse_method(m));
+            } else if (flag == "--threshold") {
+                ds.threshold_db = parse_double(value(), "threshold");
+            } else if (flag == "--margin") {
+                ds.coarse_margin_db = parse_double(value(), "margin");
+            } else if (flag == "--coarse-step") {
+                ds.coarse_row_step = parse_int(value(), "coarse-step");
+            } else if (flag == "--recursive") {
+                ds.recursive = true;
+            } else if (flag == "--no-spectral") {
+                ds.use_spectral = false;
+            } else if (flag == "--spectral-threshold") {
+                ds.spectral.threshold_db = parse_double(value(), "spectral-threshold");
+            } else if (flag == "--spectral-tile") {
+                ds.spectral.tile = parse_int(value(), "spectral-tile");
+            } else if (flag == "--spectral-tiles") {
+                ds.spectral.max_tiles = parse_int(value(), "spectral-tiles");
+            } else {
+                throw std::invalid_argument("detect: unknown option " + flag);
+            }
+        }
+        if (ds.target_w <= 0 || ds.target_h <= 0) throw std::invalid_argument("detect: size must be positive");
+        if (ds.methods.empty()) throw std::invalid_argument("detect: empty method list");
+        if (ds.coarse_row_step < 1) throw std::invalid_argument("detect: coarse-step must be >= 1");
+        if (ds.spectral.tile < 1 || ds.spectral.max_tiles < 1) {
+            throw std::invalid_argument("detect: spectral-tile and spectral-tiles must be >= 1");
+        }
+        ds.threads = opt.threads;
+        return opt;
+    }
+
+    if (mode == "conformance") {
+        // Image_resizer_PP_Lab2 conformance [cases] [seed] [csv_path] [--flags...]
+        const int npos = first_option_index(argc, argv);
+        opt.mode = RunMode::Conformance;
+        ConformanceSpec& cs = opt.conformance;
+        if (npos >= 3) cs.cases = parse_int(argv[2], "cases");
+        if (npos >= 4) cs.seed = static_cast<std::uint64_t>(parse_int(argv[3], "seed"));
+        opt.csv_path = (npos >= 5) ? argv[4] : "conformance.csv";
+
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("conformance: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--kernels") {
+                cs.filter = split(value(), ',');
+            } else if (flag == "--max-side") {
+                cs.max_side = parse_int(value(), "max-side");
+            } else if (flag == "--list") {
+                opt.conformance_list = true;
+            } else {
+                throw std::invalid_argument("conformance: unknown option " + flag);
+            }
+        }
+        if (cs.cases < 1) throw std::invalid_argument("conformance: cases must be >= 1");
+        if (cs.max_side < 2) throw std::invalid_argument("conformance: max-side must be >= 2");
+        return opt;
+    }
+
+    if (mode == "hash") {
+        // Image_resizer_PP_Lab2 hash <input|dir>... [--flags...]
+        const int npos = first_option_index(argc, argv);
+        if (npos < 3) {
+            opt.mode = RunMode::Help;
+            return opt;
+        }
+        opt.mode = RunMode::Hash;
+        opt.hash_inputs.assign(argv + 2, argv + npos);
+
+        for (int i = npos; i < argc; ++i) {
+            const std::string flag = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("hash: missing value for " + flag);
+                return argv[++i];
+            };
+
+            if (flag == "--threads") {
+                opt.threads = parse_int(value(), "threads");
+            } else if (flag == "--manifest") {
+                opt.manifest_path = value();
+            } else if (flag == "--check") {
+                opt.check_manifest = value();
+            } else if (flag == "--golden") {
+                opt.golden_dir = value();
+            } else if (flag == "--recursive") {
+                opt.hash_recursive = true;
+            } else {
+                throw std::invalid_argument("hash: unknown option " + flag);
+            }
+        }
+        if (!opt.golden_dir.empty() && opt.check_manifest.empty()) {
+            throw std::invalid_argument("hash: --golden needs --check");
+        }
         return opt;
     }
 
     opt.mode = RunMode::Help;
     return opt;
-}
\ No newline at end of file
+}
+
+const char* run_mode_name(RunMode m) {
+    switch (m) {
+        case RunMode::Run:      return "run";
+        case RunMode::Bench:    return "bench";
+        case RunMode::Validate: return "validate";
+        case RunMode::BenchSet: return "benchset";
+        case RunMode::Scaling:  return "scaling";
+        case RunMode::Yuv:      return "yuv";
+        case RunMode::BenchCmp: return "benchcmp";
+        case RunMode::Pipeline: return "pipeline";
+        case RunMode::Metrics:  return "metrics";
+        case RunMode::Attack:   return "attack";
+        case RunMode::Detect:   return "detect";
+        case RunMode::Conformance: return "conformance";
+        case RunMode::Hash:     return "hash";
+        case RunMode::Help:     return "help";
+    }
+    return "unknown";
+}
+
+MetadataFields cli_run_parameters(const CliOptions& opt, int argc, char** argv) {
+    using I = std::int64_t;
+    MetadataFields p;
+    p.emplace_back("command", command_line(argc, argv));
+    p.emplace_back("mode", std::string(run_mode_name(opt.mode)));
+    p.emplace_back("input", opt.input_path);
+    p.emplace_back("output", opt.output_path);
+    p.emplace_back("method", std::string(method_name(opt.method)));
+    p.emplace_back("backend", std::string(backend_name(opt.backend)));
+    p.emplace_back("threads", static_cast<I>(opt.threads));
+    p.emplace_back("out_w", static_cast<I>(opt.out_w));
+    p.emplace_back("out_h", static_cast<I>(opt.out_h));
+    p.emplace_back("warmup", static_cast<I>(opt.warmup));
+    p.emplace_back("runs", static_cast<I>(opt.runs));
+    p.emplace_back("perf", static_cast<I>(opt.bench.perf_counters ? 1 : 0));
+    p.emplace_back("thread_stats", static_cast<I>((opt.bench.thread_stats || opt.scaling.thread_stats) ? 1 : 0));
+    p.emplace_back("adaptive", static_cast<I>(opt.bench.adaptive ? 1 : 0));
+    p.emplace_back("ci_target", opt.bench.ci_target);
+    p.emplace_back("outlier_k", opt.bench.outlier_k);
+
+    std::string affinity = affinity_policy_name(opt.affinity.policy);
+    if (opt.affinity.policy != AffinityPolicy::None) {
+        std::string cpus;
+        for (int c : affinity_cpu_order(opt.affinity)) cpus += (cpus.empty() ? "" : ",") + std::to_string(c);
+        affinity += " (cpus " + cpus + ")";
+    }
+    p.emplace_back("affinity", affinity);
+    p.emplace_back("trace", opt.trace_path);
+    p.emplace_back("isa", opt.isa_level.empty() ? std::string("auto") : opt.isa_level);
+    return p;
+}
@@ -0,0 +1,317 @@
+// conformance.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the kernel conformance harness.
+#include "conformance.hpp"
+
+#include "dispatch.hpp"
+#include "kernels.hpp"
+#include "resize_operator.hpp"
+#include "results.hpp"
+#include "trace.hpp"
+#include "validate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+const std::vector<ResizeMethod> both_methods = {ResizeMethod::Nearest, ResizeMethod::Bilinear};
+
+struct ConformanceCase {
+    std::string kind;
+    int in_w = 1, in_h = 1, channels = 1;
+    int out_w = 1, out_h = 1;
+    Image input;
+
+    [[nodiscard]] std::string describe() const {
+        return kind + " " + std::to_string(in_w) + "x" + std::to_string(in_h) + "x" + std::to_string(channels)
+               + " -> " + std::to_string(out_w) + "x" + std::to_string(out_h);
+    }
+};
+
+// Output buffer filled with a sentinel so that pixels a kernel forgets to write show up.
+Image poisoned(int w, int h, int channels) {
+    Image out(w, h, channels);
+    std::fill(out.data.begin(), out.data.end(), std::uint8_t{0xCD});
+    return out;
+}
+
+ConformanceKernel omp_kernel(const std::string& name, const std::string& isa, int threads, OmpSchedule schedule,
+                             int chunk) {
+    return {name, both_methods, isa, "omp", "f32", 0,
+            [=](const Image& in, int w, int h, ResizeMethod m) {
+                ParallelOptions popt;
+                popt.schedule = schedule;
+                popt.chunk = chunk;
+                return resize_omp(in, w, h, m, threads, popt);
+            }};
+}
+
+// The row kernels driven directly: the two-pass bilinear path the fused kernel must match.
+Image separable_resize(const Image& in, int out_w, int out_h, ResizeMethod method) {
+    Image out(out_w, out_h, in.channels);
+    const ColumnMap cm = make_column_map(in.width, out_w, method);
+    const std::size_t n = static_cast<std::size_t>(out_w) * in.channels;
+    std::vector<float> h0(n), h1(n);
+    for (int y = 0; y < out_h; ++y) {
+        const RowTap t = row_tap(y, in.height, out_h, method);
+        if (method == ResizeMethod::Nearest) {
+            nearest_row(in.row_ptr(t.y0), out.row_ptr(y), cm, out_w, in.channels);
+            continue;
+        }
+        hpass_row(in.row_ptr(t.y0), h0.data(), cm, out_w, in.channels);
+        hpass_row(in.row_ptr(t.y1), h1.data(), cm, out_w, in.channels);
+        vpass_row(h0.data(), h1.data(), out.row_ptr(y), t.wy, static_cast<int>(n));
+    }
+    return out;
+}
+
+// One x86-64 level's row kernels called through its table, bypassing the
+// dispatch: fused bilinear, or the hpass/vpass pair when separable is set.
+ConformanceKernel level_kernel(const KernelTable& t, bool separable) {
+    const std::string isa = isa_level_name(t.level);
+    return {std::string(separable ? "separable_" : "fused_") + isa, both_methods, isa, "seq", "f32", 0,
+            [&t, separable](const Image& in, int out_w, int out_h, ResizeMethod method) {
+                Image out = poisoned(out_w, out_h, in.channels);
+                const ColumnMap cm = make_column_map(in.width, out_w, method);
+                const std::size_t n = static_cast<std::size_t>(out_w) * in.channels;
+                std::vector<float> h0(n), h1(n);
+                for (int y = 0; y < out_h; ++y) {
+                    const RowTap r = row_tap(y, in.height, out_h, method);
+                    if (method == ResizeMethod::Nearest) {
+                        t.nearest_row(in.row_ptr(r.y0), out.row_ptr(y), cm.x0.data(), out_w, in.channels);
+                    } else if (separable) {
+                        t.hpass_row(in.row_ptr(r.y0), h0.data(), cm.x0.data(), cm.x1.data(), cm.wx.data(), out_w, in.channels);
+                        t.hpass_row(in.row_ptr(r.y1), h1.data(), cm.x0.data(), cm.x1.data(), cm.wx.data(), out_w, in.channels);
+                        t.vpass_row(h0.data(), h1.data(), out.row_ptr(y), r.wy, static_cast<int>(n));
+                    } else {
+                        t.bilinear_row(in.row_ptr(r.y0), in.row_ptr(r.y1), out.row_ptr(y),
+                                       cm.x0.data(), cm.x1.data(), cm.wx.data(), r.wy, out_w, in.channels);
+                    }
+                }
+                return out;
+            }};
+}
+
+std::vector<ConformanceCase> make_cases(const ConformanceSpec& spec) {
+    std::mt19937_64 rng(spec.seed);
+    auto uniform = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    const int side = std::max(2, spec.max_side);
+    const int channel_set[] = {1, 3, 4};
+
+    std::vector<ConformanceCase> cases;
+    for (int i = 0; i < spec.cases; ++i) {
+        ConformanceCase c;
+        c.channels = channel_set[i % 3];
+        switch ((i / 3) % 5) {
+            case 0:
+                c.kind = "random";
+                c.in_w = uniform(1, side);  c.in_h = uniform(1, side);
+                c.out_w = uniform(1, side); c.out_h = uniform(1, side);
+                break;
+            case 1: { // one of the four dimensions is a single pixel
+                c.kind = "one-pixel";
+                c.in_w = uniform(1, side);  c.in_h = uniform(1, side);
+                c.out_w = uniform(1, side); c.out_h = uniform(1, side);
+                int* dims[] = {&c.in_w, &c.in_h, &c.out_w, &c.out_h};
+                *dims[uniform(0, 3)] = 1;
+                if (uniform(0, 3) == 0) *dims[uniform(0, 3)] = 1;
+                break;
+            }
+            case 2:
+                c.kind = "extreme-down";
+                c.in_w = uniform(side, 8 * side); c.in_h = uniform(1, side);
+                c.out_w = uniform(1, 3);          c.out_h = uniform(1, side);
+                if (uniform(0, 1)) { std::swap(c.in_w, c.in_h); std::swap(c.out_w, c.out_h); }
+                break;
+            case 3:
+                c.kind = "extreme-up";
+                c.in_w = uniform(1, 3);           c.in_h = uniform(1, side);
+                c.out_w = uniform(side, 4 * side); c.out_h = uniform(1, side);
+                if (uniform(0, 1)) { std::swap(c.in_w, c.in_h); std::swap(c.out_w, c.out_h); }
+                break;
+            default: // odd widths: rows of an odd number of bytes with 1 and 3 channels
+                c.kind = "odd-stride";
+                c.in_w = 2 * uniform(0, side / 2) + 1;  c.in_h = uniform(1, side);
+                c.out_w = 2 * uniform(0, side / 2) + 1; c.out_h = uniform(1, side);
+                break;
+        }
+        c.input = Image(c.in_w, c.in_h, c.channels);
+        for (std::uint8_t& v : c.input.data) v = static_cast<std::uint8_t>(rng());
+        cases.push_back(std::move(c));
+    }
+    return cases;
+}
+
+} // namespace
+
+Image resize_reference(const Image& in, int out_w, int out_h, ResizeMethod method) {
+    if (in.empty()) throw std::invalid_argument("resize_reference: empty input");
+    if (out_w <= 0 || out_h <= 0) throw std::invalid_argument("resize_reference: output size must be > 0");
+
+    Image out(out_w, out_h, in.channels);
+    const float iw = static_cast<float>(in.width), ih = static_cast<float>(in.height);
+    const float ow = static_cast<float>(out_w), oh = static_cast<float>(out_h);
+    for (int y = 0; y < out_h; ++y) {
+        const float sy = map_coord(static_cast<float>(y), ih, oh);
+        for (int x = 0; x < out_w; ++x) {
+            const float sx = map_coord(static_cast<float>(x), iw, ow);
+            for (int c = 0; c < in.channels; ++c) {
+                if (method == ResizeMethod::Nearest) {
+                    const int ix = clamp_int(static_cast<int>(std::lround(sx)), 0, in.width - 1);
+                    const int iy = clamp_int(static_cast<int>(std::lround(sy)), 0, in.height - 1);
+                    out.at(x, y, c) = in.at(ix, iy, c);
+                    continue;
+                }
+                const int x0 = clamp_int(static_cast<int>(std::floor(sx)), 0, in.width - 1);
+                const int y0 = clamp_int(static_cast<int>(std::floor(sy)), 0, in.height - 1);
+                const int x1 = clamp_int(x0 + 1, 0, in.width - 1);
+                const int y1 = clamp_int(y0 + 1, 0, in.height - 1);
+                const float wx = sx - static_cast<float>(x0);
+                const float wy = sy - static_cast<float>(y0);
+                const float p00 = in.at(x0, y0, c), p10 = in.at(x1, y0, c);
+                const float p01 = in.at(x0, y1, c), p11 = in.at(x1, y1, c);
+                const float top = p00 + wx * (p10 - p00);
+                const float bot = p01 + wx * (p11 - p01);
+                out.at(x, y, c) = clamp_u8(static_cast<int>(std::lround(top + wy * (bot - top))));
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<ConformanceKernel> conformance_kernels() {
+    // Everything but the sparse operator runs the row kernels of the active level.
+    const std::string isa = isa_level_name(active_kernels().level);
+    std::vector<ConformanceKernel> k;
+    k.push_back({"seq", both_methods, isa, "seq", "f32", 0,
+                 [](const Image& in, int w, int h, ResizeMethod m) { return resize_seq(in, w, h, m); }});
+    k.push_back({"seq_into", both_methods, isa, "seq", "f32", 0,
+                 [](const Image& in, int w, int h, ResizeMethod m) {
+                     Image out = poisoned(w, h, in.channels);
+                     resize_seq_into(in, out, m);
+                     return out;
+                 }});
+    k.push_back({"rows_separable", both_methods, isa, "seq", "f32", 0, separable_resize});
+    k.push_back(omp_kernel("omp_static_t1", isa, 1, OmpSchedule::Static, 0));
+    k.push_back(omp_kernel("omp_static_t3", isa, 3, OmpSchedule::Static, 0));
+    k.push_back(omp_kernel("omp_dynamic_c1_t3", isa, 3, OmpSchedule::Dynamic, 1));
+    k.push_back(omp_kernel("omp_guided_t4", isa, 4, OmpSchedule::Guided, 0));
+    k.push_back({"omp_into_t2", both_methods, isa, "omp", "f32", 0,
+                 [](const Image& in, int w, int h, ResizeMethod m) {
+                     Image out = poisoned(w, h, in.channels);
+                     resize_omp_into(in, out, m, 2);
+                     return out;
+                 }});
+    k.push_back({"sparse_operator", both_methods, "scalar", "omp", "f32", 0,
+                 [](const Image& in, int w, int h, ResizeMethod m) {
+                     const ResizeOperator op = resize_operator(in.width, in.height, w, h, m);
+                     return apply_resize_operator(op, {in}, 2).front();
+                 }});
+    for (IsaLevel level : compiled_isa_levels()) {
+        const KernelTable* t = kernel_table(level);
+        if (t == nullptr) continue;
+        k.push_back(level_kernel(*t, false));
+        k.push_back(level_kernel(*t, true));
+    }
+    return k;
+}
+
+std::vector<ConformanceResult> run_conformance(const ConformanceSpec& spec, std::ostream& log) {
+    if (spec.cases <= 0) throw std::invalid_argument("conformance: cases must be > 0");
+
+    std::vector<ConformanceKernel> kernels = conformance_kernels();
+    if (!spec.filter.empty()) {
+        for (const std::string& f : spec.filter) {
+            const bool known = std::any_of(kernels.begin(), kernels.end(), [&](const ConformanceKernel& k) { return k.name == f; });
+            if (!known) throw std::invalid_argument("conformance: unknown kernel " + f);
+        }
+        std::erase_if(kernels, [&](const ConformanceKernel& k) {
+            return std::find(spec.filter.begin(), spec.filter.end(), k.name) == spec.filter.end();
+        });
+    }
+
+    const std::vector<ConformanceCase> cases = make_cases(spec);
+    log << "Conformance: " << kernels.size() << " kernels x " << cases.size() << " cases (seed " << spec.seed
+        << ", max side " << spec.max_side << ")\n";
+
+    std::vector<ConformanceResult> results;
+    for (ResizeMethod m : both_methods) {
+        TRACE_SCOPE("conformance method", trace_cat::bench);
+        std::vector<Image> refs;
+        refs.reserve(cases.size());
+        for (const ConformanceCase& c : cases) refs.push_back(resize_reference(c.input, c.out_w, c.out_h, m));
+
+        for (const ConformanceKernel& k : kernels) {
+            if (std::find(k.methods.begin(), k.methods.end(), m) == k.methods.end()) continue;
+            ConformanceResult r;
+            r.kernel = k.name;
+            r.method = m;
+            r.isa = k.isa;
+            r.backend = k.backend;
+            r.precision = k.precision;
+            r.budget = k.max_abs_budget;
+            for (std::size_t i = 0; i < cases.size(); ++i) {
+                const ConformanceCase& c = cases[i];
+                r.cases++;
+                std::string failure;
+                try {
+                    const Image out = k.run(c.input, c.out_w, c.out_h, m);
+                    const DiffStats d = compare_images(out, refs[i], 1);
+                    r.max_abs = std::max(r.max_abs, d.max_abs_diff);
+                    r.different_values += d.different_values;
+                    if (d.max_abs_diff > k.max_abs_budget) {
+                        failure = c.describe() + ": max_abs " + std::to_string(d.max_abs_diff) + " at (" +
+                                  std::to_string(d.first_x) + "," + std::to_string(d.first_y) + "," +
+                                  std::to_string(d.first_c) + ")";
+                    }
+                } catch (const std::exception& e) {
+                    failure = c.describe() + ": " + e.what();
+                }
+                if (!failure.empty()) {
+                    if (r.failures++ == 0) r.first_failure = failure;
+                }
+            }
+            results.push_back(std::move(r));
+        }
+    }
+    return results;
+}
+
+void write_conformance_results(const std::vector<ConformanceResult>& results, const std::string& path) {
+    using I = std::int64_t;
+    ResultWriter writer(path, {
+        "kernel", "method", "isa", "backend", "precision", "budget", "cases", "failures", "max_abs",
+        "different_values", "first_failure"
+    });
+    for (const ConformanceResult& r : results) {
+        writer.add_row({
+            r.kernel, std::string(method_name(r.method)), r.isa, r.backend, r.precision,
+            static_cast<I>(r.budget), static_cast<I>(r.cases), static_cast<I>(r.failures), static_cast<I>(r.max_abs),
+            static_cast<I>(r.different_values), r.first_failure
+        });
+    }
+    writer.flush();
+}
+
+void print_conformance_summary(const std::vector<ConformanceResult>& results, std::ostream& os) {
+    int failed = 0;
+    os << "\n  kernel                 method    isa        backend  prec  budget  cases  max_abs  status\n";
+    for (const ConformanceResult& r : results) {
+        os << "  " << std::left << std::setw(21) << r.kernel << "  " << std::setw(8) << method_name(r.method)
+           << "  " << std::setw(9) << r.isa << "  " << std::setw(7) << r.backend << "  " << std::setw(4) << r.precision
+           << std::right << "  " << std::setw(6) << r.budget << "  " << std::setw(5) << r.cases
+           << "  " << std::setw(7) << r.max_abs << "  " << (r.failures == 0 ? "ok" : "FAIL") << "\n";
+        if (r.failures > 0) {
+            failed++;
+            os << "      " << r.failures << " failing cases, first: " << r.first_failure << "\n";
+        }
+    }
+    os << "\n" << (results.size() - static_cast<std::size_t>(failed)) << "/" << results.size()
+       << " kernel x method combinations within budget\n";
+}
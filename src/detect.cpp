@@ -0,0 +1,250 @@
+// detect.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the batch scaling-attack screening.
+#include "detect.hpp"
+
+#include "io.hpp"
+#include "results.hpp"
+#include "scaling_attacks.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static const char* flagged_by(const DetectResult& r) {
+    if (r.psnr_flag && r.spectral_flag) return "psnr+spectral";
+    if (r.psnr_flag) return "psnr";
+    if (r.spectral_flag) return "spectral";
+    return "";
+}
+
+static bool is_image_file(const fs::path& p) {
+    const std::string ext = to_lower(p.extension().string());
+    for (const char* e : {".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif", ".psd"}) {
+        if (ext == e) return true;
+    }
+    return false;
+}
+
+std::vector<std::string> detect_list_files(const std::string& dir, bool recursive) {
+    if (!fs::is_directory(dir)) throw std::invalid_argument("detect: not a directory: " + dir);
+
+    std::vector<std::string> files;
+    auto add = [&](const fs::directory_entry& e) {
+        if (e.is_regular_file() && is_image_file(e.path())) files.push_back(e.path().string());
+    };
+    if (recursive) {
+        for (const auto& e : fs::recursive_directory_iterator(dir)) add(e);
+    } else {
+        for (const auto& e : fs::directory_iterator(dir)) add(e);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+DetectResult detect_image(const Image& img, const DetectSpec& spec) {
+    TRACE_SCOPE_ARGS("detect", trace_cat::metrics, "width", img.width, "height", img.height);
+
+    DetectResult r;
+    r.width = img.width;
+    r.height = img.height;
+    r.channels = img.channels;
+
+    if (spec.use_spectral) {
+        // Inside the per-file parallel loop the FFT's own OpenMP region is nested, hence serial.
+        r.spectral = spectral_scan(img, spec.target_w, spec.target_h, spec.spectral, 1);
+        r.spectral_flag = r.spectral.applicable && r.spectral.score_db >= spec.spectral.threshold_db;
+    }
+
+    // The downscaled images are small (target size) and shared by both passes.
+    std::vector<Image> downs;
+    for (ResizeMethod m : spec.methods) downs.push_back(resize_seq(img, spec.target_w, spec.target_h, m));
+
+    auto pass = [&](int row_step) {
+        r.psnr_db.clear();
+        r.score_db = std::numeric_limits<double>::infinity();
+        for (const Image& down : downs) {
+            const AttackMetrics m = reconstruction_metrics(img, down, ResizeMethod::Bilinear,
+                                                           Backend::Sequential, 1, row_step);
+            r.psnr_db.push_back(m.psnr);
+            r.score_db = std::min(r.score_db, m.psnr);
+        }
+    };
+
+    // Coarse pass: clearly benign images stop here.
+    if (spec.coarse_row_step > 1 && img.height > spec.coarse_row_step) {
+        pass(spec.coarse_row_step);
+        if (r.score_db >= spec.threshold_db + spec.coarse_margin_db) {
+            r.verdict = r.spectral_flag ? DetectVerdict::Attack : DetectVerdict::Benign;
+            return r;
+        }
+    }
+
+    pass(1);
+    r.full_pass = true;
+    r.psnr_flag = r.score_db < spec.threshold_db;
+    r.verdict = (r.psnr_flag || r.spectral_flag) ? DetectVerdict::Attack : DetectVerdict::Benign;
+    return r;
+}
+
+DetectReport run_detect(const DetectSpec& spec, std::ostream& log) {
+    if (spec.target_w <= 0 || spec.target_h <= 0) throw std::invalid_argument("detect: target size must be > 0");
+    if (spec.methods.empty()) throw std::invalid_argument("detect: no methods to screen");
+
+    const std::vector<std::string> paths = detect_list_files(spec.input_dir, spec.recursive);
+
+    DetectReport rep;
+    rep.files.resize(paths.size());
+
+    int team = 1;
+#if HAVE_OPENMP
+    if (spec.threads > 0) omp_set_num_threads(spec.threads);
+    team = omp_get_max_threads();
+#endif
+    log << "Screening " << paths.size() << " files in " << spec.input_dir << " for scaling attacks (target "
+        << spec.target_w << "x" << spec.target_h << ", " << team << " threads, "
+        << (spec.use_spectral ? "PSNR + spectral" : "PSNR only") << ")\n";
+
+    const double t0 = now_ms();
+    const long long n = static_cast<long long>(paths.size());
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (long long i = 0; i < n; ++i) {
+        DetectResult& r = rep.files[static_cast<size_t>(i)];
+        const std::string& path = paths[static_cast<size_t>(i)];
+        try {
+            const double d0 = now_ms();
+            const Image img = load_image(path, 0);
+            const double d1 = now_ms();
+            r = detect_image(img, spec);
+            r.decode_ms = d1 - d0;
+            r.analyze_ms = now_ms() - d1;
+        } catch (const std::exception& e) {
+            r.verdict = DetectVerdict::Error;
+            r.error = e.what();
+        }
+        r.path = path;
+    }
+    rep.wall_ms = now_ms() - t0;
+
+    for (const DetectResult& r : rep.files) {
+        switch (r.verdict) {
+            case DetectVerdict::Benign: rep.benign++;  break;
+            case DetectVerdict::Attack: rep.attacks++; break;
+            case DetectVerdict::Error:  rep.errors++;  break;
+        }
+        if (r.verdict != DetectVerdict::Error && !r.full_pass) rep.early_exits++;
+        if (r.verdict == DetectVerdict::Attack && !r.psnr_flag) rep.spectral_only++;
+    }
+    return rep;
+}
+
+double DetectReport::images_per_sec() const {
+    return (wall_ms > 0.0) ? static_cast<double>(files.size()) * 1000.0 / wall_ms : 0.0;
+}
+
+void write_detect_results(const DetectReport& rep, const DetectSpec& spec, const std::string& path) {
+    using I = std::int64_t;
+    std::vector<std::string> columns = {"path", "width", "height", "channels", "verdict", "flagged_by", "score_db", "pass"};
+    for (ResizeMethod m : spec.methods) columns.push_back(std::string("psnr_") + method_name(m));
+    for (const char* c : {"spectral_db", "spectral_peaks", "decode_ms", "analyze_ms", "error"}) columns.emplace_back(c);
+
+    ResultWriter writer(path, columns);
+    writer.set_parameter("target_w", static_cast<I>(spec.target_w));
+    writer.set_parameter("target_h", static_cast<I>(spec.target_h));
+    writer.set_parameter("threshold_db", spec.threshold_db);
+    writer.set_parameter("coarse_margin_db", spec.coarse_margin_db);
+    writer.set_parameter("coarse_row_step", static_cast<I>(spec.coarse_row_step));
+    writer.set_parameter("spectral", static_cast<I>(spec.use_spectral ? 1 : 0));
+    writer.set_parameter("spectral_threshold_db", spec.spectral.threshold_db);
+    writer.set_parameter("spectral_tile", static_cast<I>(spec.spectral.tile));
+    writer.set_parameter("spectral_tiles", static_cast<I>(spec.spectral.max_tiles));
+    writer.set_parameter("images_per_sec", rep.images_per_sec());
+
+    for (const DetectResult& r : rep.files) {
+        std::vector<ResultValue> row = {
+            r.path, static_cast<I>(r.width), static_cast<I>(r.height), static_cast<I>(r.channels),
+            std::string(detect_verdict_name(r.verdict)), std::string(flagged_by(r)), r.score_db,
+            std::string(r.verdict == DetectVerdict::Error ? "" : (r.full_pass ? "full" : "coarse"))
+        };
+        for (size_t m = 0; m < spec.methods.size(); ++m) {
+            row.emplace_back((m < r.psnr_db.size()) ? r.psnr_db[m] : 0.0);
+        }
+        row.insert(row.end(), {r.spectral.score_db, static_cast<I>(r.spectral.peaks), r.decode_ms, r.analyze_ms, r.error});
+        writer.add_row(std::move(row));
+    }
+    writer.flush();
+}
+
+void print_detect_summary(const DetectReport& rep, const DetectSpec& spec, std::ostream& os) {
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+
+    if (rep.attacks > 0 || rep.errors > 0) {
+        os << "\nFLAGGED FILES (reconstruction PSNR below " << spec.threshold_db << " dB";
+        if (spec.use_spectral) os << " or spectral score at least " << spec.spectral.threshold_db << " dB";
+        os << ") and errors\n";
+        for (const DetectResult& r : rep.files) {
+            if (r.verdict == DetectVerdict::Benign) continue;
+            os << "  " << std::setw(6) << detect_verdict_name(r.verdict) << "  ";
+            if (r.verdict == DetectVerdict::Attack) {
+                os << std::fixed << std::setprecision(2) << std::setw(7) << r.score_db << " dB  ";
+                if (spec.use_spectral) os << std::setw(6) << r.spectral.score_db << " dB  ";
+                os << std::setw(13) << std::left << flagged_by(r) << "  ";
+                os.flags(flags);
+            }
+            os << r.path;
+            if (!r.error.empty()) os << "  (" << r.error << ")";
+            os << "\n";
+        }
+    }
+
+    const double analyze_total = [&] {
+        double s = 0.0;
+        for (const DetectResult& r : rep.files) s += r.analyze_ms;
+        return s;
+    }();
+    const double decode_total = [&] {
+        double s = 0.0;
+        for (const DetectResult& r : rep.files) s += r.decode_ms;
+        return s;
+    }();
+
+    os << "\nDETECT SUMMARY\n"
+       << "  files        = " << rep.files.size() << "\n"
+       << "  benign       = " << rep.benign << "\n"
+       << "  attack       = " << rep.attacks << " (" << rep.spectral_only << " only by the spectral detector)\n"
+       << "  errors       = " << rep.errors << "\n"
+       << "  coarse only  = " << rep.early_exits << " (files decided without the full PSNR pass)\n"
+       << std::fixed << std::setprecision(1)
+       << "  wall_ms      = " << rep.wall_ms << "\n"
+       << "  decode_ms    = " << decode_total << " (summed over threads)\n"
+       << "  analyze_ms   = " << analyze_total << " (summed over threads)\n"
+       << "  images/sec   = " << rep.images_per_sec() << "\n";
+    os.flags(flags);
+    os.precision(prec);
+}
+
+const char* detect_verdict_name(DetectVerdict v) {
+    switch (v) {
+        case DetectVerdict::Benign: return "benign";
+        case DetectVerdict::Attack: return "attack";
+        case DetectVerdict::Error:  return "error";
+    }
+    return "unknown";
+}
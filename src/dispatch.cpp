@@ -0,0 +1,166 @@
+// dispatch.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the kernel level selection. CMake defines
+// RESIZER_HAVE_ISA_V2/V3/V4 for the levels it built src/kernels_isa.cpp for.
+#include "dispatch.hpp"
+
+#include "util.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#ifndef RESIZER_HAVE_ISA_V2
+  #define RESIZER_HAVE_ISA_V2 0
+#endif
+#ifndef RESIZER_HAVE_ISA_V3
+  #define RESIZER_HAVE_ISA_V3 0
+#endif
+#ifndef RESIZER_HAVE_ISA_V4
+  #define RESIZER_HAVE_ISA_V4 0
+#endif
+
+namespace {
+
+// Level names are understood by __builtin_cpu_supports from GCC 12; elsewhere
+// the defining features of each level are checked one by one.
+bool cpu_supports(IsaLevel level) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+  #if !defined(__clang__) && __GNUC__ >= 12
+    switch (level) {
+        case IsaLevel::Baseline: return true;
+        case IsaLevel::V2: return __builtin_cpu_supports("x86-64-v2");
+        case IsaLevel::V3: return __builtin_cpu_supports("x86-64-v3");
+        case IsaLevel::V4: return __builtin_cpu_supports("x86-64-v4");
+    }
+  #else
+    switch (level) {
+        case IsaLevel::Baseline: return true;
+        case IsaLevel::V2:
+            return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1")
+                && __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        case IsaLevel::V3:
+            return cpu_supports(IsaLevel::V2) && __builtin_cpu_supports("avx2")
+                && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2");
+        case IsaLevel::V4:
+            return cpu_supports(IsaLevel::V3) && __builtin_cpu_supports("avx512f")
+                && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512cd")
+                && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+    }
+  #endif
+    return false;
+#else
+    return level == IsaLevel::Baseline;
+#endif
+}
+
+const KernelTable* compiled_table(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::Baseline: return &kernel_table_baseline();
+#if RESIZER_HAVE_ISA_V2
+        case IsaLevel::V2: return &kernel_table_v2();
+#endif
+#if RESIZER_HAVE_ISA_V3
+        case IsaLevel::V3: return &kernel_table_v3();
+#endif
+#if RESIZER_HAVE_ISA_V4
+        case IsaLevel::V4: return &kernel_table_v4();
+#endif
+        default: return nullptr;
+    }
+}
+
+const KernelTable& detected_table() {
+    static const KernelTable& table = *kernel_table(detected_isa_level());
+    return table;
+}
+
+// RESIZER_ISA is read once, on the first kernel call; a bad value falls back
+// to detection (a kernel call is no place to throw).
+const KernelTable& initial_table() {
+    static const KernelTable& table = []() -> const KernelTable& {
+        const char* env = std::getenv("RESIZER_ISA");
+        if (env == nullptr || *env == '\0' || to_lower(env) == "auto") return detected_table();
+        try {
+            const KernelTable* t = kernel_table(parse_isa_level(env));
+            if (t != nullptr) return *t;
+            std::cerr << "Warning: RESIZER_ISA=" << env << " is not available here, using "
+                      << isa_level_name(detected_isa_level()) << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: ignoring RESIZER_ISA: " << e.what() << "\n";
+        }
+        return detected_table();
+    }();
+    return table;
+}
+
+std::atomic<const KernelTable*> forced_table{nullptr};
+
+} // namespace
+
+const KernelTable& active_kernels() {
+    const KernelTable* forced = forced_table.load(std::memory_order_acquire);
+    return (forced != nullptr) ? *forced : initial_table();
+}
+
+const KernelTable* kernel_table(IsaLevel level) {
+    return cpu_supports(level) ? compiled_table(level) : nullptr;
+}
+
+void force_isa_level(IsaLevel level) {
+    const KernelTable* t = compiled_table(level);
+    if (t == nullptr) {
+        throw std::runtime_error(std::string("ISA level ") + isa_level_name(level) + " is not compiled into this build");
+    }
+    if (!cpu_supports(level)) {
+        throw std::runtime_error(std::string("ISA level ") + isa_level_name(level) + " is not supported by this CPU");
+    }
+    forced_table.store(t, std::memory_order_release);
+}
+
+void reset_isa_level() {
+    forced_table.store(&detected_table(), std::memory_order_release);
+}
+
+IsaLevel detected_isa_level() {
+    IsaLevel best = IsaLevel::Baseline;
+    for (IsaLevel l : compiled_isa_levels()) {
+        if (cpu_supports(l)) best = l;
+    }
+    return best;
+}
+
+std::vector<IsaLevel> compiled_isa_levels() {
+    std::vector<IsaLevel> levels;
+    for (IsaLevel l : {IsaLevel::Baseline, IsaLevel::V2, IsaLevel::V3, IsaLevel::V4}) {
+        if (compiled_table(l) != nullptr) levels.push_back(l);
+    }
+    return levels;
+}
+
+const char* isa_level_name(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::Baseline: return "x86-64";
+        case IsaLevel::V2: return "x86-64-v2";
+        case IsaLevel::V3: return "x86-64-v3";
+        case IsaLevel::V4: return "x86-64-v4";
+    }
+    return "unknown";
+}
+
+IsaLevel parse_isa_level(const std::string& s) {
+    const std::string v = to_lower(s);
+    if (v == "baseline" || v == "x86-64" || v == "v1") return IsaLevel::Baseline;
+    if (v == "v2" || v == "x86-64-v2") return IsaLevel::V2;
+    if (v == "v3" || v == "x86-64-v3") return IsaLevel::V3;
+    if (v == "v4" || v == "x86-64-v4") return IsaLevel::V4;
+    throw std::invalid_argument("Unknown ISA level: " + s + " (use baseline, v2, v3, v4 or auto)");
+}
+
+void apply_isa_option(const std::string& s) {
+    if (to_lower(s) == "auto") reset_isa_level();
+    else force_isa_level(parse_isa_level(s));
+}
@@ -0,0 +1,258 @@
+// fft.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the batched mixed-radix FFT and the real 2D transform.
+#include "fft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
+
+// Sequences per block: blocks are transformed in a thread-local buffer small
+// enough to stay in L2 while all stages run on it.
+constexpr int block_columns = 16;
+
+// Radix order: 4 first (fewest passes over the data), then the small primes.
+std::vector<int> factorize(int n) {
+    std::vector<int> f;
+    while (n % 4 == 0) { f.push_back(4); n /= 4; }
+    for (int p : {2, 3, 5}) {
+        while (n % p == 0) { f.push_back(p); n /= p; }
+    }
+    for (int p = 7; n > 1; p += 2) {
+        while (n % p == 0) { f.push_back(p); n /= p; }
+    }
+    return f;
+}
+
+} // namespace
+
+FftPlan::FftPlan(int n) : n_(n) {
+    if (n < 1) throw std::invalid_argument("FftPlan: length must be >= 1");
+
+    int len = n;  // length of the sub-transforms entering the stage
+    int s = 1;
+    for (int r : factorize(n)) {
+        Stage st;
+        st.radix = r;
+        st.m = len / r;
+        st.stride = s;
+        st.tw = tw_re_.size();
+        // wp^j = e^{-2 pi i p j / len}, j = 1..r-1, for every butterfly p
+        for (int p = 0; p < st.m; ++p) {
+            for (int j = 1; j < r; ++j) {
+                const double a = -2.0 * std::numbers::pi * static_cast<double>(p * j) / static_cast<double>(len);
+                tw_re_.push_back(static_cast<float>(std::cos(a)));
+                tw_im_.push_back(static_cast<float>(std::sin(a)));
+            }
+        }
+        stages_.push_back(st);
+        len = st.m;
+        s *= r;
+    }
+}
+
+// Transforms cw sequences of a block. x holds the input (n rows of cw values),
+// y is scratch of the same size; the result is copied back to re/im.
+void FftPlan::run_block(float* re, float* im, int count, int cw,
+                        float* xr, float* xi, float* yr, float* yi) const {
+    const std::size_t row = static_cast<std::size_t>(cw);
+    for (int j = 0; j < n_; ++j) {
+        std::memcpy(xr + j * row, re + static_cast<std::size_t>(j) * count, row * sizeof(float));
+        std::memcpy(xi + j * row, im + static_cast<std::size_t>(j) * count, row * sizeof(float));
+    }
+
+    for (const Stage& st : stages_) {
+        const int r = st.radix;
+        const int m = st.m;
+        const int s = st.stride;
+        for (int p = 0; p < m; ++p) {
+            const float* wr = tw_re_.data() + st.tw + static_cast<std::size_t>(p) * (r - 1);
+            const float* wi = tw_im_.data() + st.tw + static_cast<std::size_t>(p) * (r - 1);
+            for (int q = 0; q < s; ++q) {
+                // inputs x[q + s * (p + k * m)], outputs y[q + s * (r * p + j)]
+                auto in = [&](int k) { return static_cast<std::size_t>(q + s * (p + k * m)) * row; };
+                auto out = [&](int j) { return static_cast<std::size_t>(q + s * (r * p + j)) * row; };
+
+                if (r == 4) {
+                    const float* a0r = xr + in(0); const float* a0i = xi + in(0);
+                    const float* a1r = xr + in(1); const float* a1i = xi + in(1);
+                    const float* a2r = xr + in(2); const float* a2i = xi + in(2);
+                    const float* a3r = xr + in(3); const float* a3i = xi + in(3);
+                    float* y0r = yr + out(0); float* y0i = yi + out(0);
+                    float* y1r = yr + out(1); float* y1i = yi + out(1);
+                    float* y2r = yr + out(2); float* y2i = yi + out(2);
+                    float* y3r = yr + out(3); float* y3i = yi + out(3);
+                    const float w1r = wr[0], w1i = wi[0], w2r = wr[1], w2i = wi[1], w3r = wr[2], w3i = wi[2];
+                    for (int b = 0; b < cw; ++b) {
+                        const float t0r = a0r[b] + a2r[b], t0i = a0i[b] + a2i[b];
+                        const float t1r = a0r[b] - a2r[b], t1i = a0i[b] - a2i[b];
+                        const float t2r = a1r[b] + a3r[b], t2i = a1i[b] + a3i[b];
+                        const float t3r = a1i[b] - a3i[b], t3i = a3r[b] - a1r[b]; // (a1 - a3) * -i
+                        const float u1r = t1r + t3r, u1i = t1i + t3i;
+                        const float u2r = t0r - t2r, u2i = t0i - t2i;
+                        const float u3r = t1r - t3r, u3i = t1i - t3i;
+                        y0r[b] = t0r + t2r;
+                        y0i[b] = t0i + t2i;
+                        y1r[b] = u1r * w1r - u1i * w1i;
+                        y1i[b] = u1r * w1i + u1i * w1r;
+                        y2r[b] = u2r * w2r - u2i * w2i;
+                        y2i[b] = u2r * w2i + u2i * w2r;
+                        y3r[b] = u3r * w3r - u3i * w3i;
+                        y3i[b] = u3r * w3i + u3i * w3r;
+                    }
+                } else if (r == 2) {
+                    const float* a0r = xr + in(0); const float* a0i = xi + in(0);
+                    const float* a1r = xr + in(1); const float* a1i = xi + in(1);
+                    float* y0r = yr + out(0); float* y0i = yi + out(0);
+                    float* y1r = yr + out(1); float* y1i = yi + out(1);
+                    const float w1r = wr[0], w1i = wi[0];
+                    for (int b = 0; b < cw; ++b) {
+                        const float dr = a0r[b] - a1r[b], di = a0i[b] - a1i[b];
+                        y0r[b] = a0r[b] + a1r[b];
+                        y0i[b] = a0i[b] + a1i[b];
+                        y1r[b] = dr * w1r - di * w1i;
+                        y1i[b] = dr * w1i + di * w1r;
+                    }
+                } else {
+                    // Generic radix: direct r-point DFT, accumulated one input at a time.
+                    for (int j = 0; j < r; ++j) {
+                        float* ojr = yr + out(j);
+                        float* oji = yi + out(j);
+                        std::fill(ojr, ojr + cw, 0.0f);
+                        std::fill(oji, oji + cw, 0.0f);
+                        for (int k = 0; k < r; ++k) {
+                            const double a = -2.0 * std::numbers::pi * static_cast<double>((j * k) % r) / r;
+                            const float cr = static_cast<float>(std::cos(a));
+                            const float ci = static_cast<float>(std::sin(a));
+                            const float* akr = xr + in(k);
+                            const float* aki = xi + in(k);
+                            for (int b = 0; b < cw; ++b) {
+                                ojr[b] += akr[b] * cr - aki[b] * ci;
+                                oji[b] += akr[b] * ci + aki[b] * cr;
+                            }
+                        }
+                        if (j == 0) continue;
+                        const float w1r = wr[j - 1], w1i = wi[j - 1];
+                        for (int b = 0; b < cw; ++b) {
+                            const float vr = ojr[b], vi = oji[b];
+                            ojr[b] = vr * w1r - vi * w1i;
+                            oji[b] = vr * w1i + vi * w1r;
+                        }
+                    }
+                }
+            }
+        }
+        std::swap(xr, yr);
+        std::swap(xi, yi);
+    }
+
+    for (int j = 0; j < n_; ++j) {
+        std::memcpy(re + static_cast<std::size_t>(j) * count, xr + j * row, row * sizeof(float));
+        std::memcpy(im + static_cast<std::size_t>(j) * count, xi + j * row, row * sizeof(float));
+    }
+}
+
+void FftPlan::forward_batch(float* re, float* im, int count, int threads) const {
+    if (count <= 0 || stages_.empty()) return; // n == 1: identity
+    const int blocks = (count + block_columns - 1) / block_columns;
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel if(blocks > 1)
+#else
+    (void)threads;
+#endif
+    {
+        const std::size_t buf = static_cast<std::size_t>(n_) * block_columns;
+        std::vector<float> scratch(4 * buf);
+#if HAVE_OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int blk = 0; blk < blocks; ++blk) {
+            const int b0 = blk * block_columns;
+            const int cw = std::min(block_columns, count - b0);
+            run_block(re + b0, im + b0, count, cw,
+                      scratch.data(), scratch.data() + buf, scratch.data() + 2 * buf, scratch.data() + 3 * buf);
+        }
+    }
+}
+
+std::complex<float> HalfSpectrum::at(int k, int l) const {
+    k = ((k % height) + height) % height;
+    l = ((l % width) + width) % width;
+    if (k < rows) {
+        const std::size_t i = static_cast<std::size_t>(l) * rows + static_cast<std::size_t>(k);
+        return {re[i], im[i]};
+    }
+    const int kk = height - k;
+    const int ll = (width - l) % width;
+    const std::size_t i = static_cast<std::size_t>(ll) * rows + static_cast<std::size_t>(kk);
+    return {re[i], -im[i]};
+}
+
+HalfSpectrum real_fft2d(const float* data, int w, int h, int threads) {
+    if (w < 1 || h < 1) throw std::invalid_argument("real_fft2d: size must be > 0");
+
+    HalfSpectrum out;
+    out.width = w;
+    out.height = h;
+    out.rows = h / 2 + 1;
+    const int rows = out.rows;
+
+    // Column pass: complex sequence b = column 2b + i * column 2b+1.
+    const int pairs = (w + 1) / 2;
+    std::vector<float> zr(static_cast<std::size_t>(h) * pairs);
+    std::vector<float> zi(static_cast<std::size_t>(h) * pairs, 0.0f);
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < h; ++y) {
+        const float* src = data + static_cast<std::size_t>(y) * w;
+        float* dr = zr.data() + static_cast<std::size_t>(y) * pairs;
+        float* di = zi.data() + static_cast<std::size_t>(y) * pairs;
+        for (int b = 0; b < w / 2; ++b) {
+            dr[b] = src[2 * b];
+            di[b] = src[2 * b + 1];
+        }
+        if (w % 2 != 0) dr[pairs - 1] = src[w - 1];
+    }
+    FftPlan(h).forward_batch(zr.data(), zi.data(), pairs, threads);
+
+    // Unpack the two real columns of every pair straight into the transposed
+    // layout of the row pass (sequence k, element l).
+    out.re.resize(static_cast<std::size_t>(w) * rows);
+    out.im.resize(static_cast<std::size_t>(w) * rows);
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int b = 0; b < pairs; ++b) {
+        for (int k = 0; k < rows; ++k) {
+            const std::size_t i = static_cast<std::size_t>(k) * pairs + b;
+            const std::size_t c = static_cast<std::size_t>((h - k) % h) * pairs + b;
+            const float ar = zr[i], ai = zi[i], br = zr[c], bi = zi[c];
+            // even column: (Z[k] + conj Z[-k]) / 2; odd column: (Z[k] - conj Z[-k]) / 2i
+            const std::size_t e = static_cast<std::size_t>(2 * b) * rows + k;
+            out.re[e] = 0.5f * (ar + br);
+            out.im[e] = 0.5f * (ai - bi);
+            if (2 * b + 1 < w) {
+                const std::size_t o = e + static_cast<std::size_t>(rows);
+                out.re[o] = 0.5f * (ai + bi);
+                out.im[o] = -0.5f * (ar - br);
+            }
+        }
+    }
+
+    FftPlan(w).forward_batch(out.re.data(), out.im.data(), rows, threads);
+    return out;
+}
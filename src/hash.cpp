@@ -0,0 +1,217 @@
+// hash.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the image content hash.
+#include "hash.hpp"
+
+#include "kernels.hpp"
+#include "trace.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
+
+constexpr std::size_t stripes_per_block = 16;
+constexpr std::size_t block_bytes = stripes_per_block * hash_stripe_bytes;
+constexpr std::size_t chunk_bytes = std::size_t{1} << 20; // a multiple of block_bytes
+
+constexpr std::uint64_t prime32_1 = 0x9E3779B1u;
+constexpr std::uint64_t prime32_2 = 0x85EBCA77u;
+constexpr std::uint64_t prime32_3 = 0xC2B2AE3Du;
+constexpr std::uint64_t prime64_1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t prime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t prime64_3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t prime64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t prime64_5 = 0x27D4EB2F165667C5ull;
+
+// Key material: stripe keys (block stripes + 7), scramble keys, two sets of finalization keys.
+constexpr std::size_t stripe_keys = stripes_per_block + hash_lanes - 1;
+constexpr std::size_t scramble_at = stripe_keys;
+constexpr std::size_t final_lo_at = scramble_at + hash_lanes;
+constexpr std::size_t final_hi_at = final_lo_at + hash_lanes;
+constexpr std::size_t secret_size = final_hi_at + hash_lanes;
+
+constexpr std::array<std::uint64_t, secret_size> make_secret() {
+    std::array<std::uint64_t, secret_size> s{};
+    std::uint64_t x = prime64_3;
+    for (std::uint64_t& v : s) { // splitmix64
+        x += 0x9E3779B97F4A7C15ull;
+        std::uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        v = z ^ (z >> 31);
+    }
+    return s;
+}
+
+constexpr std::array<std::uint64_t, secret_size> secret = make_secret();
+
+std::uint64_t mul_fold64(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using u128 = unsigned __int128;
+    const u128 p = static_cast<u128>(a) * b;
+    return static_cast<std::uint64_t>(p) ^ static_cast<std::uint64_t>(p >> 64);
+#else
+    const std::uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    const std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    const std::uint64_t cross = (ll >> 32) + (hl & 0xFFFFFFFFu) + lh;
+    const std::uint64_t lo = (cross << 32) | (ll & 0xFFFFFFFFu);
+    const std::uint64_t hi = hh + (hl >> 32) + (cross >> 32);
+    return lo ^ hi;
+#endif
+}
+
+std::uint64_t avalanche(std::uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    return h ^ (h >> 32);
+}
+
+std::uint64_t merge(const std::uint64_t* acc, const std::uint64_t* keys, std::uint64_t start) {
+    std::uint64_t h = start;
+    for (int i = 0; i < hash_lanes; i += 2) h += mul_fold64(acc[i] ^ keys[i], acc[i + 1] ^ keys[i + 1]);
+    return avalanche(h);
+}
+
+std::uint64_t shape_seed(const Image& img) {
+    return avalanche((static_cast<std::uint64_t>(img.width) << 32) ^ (static_cast<std::uint64_t>(img.height) << 3)
+                     ^ static_cast<std::uint64_t>(img.channels));
+}
+
+} // namespace
+
+ContentHash hash_bytes(const std::uint8_t* data, std::size_t n, std::uint64_t seed) {
+    std::array<std::uint64_t, secret_size> keys;
+    for (std::size_t i = 0; i < secret_size; ++i) keys[i] = secret[i] + ((i & 1) ? 0 - seed : seed);
+
+    std::uint64_t acc[hash_lanes] = {prime32_3, prime64_1, prime64_2, prime64_3,
+                                     prime64_4, prime32_2, prime64_5, prime32_1};
+    const std::size_t blocks = n / block_bytes;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        hash_accumulate(acc, data + b * block_bytes, stripes_per_block, keys.data());
+        hash_scramble(acc, keys.data() + scramble_at);
+    }
+    const std::size_t rest = n - blocks * block_bytes;
+    const std::uint8_t* tail = data + blocks * block_bytes;
+    hash_accumulate(acc, tail, rest / hash_stripe_bytes, keys.data());
+    if (rest % hash_stripe_bytes != 0) {
+        // Zero-padded last stripe on its own key offset; the length in the
+        // finalization tells padding from real zeros.
+        std::uint8_t last[hash_stripe_bytes] = {};
+        std::memcpy(last, tail + rest / hash_stripe_bytes * hash_stripe_bytes, rest % hash_stripe_bytes);
+        hash_accumulate(acc, last, 1, keys.data() + (stripe_keys - hash_lanes));
+    }
+
+    ContentHash h;
+    h.lo = merge(acc, keys.data() + final_lo_at, static_cast<std::uint64_t>(n) * prime64_1);
+    h.hi = merge(acc, keys.data() + final_hi_at, ~(static_cast<std::uint64_t>(n) * prime64_2));
+    return h;
+}
+
+ContentHash hash_image(const Image& img, int threads) {
+    TRACE_SCOPE_ARGS("hash_image", trace_cat::io, "width", img.width, "height", img.height);
+
+    const std::uint64_t seed = shape_seed(img);
+    const std::size_t n = img.data.size();
+    if (n <= chunk_bytes) return hash_bytes(img.data.data(), n, seed);
+
+    const std::size_t chunks = (n + chunk_bytes - 1) / chunk_bytes;
+    std::vector<std::uint64_t> digests(2 * chunks);
+    const long long count = static_cast<long long>(chunks);
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel for schedule(static)
+#else
+    (void)threads;
+#endif
+    for (long long k = 0; k < count; ++k) {
+        const std::size_t begin = static_cast<std::size_t>(k) * chunk_bytes;
+        const std::size_t len = std::min(chunk_bytes, n - begin);
+        const ContentHash c = hash_bytes(img.data.data() + begin, len, seed + static_cast<std::uint64_t>(k));
+        digests[2 * static_cast<std::size_t>(k)] = c.hi;
+        digests[2 * static_cast<std::size_t>(k) + 1] = c.lo;
+    }
+    return hash_bytes(reinterpret_cast<const std::uint8_t*>(digests.data()), digests.size() * sizeof(std::uint64_t),
+                      seed ^ static_cast<std::uint64_t>(n));
+}
+
+std::string ContentHash::hex() const {
+    char buf[33];
+    std::snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi),
+                  static_cast<unsigned long long>(lo));
+    return buf;
+}
+
+ContentHash parse_content_hash(const std::string& s) {
+    if (s.size() != 32) throw std::invalid_argument("Invalid content hash (expected 32 hex digits): " + s);
+    auto part = [&](std::size_t pos) {
+        std::uint64_t v = 0;
+        for (std::size_t i = pos; i < pos + 16; ++i) {
+            const char c = s[i];
+            int d;
+            if (c >= '0' && c <= '9') d = c - '0';
+            else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+            else throw std::invalid_argument("Invalid content hash (expected 32 hex digits): " + s);
+            v = (v << 4) | static_cast<std::uint64_t>(d);
+        }
+        return v;
+    };
+    return {part(0), part(16)};
+}
+
+std::vector<std::string> hash_manifest_columns() {
+    return {"path", "width", "height", "channels", "hash"};
+}
+
+std::vector<ResultValue> hash_manifest_row(const std::string& path, const Image& img, const ContentHash& hash) {
+    using I = std::int64_t;
+    return {path, static_cast<I>(img.width), static_cast<I>(img.height), static_cast<I>(img.channels), hash.hex()};
+}
+
+void record_hash_manifest(const std::string& manifest_path, const std::string& path, const Image& img,
+                          const ContentHash& hash) {
+    ResultWriter writer(manifest_path, hash_manifest_columns());
+    if (writer.is_json() && std::filesystem::exists(manifest_path)) {
+        using I = std::int64_t;
+        for (const auto& [p, e] : read_hash_manifest(manifest_path)) {
+            if (p == path) continue;
+            writer.add_row({e.path, static_cast<I>(e.width), static_cast<I>(e.height), static_cast<I>(e.channels),
+                            e.hash.hex()});
+        }
+    }
+    writer.add_row(hash_manifest_row(path, img, hash));
+    writer.flush();
+}
+
+std::map<std::string, ManifestEntry> read_hash_manifest(const std::string& path) {
+    const ResultTable t = read_result_table(path);
+    const int cp = t.column("path"), cw = t.column("width"), ch = t.column("height");
+    const int cc = t.column("channels"), chash = t.column("hash");
+    if (cp < 0 || cw < 0 || ch < 0 || cc < 0 || chash < 0) {
+        throw std::invalid_argument("Not a hash manifest (needs path, width, height, channels, hash): " + path);
+    }
+
+    std::map<std::string, ManifestEntry> entries;
+    for (const std::vector<std::string>& row : t.rows) {
+        ManifestEntry e;
+        e.path = row[static_cast<std::size_t>(cp)];
+        e.width = std::stoi(row[static_cast<std::size_t>(cw)]);
+        e.height = std::stoi(row[static_cast<std::size_t>(ch)]);
+        e.channels = std::stoi(row[static_cast<std::size_t>(cc)]);
+        e.hash = parse_content_hash(row[static_cast<std::size_t>(chash)]);
+        entries[e.path] = e;
+    }
+    return entries;
+}
+
@@ -4,7 +4,12 @@
 // stb-based image loading/saving implementation.
 // Reads common image formats and writes PNG/JPG. JPG output drops alpha if present.
 #include "io.hpp"
+#include "kernels.hpp"
+#include "synthetic.hpp"
+#include "trace.hpp"
 
+#include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <sstream>
 #include <vector>
@@ -24,15 +29,44 @@ static void validate_channels(int c) {
     }
 }
 
-Image load_image(const std::string& path, int requested_channels) {
+std::vector<std::uint8_t> read_file(const std::string& path) {
+    TRACE_SCOPE("read", trace_cat::io);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Failed to open file: " + path);
+
+    const std::streamsize size = in.tellg();
+    if (size < 0) throw std::runtime_error("Failed to read file: " + path);
+    std::vector<std::uint8_t> bytes(static_cast<size_t>(size));
+    in.seekg(0, std::ios::beg);
+    if (size > 0 && !in.read(reinterpret_cast<char*>(bytes.data()), size)) {
+        throw std::runtime_error("Failed to read file: " + path);
+    }
+    return bytes;
+}
+
+void write_file(const std::string& path, const std::vector<std::uint8_t>& bytes) {
+    TRACE_SCOPE("write", trace_cat::io);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Failed to open file for writing: " + path);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!out) throw std::runtime_error("Failed to write file: " + path);
+}
+
+Image decode_image(const std::vector<std::uint8_t>& bytes, int requested_channels, const std::string& name) {
+    TRACE_SCOPE("decode", trace_cat::io);
     if (requested_channels != 0) validate_channels(requested_channels);
+    if (bytes.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("Failed to load image: " + name + " (file too large)");
+    }
+    const auto* buf = reinterpret_cast<const stbi_uc*>(bytes.data());
+    const int len = static_cast<int>(bytes.size());
 
     int w = 0, h = 0, c = 0;
-    stbi_uc* pixels = stbi_load(path.c_str(), &w, &h, &c, requested_channels);
+    stbi_uc* pixels = stbi_load_from_memory(buf, len, &w, &h, &c, requested_channels);
 
     if (!pixels) {
         std::ostringstream oss;
-        oss << "Failed to load image: " << path << " (stb: " << stbi_failure_reason() << ")";
+        oss << "Failed to load image: " << name << " (stb: " << stbi_failure_reason() << ")";
         throw std::runtime_error(oss.str());
     }
 
@@ -41,10 +75,10 @@ Image load_image(const std::string& path, int requested_channels) {
     // Normalize unsupported channel counts (e.g., 2) to RGB
     if (out_c != 1 && out_c != 3 && out_c != 4) {
         stbi_image_free(pixels);
-        pixels = stbi_load(path.c_str(), &w, &h, &c, 3);
+        pixels = stbi_load_from_memory(buf, len, &w, &h, &c, 3);
         if (!pixels) {
             std::ostringstream oss;
-            oss << "Failed to reload image as RGB: " << path << " (stb: " << stbi_failure_reason() << ")";
+            oss << "Failed to reload image as RGB: " << name << " (stb: " << stbi_failure_reason() << ")";
             throw std::runtime_error(oss.str());
         }
         out_c = 3;
@@ -58,8 +92,23 @@ Image load_image(const std::string& path, int requested_channels) {
     return img;
 }
 
-void save_png(const Image& img, const std::string& path, int compression_level) {
-    if (img.empty()) throw std::invalid_argument("save_png: image is empty");
+Image load_image(const std::string& path, int requested_channels) {
+    if (requested_channels != 0) validate_channels(requested_channels);
+    if (is_synthetic_spec(path)) return load_synthetic(path, requested_channels);
+
+    return decode_image(read_file(path), requested_channels, path);
+}
+
+// stb write callback: append the encoded chunk to a std::vector<std::uint8_t>.
+static void append_to_vector(void* context, void* data, int size) {
+    auto* out = static_cast<std::vector<std::uint8_t>*>(context);
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    out->insert(out->end(), p, p + size);
+}
+
+std::vector<std::uint8_t> encode_png(const Image& img, int compression_level) {
+    if (img.empty()) throw std::invalid_argument("encode_png: image is empty");
+    TRACE_SCOPE("encode png", trace_cat::io);
     validate_channels(img.channels);
 
     if (compression_level < 0) compression_level = 0;
@@ -67,40 +116,48 @@ void save_png(const Image& img, const std::string& path, int compression_level)
 
     stbi_write_png_compression_level = compression_level;
 
+    std::vector<std::uint8_t> bytes;
     const int stride = img.width * img.channels;
-    const int ok = stbi_write_png(path.c_str(), img.width, img.height, img.channels,
-                                  img.data.data(), stride);
-    if (!ok) throw std::runtime_error("save_png: failed to write PNG: " + path);
+    const int ok = stbi_write_png_to_func(append_to_vector, &bytes, img.width, img.height, img.channels,
+                                          img.data.data(), stride);
+    if (!ok) throw std::runtime_error("encode_png: PNG encoding failed");
+    return bytes;
 }
 
-void save_jpg(const Image& img, const std::string& path, int quality) {
-    if (img.empty()) throw std::invalid_argument("save_jpg: image is empty");
+Image drop_alpha(const Image& img) {
+    if (img.channels != 4) throw std::invalid_argument("drop_alpha: image must have 4 channels");
+    TRACE_SCOPE("convert", trace_cat::io);
+
+    Image rgb(img.width, img.height, 3);
+    const size_t pixels = static_cast<size_t>(img.width) * static_cast<size_t>(img.height);
+    rgba_to_rgb_row(img.data.data(), rgb.data.data(), pixels);
+    return rgb;
+}
+
+std::vector<std::uint8_t> encode_jpg(const Image& img, int quality) {
+    if (img.empty()) throw std::invalid_argument("encode_jpg: image is empty");
+    TRACE_SCOPE("encode jpg", trace_cat::io);
     validate_channels(img.channels);
 
     if (quality < 1) quality = 1;
     if (quality > 100) quality = 100;
 
-    if (img.channels == 4) {
-        // Drop alpha channel for JPG output
-        std::vector<std::uint8_t> rgb;
-        rgb.resize(static_cast<size_t>(img.width) * static_cast<size_t>(img.height) * 3u);
+    // Drop alpha channel for JPG output
+    if (img.channels == 4) return encode_jpg(drop_alpha(img), quality);
 
-        const std::uint8_t* src = img.data.data();
-        std::uint8_t* dst = rgb.data();
-        const size_t pixels = static_cast<size_t>(img.width) * static_cast<size_t>(img.height);
-
-        for (size_t i = 0; i < pixels; ++i) {
-            dst[3*i + 0] = src[4*i + 0];
-            dst[3*i + 1] = src[4*i + 1];
-            dst[3*i + 2] = src[4*i + 2];
-        }
+    std::vector<std::uint8_t> bytes;
+    const int ok = stbi_write_jpg_to_func(append_to_vector, &bytes, img.width, img.height, img.channels,
+                                          img.data.data(), quality);
+    if (!ok) throw std::runtime_error("encode_jpg: JPG encoding failed");
+    return bytes;
+}
 
-        const int ok = stbi_write_jpg(path.c_str(), img.width, img.height, 3, rgb.data(), quality);
-        if (!ok) throw std::runtime_error("save_jpg: failed to write JPG: " + path);
-        return;
-    }
+void save_png(const Image& img, const std::string& path, int compression_level) {
+    if (img.empty()) throw std::invalid_argument("save_png: image is empty");
+    write_file(path, encode_png(img, compression_level));
+}
 
-    const int ok = stbi_write_jpg(path.c_str(), img.width, img.height, img.channels,
-                                  img.data.data(), quality);
-    if (!ok) throw std::runtime_error("save_jpg: failed to write JPG: " + path);
+void save_jpg(const Image& img, const std::string& path, int quality) {
+    if (img.empty()) throw std::invalid_argument("save_jpg: image is empty");
+    write_file(path, encode_jpg(img, quality));
 }
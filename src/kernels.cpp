@@ -0,0 +1,330 @@
+// kernels.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Scalar reference implementations of the row kernels; the comparison kernels
+// also have an SSE2 path (baseline on x86-64), as do the SSIM window passes and
+// the hash stripes. The resampling kernels are dispatched by x86-64 level.
+#include "kernels.hpp"
+
+#include "dispatch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
+ColumnMap make_column_map(int in_w, int out_w, ResizeMethod method) {
+    ColumnMap cm;
+    cm.x0.resize(static_cast<size_t>(out_w));
+    if (method == ResizeMethod::Bilinear) {
+        cm.x1.resize(static_cast<size_t>(out_w));
+        cm.wx.resize(static_cast<size_t>(out_w));
+    }
+
+    for (int x = 0; x < out_w; ++x) {
+        const float sx = map_coord(static_cast<float>(x), static_cast<float>(in_w), static_cast<float>(out_w));
+        if (method == ResizeMethod::Nearest) {
+            cm.x0[x] = clamp_int(static_cast<int>(std::lround(sx)), 0, in_w - 1);
+        } else {
+            const int x0 = clamp_int(static_cast<int>(std::floor(sx)), 0, in_w - 1);
+            cm.x0[x] = x0;
+            cm.x1[x] = clamp_int(x0 + 1, 0, in_w - 1);
+            cm.wx[x] = sx - static_cast<float>(x0);
+        }
+    }
+    return cm;
+}
+
+RowTap row_tap(int y, int in_h, int out_h, ResizeMethod method) {
+    const float sy = map_coord(static_cast<float>(y), static_cast<float>(in_h), static_cast<float>(out_h));
+    RowTap t;
+    if (method == ResizeMethod::Nearest) {
+        t.y0 = clamp_int(static_cast<int>(std::lround(sy)), 0, in_h - 1);
+        t.y1 = t.y0;
+    } else {
+        t.y0 = clamp_int(static_cast<int>(std::floor(sy)), 0, in_h - 1);
+        t.y1 = clamp_int(t.y0 + 1, 0, in_h - 1);
+        t.wy = sy - static_cast<float>(t.y0);
+    }
+    return t;
+}
+
+// The resampling kernels run the per-level builds of src/kernels_isa.cpp (see dispatch.hpp).
+void nearest_row(const std::uint8_t* src, std::uint8_t* dst, const ColumnMap& cm, int out_w, int channels) {
+    active_kernels().nearest_row(src, dst, cm.x0.data(), out_w, channels);
+}
+
+void bilinear_row(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst,
+                  const ColumnMap& cm, float wy, int out_w, int channels) {
+    active_kernels().bilinear_row(row0, row1, dst, cm.x0.data(), cm.x1.data(), cm.wx.data(), wy, out_w, channels);
+}
+
+void hpass_row(const std::uint8_t* src, float* dst, const ColumnMap& cm, int out_w, int channels) {
+    active_kernels().hpass_row(src, dst, cm.x0.data(), cm.x1.data(), cm.wx.data(), out_w, channels);
+}
+
+void vpass_row(const float* h0, const float* h1, std::uint8_t* dst, float wy, int n) {
+    active_kernels().vpass_row(h0, h1, dst, wy, n);
+}
+
+void rgba_to_rgb_row(const std::uint8_t* src, std::uint8_t* dst, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        dst[3*i + 0] = src[4*i + 0];
+        dst[3*i + 1] = src[4*i + 1];
+        dst[3*i + 2] = src[4*i + 2];
+    }
+}
+
+void compare_row(const std::uint8_t* a, const std::uint8_t* b, std::size_t n,
+                 int& max_abs, std::uint64_t& nonzero) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const int da = static_cast<int>(a[i]);
+        const int db = static_cast<int>(b[i]);
+        const int d = da - db;
+        const int ad = (d < 0) ? -d : d;
+        if (ad != 0) nonzero++;
+        if (ad > max_abs) max_abs = ad;
+    }
+}
+
+void absdiff_stats(const std::uint8_t* a, const std::uint8_t* b, std::size_t n,
+                   AbsDiffAccum& acc, std::uint64_t* hist) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmax = zero;
+    __m128i vsad = zero;
+    std::uint64_t nonzero = 0;
+    alignas(16) std::uint8_t d[16];
+
+    for (; i + 16 <= n; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i vd = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        vmax = _mm_max_epu8(vmax, vd);
+        vsad = _mm_add_epi64(vsad, _mm_sad_epu8(vd, zero));
+
+        const unsigned diff = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(vd, zero))) & 0xFFFFu;
+        if (diff == 0) continue;
+        nonzero += static_cast<std::uint64_t>(std::popcount(diff));
+        if (hist != nullptr) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(d), vd);
+            for (unsigned m = diff; m != 0; m &= m - 1) hist[d[std::countr_zero(m)]]++;
+        }
+    }
+
+    alignas(16) std::uint8_t mx[16];
+    alignas(16) std::uint64_t sad[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(mx), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sad), vsad);
+    acc.max_abs = std::max(acc.max_abs, static_cast<int>(*std::max_element(mx, mx + 16)));
+    acc.nonzero += nonzero;
+    acc.sum += sad[0] + sad[1];
+#endif
+
+    for (; i < n; ++i) {
+        const int d = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+        const int ad = (d < 0) ? -d : d;
+        if (ad == 0) continue;
+        acc.nonzero++;
+        acc.sum += static_cast<std::uint64_t>(ad);
+        if (ad > acc.max_abs) acc.max_abs = ad;
+        if (hist != nullptr) hist[ad]++;
+    }
+}
+
+std::size_t first_mismatch(const std::uint8_t* a, const std::uint8_t* b, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const unsigned eq = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+        if (eq != 0xFFFFu) return i + static_cast<std::size_t>(std::countr_zero(~eq & 0xFFFFu));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return n;
+}
+
+std::uint64_t sqdiff_sum(const std::uint8_t* a, const std::uint8_t* b, std::size_t n) {
+    std::uint64_t total = 0;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // Each step adds at most 2 * 2 * 255^2 to a 32-bit lane: flush every 4096 steps.
+    const __m128i zero = _mm_setzero_si128();
+    while (n - i >= 16) {
+        const std::size_t end = i + 16 * std::min<std::size_t>((n - i) / 16, 4096);
+        __m128i acc = zero;
+        for (; i < end; i += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            const __m128i vd = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            const __m128i lo = _mm_unpacklo_epi8(vd, zero);
+            const __m128i hi = _mm_unpackhi_epi8(vd, zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, lo));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, hi));
+        }
+        alignas(16) std::uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        total += std::uint64_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+    for (; i < n; ++i) {
+        const int d = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+        total += static_cast<std::uint64_t>(d * d);
+    }
+    return total;
+}
+
+// d[i] = sum over k of taps[k] * src[k][i]: the window sum of both SSIM passes.
+// The SSE2 path keeps eight outputs in registers across all taps instead of
+// streaming the output row through memory once per tap.
+static void window_sum(const float* const* src, const float* taps, int n, float* d) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128 t = _mm_set1_ps(taps[0]);
+        __m128 acc0 = _mm_mul_ps(t, _mm_loadu_ps(src[0] + i));
+        __m128 acc1 = _mm_mul_ps(t, _mm_loadu_ps(src[0] + i + 4));
+        for (int k = 1; k < ssim_window; ++k) {
+            t = _mm_set1_ps(taps[k]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(t, _mm_loadu_ps(src[k] + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(t, _mm_loadu_ps(src[k] + i + 4)));
+        }
+        _mm_storeu_ps(d + i, acc0);
+        _mm_storeu_ps(d + i + 4, acc1);
+    }
+#endif
+    for (; i < n; ++i) {
+        float acc = taps[0] * src[0][i];
+        for (int k = 1; k < ssim_window; ++k) acc += taps[k] * src[k][i];
+        d[i] = acc;
+    }
+}
+
+void ssim_hpass_row(const std::uint8_t* a, const std::uint8_t* b, int w, int channels,
+                    const float* taps, float* tmp, const SsimRows& out) {
+    const int in = w * channels;
+    const int n = (w - ssim_window + 1) * channels;
+    float* fa = tmp;
+    float* fb = tmp + in;
+    float* faa = tmp + 2 * in;
+    float* fbb = tmp + 3 * in;
+    float* fab = tmp + 4 * in;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= in; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i wa[2] = {_mm_unpacklo_epi8(va, zero), _mm_unpackhi_epi8(va, zero)};
+        const __m128i wb[2] = {_mm_unpacklo_epi8(vb, zero), _mm_unpackhi_epi8(vb, zero)};
+        for (int h = 0; h < 4; ++h) {
+            const __m128i ia = (h & 1) ? _mm_unpackhi_epi16(wa[h >> 1], zero) : _mm_unpacklo_epi16(wa[h >> 1], zero);
+            const __m128i ib = (h & 1) ? _mm_unpackhi_epi16(wb[h >> 1], zero) : _mm_unpacklo_epi16(wb[h >> 1], zero);
+            const __m128 fva = _mm_cvtepi32_ps(ia);
+            const __m128 fvb = _mm_cvtepi32_ps(ib);
+            const int o = i + 4 * h;
+            _mm_storeu_ps(fa + o, fva);
+            _mm_storeu_ps(fb + o, fvb);
+            _mm_storeu_ps(faa + o, _mm_mul_ps(fva, fva));
+            _mm_storeu_ps(fbb + o, _mm_mul_ps(fvb, fvb));
+            _mm_storeu_ps(fab + o, _mm_mul_ps(fva, fvb));
+        }
+    }
+#endif
+    for (; i < in; ++i) {
+        const float va = static_cast<float>(a[i]);
+        const float vb = static_cast<float>(b[i]);
+        fa[i] = va;
+        fb[i] = vb;
+        faa[i] = va * va;
+        fbb[i] = vb * vb;
+        fab[i] = va * vb;
+    }
+
+    const float* planes[5] = {fa, fb, faa, fbb, fab};
+    float* dst[5] = {out.x, out.y, out.xx, out.yy, out.xy};
+    const float* src[ssim_window];
+    for (int p = 0; p < 5; ++p) {
+        for (int k = 0; k < ssim_window; ++k) src[k] = planes[p] + k * channels;
+        window_sum(src, taps, n, dst[p]);
+    }
+}
+
+void ssim_vpass_row(const SsimRows* in, const float* taps, int n, const SsimRows& out) {
+    float* SsimRows::* const planes[5] = {&SsimRows::x, &SsimRows::y, &SsimRows::xx, &SsimRows::yy, &SsimRows::xy};
+    const float* src[ssim_window];
+    for (float* SsimRows::* p : planes) {
+        for (int k = 0; k < ssim_window; ++k) src[k] = in[k].*p;
+        window_sum(src, taps, n, out.*p);
+    }
+}
+
+void ssim_map_row(const SsimRows& m, int n, float c1, float c2, float* ssim_acc, float* cs_acc) {
+    for (int i = 0; i < n; ++i) {
+        const float mx = m.x[i];
+        const float my = m.y[i];
+        const float mxy = mx * my;
+        const float mxx = mx * mx;
+        const float myy = my * my;
+        const float cov = m.xy[i] - mxy;
+        const float var = (m.xx[i] - mxx) + (m.yy[i] - myy);
+        // One division for both terms: cs = nc/dc, ssim = (nl*nc)/(dl*dc).
+        const float nc = 2.0f * cov + c2;
+        const float dc = var + c2;
+        const float nl = 2.0f * mxy + c1;
+        const float dl = mxx + myy + c1;
+        const float r = 1.0f / (dl * dc);
+        cs_acc[i] += nc * dl * r;
+        ssim_acc[i] += nl * nc * r;
+    }
+}
+
+void hash_accumulate(std::uint64_t* acc, const std::uint8_t* data, std::size_t stripes, const std::uint64_t* keys) {
+#if defined(__SSE2__)
+    // Same lane arithmetic as the scalar path: _mm_mul_epu32 multiplies the low
+    // 32 bits of each 64-bit lane, the swap of the 64-bit halves feeds acc[i ^ 1].
+    __m128i a[4];
+    for (int l = 0; l < 4; ++l) a[l] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * l));
+    for (std::size_t s = 0; s < stripes; ++s) {
+        const std::uint8_t* p = data + s * hash_stripe_bytes;
+        for (int l = 0; l < 4; ++l) {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * l));
+            const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + s + 2 * l));
+            const __m128i dk = _mm_xor_si128(d, k);
+            const __m128i prod = _mm_mul_epu32(dk, _mm_srli_epi64(dk, 32));
+            a[l] = _mm_add_epi64(a[l], _mm_add_epi64(_mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2)), prod));
+        }
+    }
+    for (int l = 0; l < 4; ++l) _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2 * l), a[l]);
+#else
+    for (std::size_t s = 0; s < stripes; ++s) {
+        const std::uint8_t* p = data + s * hash_stripe_bytes;
+        for (int i = 0; i < hash_lanes; ++i) {
+            std::uint64_t d;
+            std::memcpy(&d, p + 8 * i, sizeof(d));
+            const std::uint64_t dk = d ^ keys[s + static_cast<std::size_t>(i)];
+            acc[i ^ 1] += d;
+            acc[i] += (dk & 0xFFFFFFFFu) * (dk >> 32);
+        }
+    }
+#endif
+}
+
+void hash_scramble(std::uint64_t* acc, const std::uint64_t* keys) {
+    for (int i = 0; i < hash_lanes; ++i) {
+        std::uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= keys[i];
+        acc[i] = a * 0x9E3779B1u;
+    }
+}
+
@@ -0,0 +1,133 @@
+// kernels_isa.cpp
+// Created by Francesco on 17/10/2026.
+//
+// The resampling row kernels, compiled once per x86-64 level (see dispatch.hpp).
+// CMake builds this file several times, each with its own -march and with
+// RESIZER_KERNEL_TABLE / RESIZER_KERNEL_LEVEL naming the table it defines; the
+// plain build is the baseline table. Everything else here has internal linkage
+// and the file uses no inline functions or templates from other headers, so no
+// higher-level code can be shared with (and run by) the baseline build.
+// Contraction into FMA is disabled for the levels that have it, and lround is
+// emulated exactly in a vectorizable form, so every level is bit-identical
+// to the scalar expressions of kernels.cpp.
+#include "dispatch.hpp"
+
+#include <cstdint>
+
+#ifndef RESIZER_KERNEL_TABLE
+  #define RESIZER_KERNEL_TABLE kernel_table_baseline
+  #define RESIZER_KERNEL_LEVEL Baseline
+#endif
+
+namespace {
+
+// std::lround (half away from zero) for |v| < 2^31: v - trunc(v) is exact.
+inline int round_half_away(float v) {
+    const int t = static_cast<int>(v);
+    const float f = v - static_cast<float>(t);
+    return t + static_cast<int>(f >= 0.5f) - static_cast<int>(f <= -0.5f);
+}
+
+inline std::uint8_t saturate_u8(int v) {
+    return static_cast<std::uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// Fixed channel counts (1, 3, 4) let the compiler unroll and vectorize the pixel
+// loop; CH = 0 is the generic path.
+template <int CH>
+void nearest_impl(const std::uint8_t* src, std::uint8_t* dst, const int* x0, int out_w, int channels) {
+    const int ch = (CH > 0) ? CH : channels;
+    for (int x = 0; x < out_w; ++x) {
+        const std::uint8_t* s = src + x0[x] * ch;
+        std::uint8_t* d = dst + x * ch;
+        for (int c = 0; c < ch; ++c) d[c] = s[c];
+    }
+}
+
+template <int CH>
+void bilinear_impl(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst,
+                   const int* x0, const int* x1, const float* wx, float wy, int out_w, int channels) {
+    const int ch = (CH > 0) ? CH : channels;
+    for (int x = 0; x < out_w; ++x) {
+        const float w = wx[x];
+        const std::uint8_t* p00 = row0 + x0[x] * ch;
+        const std::uint8_t* p10 = row0 + x1[x] * ch;
+        const std::uint8_t* p01 = row1 + x0[x] * ch;
+        const std::uint8_t* p11 = row1 + x1[x] * ch;
+        std::uint8_t* d = dst + x * ch;
+        for (int c = 0; c < ch; ++c) {
+            const float v00 = static_cast<float>(p00[c]);
+            const float v10 = static_cast<float>(p10[c]);
+            const float v01 = static_cast<float>(p01[c]);
+            const float v11 = static_cast<float>(p11[c]);
+
+            const float v0 = v00 + w * (v10 - v00);
+            const float v1 = v01 + w * (v11 - v01);
+            const float v  = v0  + wy * (v1  - v0);
+
+            d[c] = saturate_u8(round_half_away(v));
+        }
+    }
+}
+
+template <int CH>
+void hpass_impl(const std::uint8_t* src, float* dst, const int* x0, const int* x1, const float* wx,
+                int out_w, int channels) {
+    const int ch = (CH > 0) ? CH : channels;
+    for (int x = 0; x < out_w; ++x) {
+        const float w = wx[x];
+        const std::uint8_t* p0 = src + x0[x] * ch;
+        const std::uint8_t* p1 = src + x1[x] * ch;
+        float* d = dst + x * ch;
+        for (int c = 0; c < ch; ++c) {
+            const float v0 = static_cast<float>(p0[c]);
+            const float v1 = static_cast<float>(p1[c]);
+            d[c] = v0 + w * (v1 - v0);
+        }
+    }
+}
+
+void nearest_row(const std::uint8_t* src, std::uint8_t* dst, const int* x0, int out_w, int channels) {
+    switch (channels) {
+        case 1: nearest_impl<1>(src, dst, x0, out_w, 1); break;
+        case 3: nearest_impl<3>(src, dst, x0, out_w, 3); break;
+        case 4: nearest_impl<4>(src, dst, x0, out_w, 4); break;
+        default: nearest_impl<0>(src, dst, x0, out_w, channels); break;
+    }
+}
+
+void bilinear_row(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst,
+                  const int* x0, const int* x1, const float* wx, float wy, int out_w, int channels) {
+    switch (channels) {
+        case 1: bilinear_impl<1>(row0, row1, dst, x0, x1, wx, wy, out_w, 1); break;
+        case 3: bilinear_impl<3>(row0, row1, dst, x0, x1, wx, wy, out_w, 3); break;
+        case 4: bilinear_impl<4>(row0, row1, dst, x0, x1, wx, wy, out_w, 4); break;
+        default: bilinear_impl<0>(row0, row1, dst, x0, x1, wx, wy, out_w, channels); break;
+    }
+}
+
+void hpass_row(const std::uint8_t* src, float* dst, const int* x0, const int* x1, const float* wx,
+               int out_w, int channels) {
+    switch (channels) {
+        case 1: hpass_impl<1>(src, dst, x0, x1, wx, out_w, 1); break;
+        case 3: hpass_impl<3>(src, dst, x0, x1, wx, out_w, 3); break;
+        case 4: hpass_impl<4>(src, dst, x0, x1, wx, out_w, 4); break;
+        default: hpass_impl<0>(src, dst, x0, x1, wx, out_w, channels); break;
+    }
+}
+
+void vpass_row(const float* h0, const float* h1, std::uint8_t* dst, float wy, int n) {
+    for (int i = 0; i < n; ++i) {
+        const float v = h0[i] + wy * (h1[i] - h0[i]);
+        dst[i] = saturate_u8(round_half_away(v));
+    }
+}
+
+} // namespace
+
+const KernelTable& RESIZER_KERNEL_TABLE() {
+    static constexpr KernelTable table{
+        IsaLevel::RESIZER_KERNEL_LEVEL, &nearest_row, &bilinear_row, &hpass_row, &vpass_row
+    };
+    return table;
+}
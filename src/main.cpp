@@ -4,17 +4,265 @@
 // Program entry point.
 // If no CLI arguments are provided, an automatic experimental protocol is executed
 // (validation + benchmark sweep) on a fixed input image, for reproducibility.
+#include <algorithm>
 #include <iostream>
 #include <exception>
 #include <filesystem>
 #include <cmath>
-
+#include <cstdint>
+#include <map>
+#include <memory>
+
+#include "affinity.hpp"
+#include "attack.hpp"
+#include "conformance.hpp"
+#include "detect.hpp"
+#include "dispatch.hpp"
+#include "hash.hpp"
+#include "benchcmp.hpp"
 #include "cli.hpp"
 #include "io.hpp"
+#include "metadata.hpp"
+#include "metrics.hpp"
+#include "pipeline.hpp"
 #include "benchmark.hpp"
 #include "config.hpp"
 #include "util.hpp"
 #include "validate.hpp"
+#include "scaling.hpp"
+#include "sweep.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
+#include "yuv.hpp"
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+// Hash mode: hashes every input (directories expanded), optionally records them
+// in a manifest and checks them against one. compare_images runs only on mismatches.
+static int run_hash_mode(const CliOptions& opt) {
+    std::vector<std::string> files;
+    for (const std::string& in : opt.hash_inputs) {
+        if (std::filesystem::is_directory(in)) {
+            for (std::string& f : detect_list_files(in, opt.hash_recursive)) files.push_back(std::move(f));
+        } else {
+            files.push_back(in);
+        }
+    }
+
+    struct Hashed {
+        int width = 0, height = 0, channels = 0;
+        ContentHash hash;
+        double ms = 0.0;
+        std::string error;
+    };
+    std::vector<Hashed> hashed(files.size());
+    const bool across_files = files.size() > 1;
+    const long long n = static_cast<long long>(files.size());
+#if HAVE_OPENMP
+    if (opt.threads > 0) omp_set_num_threads(opt.threads);
+    #pragma omp parallel for schedule(dynamic) if(across_files)
+#endif
+    for (long long i = 0; i < n; ++i) {
+        Hashed& h = hashed[static_cast<std::size_t>(i)];
+        try {
+            const Image img = load_image(files[static_cast<std::size_t>(i)], 0);
+            const double t0 = now_ms();
+            h.hash = hash_image(img, across_files ? 1 : opt.threads);
+            h.ms = now_ms() - t0;
+            h.width = img.width;
+            h.height = img.height;
+            h.channels = img.channels;
+        } catch (const std::exception& e) {
+            h.error = e.what();
+        }
+    }
+
+    std::unique_ptr<ResultWriter> manifest;
+    if (!opt.manifest_path.empty()) manifest = std::make_unique<ResultWriter>(opt.manifest_path, hash_manifest_columns());
+
+    int errors = 0;
+    double hash_ms = 0.0;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const Hashed& h = hashed[i];
+        if (!h.error.empty()) {
+            std::cout << "error  " << files[i] << "  (" << h.error << ")\n";
+            errors++;
+            continue;
+        }
+        hash_ms += h.ms;
+        std::cout << h.hash.hex() << "  " << h.width << "x" << h.height << "x" << h.channels << "  " << files[i] << "\n";
+        if (manifest) {
+            using I = std::int64_t;
+            manifest->add_row({files[i], static_cast<I>(h.width), static_cast<I>(h.height), static_cast<I>(h.channels),
+                               h.hash.hex()});
+        }
+    }
+    if (manifest) manifest->flush();
+    std::cout << files.size() << " files, " << hash_ms << " ms hashing (excluding decode)\n";
+    if (manifest) std::cout << "Manifest written: " << opt.manifest_path << "\n";
+    if (opt.check_manifest.empty()) return (errors > 0) ? 2 : 0;
+
+    const std::map<std::string, ManifestEntry> golden = read_hash_manifest(opt.check_manifest);
+    int matched = 0, mismatched = 0, missing = 0;
+    std::cout << "\nCHECK against " << opt.check_manifest << "\n";
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const Hashed& h = hashed[i];
+        if (!h.error.empty()) continue;
+        const auto it = golden.find(files[i]);
+        if (it == golden.end()) {
+            std::cout << "  missing   " << files[i] << "\n";
+            missing++;
+            continue;
+        }
+        const ManifestEntry& e = it->second;
+        if (e.hash == h.hash && e.width == h.width && e.height == h.height && e.channels == h.channels) {
+            matched++;
+            continue;
+        }
+        mismatched++;
+        std::cout << "  MISMATCH  " << files[i] << "  expected " << e.hash.hex() << " (" << e.width << "x" << e.height
+                  << "x" << e.channels << ")\n";
+        if (opt.golden_dir.empty()) continue;
+
+        const std::string ref_path =
+            (std::filesystem::path(opt.golden_dir) / std::filesystem::path(files[i]).filename()).string();
+        try {
+            const Image ref = load_image(ref_path, 0);
+            const Image img = load_image(files[i], 0);
+            if (ref.width != img.width || ref.height != img.height || ref.channels != img.channels) {
+                std::cout << "            golden " << ref_path << " has a different size (" << ref.width << "x"
+                          << ref.height << "x" << ref.channels << ")\n";
+                continue;
+            }
+            const DiffStats d = compare_images(img, ref, opt.threads);
+            std::cout << "            vs " << ref_path << ": " << d.different_values << " values differ, max_abs "
+                      << d.max_abs_diff << ", mean_abs " << d.mean_abs_diff() << ", first at (" << d.first_x << ","
+                      << d.first_y << "," << d.first_c << ")\n";
+        } catch (const std::exception& e2) {
+            std::cout << "            cannot compare with " << ref_path << ": " << e2.what() << "\n";
+        }
+    }
+    std::cout << "  matched = " << matched << ", mismatched = " << mismatched << ", missing = " << missing
+              << ", errors = " << errors << "\n";
+    return (mismatched + missing + errors > 0) ? 3 : 0;
+}
+
+// Bench mode: one measurement per requested allocation mode, one result row each.
+static int run_bench_mode(const CliOptions& opt) {
+    Image img = load_image(opt.input_path, 0);
+
+    const std::vector<std::string> key_columns = {
+        "backend", "method", "threads", "affinity", "cpu_map", "alloc", "cache",
+        "in_w", "in_h", "out_w", "out_h", "channels"
+    };
+    std::vector<std::string> columns = key_columns;
+    for (const std::string& c : bench_result_columns()) columns.push_back(c);
+    ResultWriter writer(opt.csv_path, columns);
+
+    std::unique_ptr<ResultWriter> samples;
+    if (!opt.samples_path.empty()) {
+        std::vector<std::string> sample_columns = key_columns;
+        for (const char* c : {"sample", "ms", "outlier"}) sample_columns.emplace_back(c);
+        samples = std::make_unique<ResultWriter>(opt.samples_path, sample_columns);
+    }
+
+    const bool omp = (opt.backend == Backend::OpenMP);
+    ParallelOptions popt;
+    if (omp) popt.cpus = affinity_cpu_order(opt.affinity);
+    const std::string cpu_map = omp
+        ? affinity_mapping(popt.cpus, opt.threads > 0 ? opt.threads : static_cast<int>(popt.cpus.size()))
+        : std::string("-");
+    if (!popt.cpus.empty()) {
+        std::cout << "Affinity " << affinity_policy_name(opt.affinity.policy) << " (thread:cpu " << cpu_map << ")\n";
+    }
+
+    for (AllocMode alloc : opt.alloc_modes) {
+        for (CacheMode cache : opt.cache_modes) {
+            BenchOptions bopt = opt.bench;
+            bopt.alloc = alloc;
+            bopt.cache = cache;
+
+            BenchResult r = benchmark_resize(
+                img,
+                opt.out_w, opt.out_h,
+                opt.method,
+                opt.backend,
+                opt.threads,
+                opt.warmup,
+                opt.runs,
+                1,
+                popt,
+                bopt
+            );
+
+            std::cout << "Benchmark results (alloc = " << alloc_mode_name(alloc)
+                      << ", cache = " << cache_mode_name(cache) << "):\n"
+                      << "  runs   = " << r.runs << "\n"
+                      << "  mean   = " << r.mean_ms << " ms\n"
+                      << "  stddev = " << r.stddev_ms << " ms\n"
+                      << "  min    = " << r.min_ms << " ms\n"
+                      << "  max    = " << r.max_ms << " ms\n"
+                      << "  median = " << r.median_ms << " ms  (95% CI " << r.ci_lo_ms << " .. " << r.ci_hi_ms << ")\n"
+                      << "  p90    = " << r.p90_ms << " ms\n"
+                      << "  p99    = " << r.p99_ms << " ms\n"
+                      << "  mad    = " << r.mad_ms << " ms  (" << r.outliers << " outliers rejected)\n"
+                      << "  faults = " << r.minor_faults << " minor, " << r.major_faults << " major per resize\n"
+                      << "  bw     = " << r.bandwidth_gbs << " GB/s (nominal " << r.bytes_per_call / 1.0e6 << " MB per resize)\n";
+
+            if (opt.bench.perf_counters) {
+                if (r.perf.any()) {
+                    std::cout << "Hardware counters (per resize, all threads):\n"
+                              << "  cycles        = " << r.perf.cycles << "\n"
+                              << "  instructions  = " << r.perf.instructions << "\n"
+                              << "  ipc           = " << r.perf.ipc() << "\n"
+                              << "  l1d_misses    = " << r.perf.l1d_misses << "\n"
+                              << "  llc_misses    = " << r.perf.llc_misses << "\n"
+                              << "  branch_misses = " << r.perf.branch_misses << "\n"
+                              << "  dtlb_misses   = " << r.perf.dtlb_misses << "\n";
+                } else {
+                    std::cout << "Hardware counters unavailable (" << r.perf_status << ")\n";
+                }
+            }
+            if (!r.threads.empty()) {
+                std::cout << "Thread accounting (per resize):\n"
+                          << "  imbalance     = " << r.imbalance << " (max/mean busy)\n"
+                          << "  idle_fraction = " << r.idle_fraction << "\n";
+                for (size_t t = 0; t < r.threads.size(); ++t) {
+                    const ThreadWork& w = r.threads[t];
+                    std::cout << "  thread " << t << ": busy " << w.busy_ms << " ms, wait "
+                              << w.wait_ms << " ms, " << w.rows << " rows\n";
+                }
+            } else if (opt.bench.thread_stats) {
+                std::cout << "Thread accounting applies to the omp backend only\n";
+            }
+            if (!r.converged) {
+                std::cout << "  (adaptive: CI target not reached within budget)\n";
+            }
+
+            const std::vector<ResultValue> key = {
+                std::string(backend_name(opt.backend)), std::string(method_name(opt.method)),
+                static_cast<std::int64_t>(opt.threads),
+                std::string(omp ? affinity_policy_name(opt.affinity.policy) : "-"), cpu_map,
+                std::string(alloc_mode_name(alloc)),
+                std::string(cache_mode_name(cache)),
+                static_cast<std::int64_t>(img.width), static_cast<std::int64_t>(img.height),
+                static_cast<std::int64_t>(opt.out_w), static_cast<std::int64_t>(opt.out_h),
+                static_cast<std::int64_t>(img.channels)
+            };
+            std::vector<ResultValue> row = key;
+            append_bench_result(row, r);
+            writer.add_row(std::move(row));
+
+            if (samples) write_samples(*samples, key, r, opt.bench.outlier_k);
+        }
+    }
+
+    writer.flush();
+    if (samples) samples->flush();
+    return 0;
+}
 
 int main(int argc, char** argv) {
     try {
@@ -22,13 +270,15 @@ int main(int argc, char** argv) {
         // AUTOMATIC TEST MODE (no CLI arguments)
         // ================================================================
         if (argc == 1) {
-            const std::string input = "test_1.png";
+            std::string input = "test_1.png";
 
             if (!std::filesystem::exists(input)) {
+                // Deterministic stand-in so the protocol runs anywhere.
+                input = "synthetic:1920x1080x3:natural:1";
                 std::cerr
-                    << "ERROR: default test image not found.\n"
-                    << "Expected: " << std::filesystem::absolute(input).string() << "\n";
-                return 2;
+                    << "NOTE: default test image not found ("
+                    << std::filesystem::absolute("test_1.png").string() << "),\n"
+                    << "      using " << input << " instead.\n";
             }
 
             // Fixed experimental setup (reproducible)
@@ -75,76 +325,78 @@ int main(int argc, char** argv) {
             const int warmup = 2;
             const int runs   = 20;
 
+            set_run_parameters({
+                {"command", command_line(argc, argv)},
+                {"mode", std::string("auto")},
+                {"input", input},
+                {"method", std::string(method_name(method))},
+                {"threads", static_cast<std::int64_t>(threads)},
+                {"warmup", static_cast<std::int64_t>(warmup)},
+                {"runs", static_cast<std::int64_t>(runs)},
+                {"inner_reps", static_cast<std::int64_t>(inner_reps)},
+            });
+
             Image img = load_image(input, 0);
 
             int w = base_w;
             int h = base_h;
 
-            const std::string header =
-                "backend,out_w,out_h,channels,inner_reps,mean_ms,stddev_ms,min_ms,max_ms";
+            // Legacy per-backend CSVs (same schema as before) plus one
+            // self-describing JSON file with the full statistics.
+            const std::vector<std::string> csv_columns = {
+                "backend", "out_w", "out_h", "channels", "inner_reps", "mean_ms", "stddev_ms", "min_ms", "max_ms"
+            };
+            std::vector<std::string> json_columns(csv_columns.begin(), csv_columns.begin() + 5);
+            for (const std::string& c : bench_result_columns()) json_columns.push_back(c);
+
+            ResultWriter seq_csv("bench_seq.csv", csv_columns);
+            ResultWriter omp_csv("bench_omp.csv", csv_columns);
+            ResultWriter json("bench_sweep.json", json_columns);
+            json.set_parameter("base_w", static_cast<std::int64_t>(base_w));
+            json.set_parameter("base_h", static_cast<std::int64_t>(base_h));
+            json.set_parameter("steps", static_cast<std::int64_t>(steps));
+            json.set_parameter("scale", scale);
 
             for (int i = 0; i < steps; ++i) {
                 std::cout << "\n[STEP " << (i + 1) << "/" << steps
                           << "] size = " << w << "x" << h << "\n";
 
-                // --- Sequential ---
-                {
-                    std::cout << "  seq  : running... " << std::flush;
-
-                    BenchResult r = benchmark_resize(
-                        img, w, h,
-                        method, Backend::Sequential, 0,
-                        warmup, runs,
-                        inner_reps
-                    );
-
-                    std::cout << "mean = " << r.mean_ms << " ms\n";
-
-                    append_csv_row(
-                        "bench_seq.csv",
-                        header,
-                        "seq," + std::to_string(w) + "," + std::to_string(h) + "," +
-                        std::to_string(img.channels) + "," +
-                        std::to_string(inner_reps) + "," +
-                        std::to_string(r.mean_ms) + "," +
-                        std::to_string(r.stddev_ms) + "," +
-                        std::to_string(r.min_ms) + "," +
-                        std::to_string(r.max_ms)
-                    );
-                }
-
-                // --- OpenMP ---
-                {
-                    std::cout << "  omp  : running... " << std::flush;
+                for (Backend backend : {Backend::Sequential, Backend::OpenMP}) {
+                    std::cout << "  " << backend_name(backend) << "  : running... " << std::flush;
 
                     BenchResult r = benchmark_resize(
                         img, w, h,
-                        method, Backend::OpenMP, threads,
+                        method, backend, (backend == Backend::OpenMP) ? threads : 0,
                         warmup, runs,
                         inner_reps
                     );
 
                     std::cout << "mean = " << r.mean_ms << " ms\n";
 
-                    append_csv_row(
-                        "bench_omp.csv",
-                        header,
-                        "omp," + std::to_string(w) + "," + std::to_string(h) + "," +
-                        std::to_string(img.channels) + "," +
-                        std::to_string(inner_reps) + "," +
-                        std::to_string(r.mean_ms) + "," +
-                        std::to_string(r.stddev_ms) + "," +
-                        std::to_string(r.min_ms) + "," +
-                        std::to_string(r.max_ms)
-                    );
+                    std::vector<ResultValue> key = {
+                        std::string(backend_name(backend)),
+                        static_cast<std::int64_t>(w), static_cast<std::int64_t>(h),
+                        static_cast<std::int64_t>(img.channels),
+                        static_cast<std::int64_t>(inner_reps)
+                    };
+                    std::vector<ResultValue> row = key;
+                    row.insert(row.end(), {r.mean_ms, r.stddev_ms, r.min_ms, r.max_ms});
+                    ((backend == Backend::OpenMP) ? omp_csv : seq_csv).add_row(std::move(row));
+
+                    append_bench_result(key, r);
+                    json.add_row(std::move(key));
                 }
 
                 w = static_cast<int>(std::round(w * scale));
                 h = static_cast<int>(std::round(h * scale));
             }
 
+            seq_csv.flush();
+            omp_csv.flush();
+            json.flush();
+
             std::cout << "\nEXPERIMENT COMPLETED\n";
-            std::cout << "CSV files generated: bench_seq.csv, bench_omp.csv\n";
+            std::cout << "Result files generated: bench_seq.csv, bench_omp.csv, bench_sweep.json\n";
 
             return 0;
         }
@@ -153,12 +405,19 @@ int main(int argc, char** argv) {
         // CLI MODE
         // ================================================================
         const CliOptions opt = parse_cli(argc, argv);
+        set_run_parameters(cli_run_parameters(opt, argc, argv));
 
         if (opt.mode == RunMode::Help) {
             print_usage(std::cerr);
             return 1;
         }
 
+        // Before any kernel runs and before the metadata (isa_level) is collected.
+        if (!opt.isa_level.empty()) apply_isa_option(opt.isa_level);
+
+        // Written when main returns (trace.hpp); empty path = tracing off.
+        TraceSession trace(opt.trace_path);
+
         // ------------------ VALIDATE ------------------
         if (opt.mode == RunMode::Validate) {
             Image img = load_image(opt.input_path, 0);
@@ -168,7 +427,9 @@ int main(int argc, char** argv) {
             Image out_omp = resize(img, opt.out_w, opt.out_h, opt.method,
                                    Backend::OpenMP, opt.threads);
 
-            DiffStats d = compare_images(out_seq, out_omp);
+            const double t0 = now_ms();
+            DiffStats d = compare_images(out_seq, out_omp, opt.threads);
+            const double compare_ms = now_ms() - t0;
 
             std::cout << "VALIDATE\n"
                       << "  input            = " << opt.input_path << "\n"
@@ -177,19 +438,156 @@ int main(int argc, char** argv) {
                       << ((opt.method == ResizeMethod::Nearest) ? "nearest" : "bilinear") << "\n"
                       << "  omp_threads       = " << opt.threads << "\n"
                       << "  different_values  = " << d.different_values << "\n"
-                      << "  max_abs_diff      = " << d.max_abs_diff << "\n";
+                      << "  max_abs_diff      = " << d.max_abs_diff << "\n"
+                      << "  mean_abs_diff     = " << d.mean_abs_diff() << "\n";
+            if (d.different_values != 0) {
+                std::cout << "  first_mismatch    = (" << d.first_x << ", " << d.first_y << ") channel " << d.first_c
+                          << ": seq " << static_cast<int>(out_seq.at(d.first_x, d.first_y, d.first_c))
+                          << ", omp " << static_cast<int>(out_omp.at(d.first_x, d.first_y, d.first_c)) << "\n"
+                          << "  histogram         =";
+                for (int v = 1; v < 256; ++v) {
+                    if (d.histogram[static_cast<size_t>(v)] != 0) std::cout << " " << v << ":" << d.histogram[static_cast<size_t>(v)];
+                }
+                std::cout << "\n";
+            }
+            std::cout << "  compare_ms        = " << compare_ms << "\n";
+
+            if (opt.compare_reference) {
+                const double r0 = now_ms();
+                const DiffStats ref = compare_images_reference(out_seq, out_omp);
+                const double ref_ms = now_ms() - r0;
+                std::cout << "  reference_ms      = " << ref_ms << "\n"
+                          << "  reference         = " << ((ref == d) ? "agrees" : "DISAGREES") << "\n";
+                if (!(ref == d)) return 2;
+            }
 
             return (d.different_values == 0) ? 0 : 3;
         }
 
+        // ------------------ METRICS ------------------
+        if (opt.mode == RunMode::Metrics) {
+            const Image ref = load_image(opt.input_path, 0);
+            const Image dist = load_image(opt.distorted_path, 0);
+
+            auto print_channels = [](const std::vector<double>& v) {
+                std::cout << " (channels";
+                for (double x : v) std::cout << " " << x;
+                std::cout << ")";
+            };
+
+            std::cout << "METRICS\n"
+                      << "  reference_image   = " << opt.input_path << " (" << ref.width << "x" << ref.height
+                      << "x" << ref.channels << ")\n"
+                      << "  distorted_image   = " << opt.distorted_path << "\n"
+                      << "  omp_threads       = " << opt.threads << "\n";
+
+            if (opt.metric_psnr) {
+                const double t0 = now_ms();
+                const ErrorMetrics e = error_metrics(ref, dist, opt.threads);
+                const double ms = now_ms() - t0;
+                std::cout << "  mae               = " << e.mae << "\n"
+                          << "  rmse              = " << e.rmse << "\n"
+                          << "  psnr_db           = " << e.psnr << "\n"
+                          << "  max_abs_diff      = " << e.max_abs << "\n"
+                          << "  psnr_ms           = " << ms << "\n";
+            }
+
+            SsimResult s;
+            if (opt.metric_ssim || opt.compare_reference) {
+                const double t0 = now_ms();
+                s = ssim(ref, dist, opt.threads);
+                const double ms = now_ms() - t0;
+                std::cout << "  ssim              = " << s.ssim;
+                if (s.channels.size() > 1) print_channels(s.channels);
+                std::cout << "\n  ssim_ms           = " << ms << "\n";
+            }
+
+            if (opt.metric_ms_ssim) {
+                const double t0 = now_ms();
+                const MsSsimResult m = ms_ssim(ref, dist, opt.threads);
+                const double ms = now_ms() - t0;
+                std::cout << "  ms_ssim           = " << m.ms_ssim;
+                if (m.channels.size() > 1) print_channels(m.channels);
+                std::cout << "\n  ms_ssim_scales    = " << m.scales << "\n"
+                          << "  ms_ssim_ms        = " << ms << "\n";
+            }
+
+            if (opt.compare_reference) {
+                const double t0 = now_ms();
+                const SsimResult r = ssim_reference(ref, dist);
+                const double ms = now_ms() - t0;
+                double max_dev = 0.0;
+                for (size_t c = 0; c < r.channels.size(); ++c) {
+                    max_dev = std::max({max_dev, std::abs(r.channels[c] - s.channels[c]), std::abs(r.cs[c] - s.cs[c])});
+                }
+                const bool agrees = max_dev <= cfg::ssim_reference_tolerance;
+                std::cout << "  reference_ssim    = " << r.ssim << "\n"
+                          << "  reference_ms      = " << ms << "\n"
+                          << "  reference         = " << (agrees ? "agrees" : "DISAGREES")
+                          << " (max deviation " << max_dev << ")\n";
+                if (!agrees) return 2;
+            }
+            return 0;
+        }
+
+        // ------------------ ATTACK ------------------
+        if (opt.mode == RunMode::Attack) {
+            Image img = load_image(opt.input_path, 0);
+            const double t0 = now_ms();
+            const std::vector<AttackResult> res = run_attack_grid(img, opt.attack, std::cout);
+            const double ms = now_ms() - t0;
+            write_attack_results(res, img, opt.csv_path);
+            print_attack_summary(res, opt.attack.top, std::cout);
+            std::cout << "\n" << res.size() << " configurations in " << ms << " ms\n"
+                      << "CSV written: " << opt.csv_path << "\n";
+            return 0;
+        }
+
+        // ------------------ DETECT ------------------
+        if (opt.mode == RunMode::Detect) {
+            const DetectReport rep = run_detect(opt.detect, std::cout);
+            write_detect_results(rep, opt.detect, opt.csv_path);
+            print_detect_summary(rep, opt.detect, std::cout);
+            std::cout << "CSV written: " << opt.csv_path << "\n";
+            return (rep.attacks > 0) ? 3 : 0;
+        }
+
+        // ------------------ HASH ------------------
+        if (opt.mode == RunMode::Hash) {
+            return run_hash_mode(opt);
+        }
+
+        // ------------------ CONFORMANCE ------------------
+        if (opt.mode == RunMode::Conformance) {
+            if (opt.conformance_list) {
+                for (const ConformanceKernel& k : conformance_kernels()) {
+                    std::cout << k.name << "  isa=" << k.isa << " backend=" << k.backend
+                              << " precision=" << k.precision << " budget=" << k.max_abs_budget << "\n";
+                }
+                return 0;
+            }
+            const double t0 = now_ms();
+            const std::vector<ConformanceResult> res = run_conformance(opt.conformance, std::cout);
+            const double ms = now_ms() - t0;
+            write_conformance_results(res, opt.csv_path);
+            print_conformance_summary(res, std::cout);
+            std::cout << "Finished in " << ms << " ms\n"
+                      << "CSV written: " << opt.csv_path << "\n";
+            const bool ok = std::all_of(res.begin(), res.end(), [](const ConformanceResult& r) { return r.failures == 0; });
+            return ok ? 0 : 3;
+        }
+
         // ------------------ RUN ------------------
         if (opt.mode == RunMode::Run) {
             Image img = load_image(opt.input_path, 0);
+            ParallelOptions popt;
+            if (opt.backend == Backend::OpenMP) popt.cpus = affinity_cpu_order(opt.affinity);
             Image out = resize(img, opt.out_w, opt.out_h,
-                               opt.method, opt.backend, opt.threads);
+                               opt.method, opt.backend, opt.threads, popt);
 
-            if (ends_with_icase(opt.output_path, ".jpg") ||
-                ends_with_icase(opt.output_path, ".jpeg")) {
+            const bool jpg = ends_with_icase(opt.output_path, ".jpg") ||
+                             ends_with_icase(opt.output_path, ".jpeg");
+            if (jpg) {
                 save_jpg(out, opt.output_path, cfg::default_jpg_quality);
             } else {
                 save_png(out, opt.output_path, cfg::default_png_compression);
@@ -198,30 +596,85 @@ int main(int argc, char** argv) {
             std::cout << "OK: wrote " << opt.output_path
                       << " (" << out.width << "x" << out.height
                       << "x" << out.channels << ")\n";
+
+            if (!opt.manifest_path.empty()) {
+                // PNG round-trips the pixels; a JPEG is hashed as decoded, which is what hash --check sees.
+                const Image hashed = jpg ? load_image(opt.output_path, 0) : std::move(out);
+                const ContentHash h = hash_image(hashed, opt.threads);
+                record_hash_manifest(opt.manifest_path, opt.output_path, hashed, h);
+                std::cout << "hash " << h.hex() << " recorded in " << opt.manifest_path << "\n";
+            }
             return 0;
         }
 
+        // ------------------ YUV ------------------
+        if (opt.mode == RunMode::Yuv) {
+            YuvImage img = load_yuv_raw(opt.input_path, opt.in_w, opt.in_h,
+                                        opt.chroma_format, opt.chroma_siting);
+            YuvImage out = resize_yuv(img, opt.out_w, opt.out_h,
+                                      opt.method, opt.backend, opt.threads);
+
+            // Convert to RGB only when the output container needs it.
+            if (ends_with_icase(opt.output_path, ".jpg") ||
+                ends_with_icase(opt.output_path, ".jpeg")) {
+                save_jpg(yuv_to_rgb(out, opt.threads), opt.output_path, cfg::default_jpg_quality);
+            } else if (ends_with_icase(opt.output_path, ".png")) {
+                save_png(yuv_to_rgb(out, opt.threads), opt.output_path, cfg::default_png_compression);
+            } else {
+                save_yuv_raw(out, opt.output_path);
+            }
+
+            std::cout << "OK: wrote " << opt.output_path
+                      << " (" << out.width << "x" << out.height
+                      << (out.format == ChromaFormat::Yuv420 ? " 4:2:0" : " 4:2:2") << ")\n";
+            return 0;
+        }
+
+        // ------------------ BENCHSET ------------------
+        if (opt.mode == RunMode::BenchSet) {
+            Image img = load_image(opt.input_path, 0);
+            run_sweep(img, opt.sweep, opt.csv_path, std::cout);
+            return 0;
+        }
+
+        // ------------------ SCALING ------------------
+        if (opt.mode == RunMode::Scaling) {
+            Image img = load_image(opt.input_path, 0);
+            ScalingSpec spec = opt.scaling;
+            spec.popt.cpus = affinity_cpu_order(opt.affinity);
+            if (!spec.popt.cpus.empty()) {
+                std::cout << "Affinity " << affinity_policy_name(opt.affinity.policy) << ", cpu order "
+                          << affinity_mapping(spec.popt.cpus, static_cast<int>(spec.popt.cpus.size())) << "\n";
+            }
+            const ScalingReport rep = run_scaling(img, spec, std::cout);
+            write_scaling_report(rep, spec, img, opt.csv_path);
+            print_scaling_summary(rep, std::cout);
+            std::cout << "\nCSV written: " << opt.csv_path << "\n";
+            return 0;
+        }
+
+        // ------------------ PIPELINE ------------------
+        if (opt.mode == RunMode::Pipeline) {
+            const std::vector<PipelineResult> res = run_pipeline_bench(opt.pipeline, std::cout);
+            print_pipeline_summary(res, std::cout);
+            write_pipeline_results(res, opt.pipeline, opt.csv_path);
+            std::cout << "\nCSV written: " << opt.csv_path << "\n";
+            return 0;
+        }
+
+        // ------------------ BENCHCMP ------------------
+        if (opt.mode == RunMode::BenchCmp) {
+            const BenchCmpReport rep = compare_bench_results(opt.benchcmp);
+            print_benchcmp_table(rep, opt.benchcmp, std::cout);
+            if (!opt.csv_path.empty()) {
+                write_benchcmp_report(rep, opt.csv_path);
+                std::cout << "Report written: " << opt.csv_path << "\n";
+            }
+            return benchcmp_failed(rep, opt.benchcmp) ? 3 : 0;
+        }
+
         // ------------------ BENCH ------------------
-        Image img = load_image(opt.input_path, 0);
-
-        BenchResult r = benchmark_resize(
-            img,
-            opt.out_w, opt.out_h,
-            opt.method,
-            opt.backend,
-            opt.threads,
-            opt.warmup,
-            opt.runs
-        );
-
-        std::cout << "Benchmark results:\n"
-                  << "  runs   = " << r.runs << "\n"
-                  << "  mean   = " << r.mean_ms << " ms\n"
-                  << "  stddev = " << r.stddev_ms << " ms\n"
-                  << "  min    = " << r.min_ms << " ms\n"
-                  << "  max    = " << r.max_ms << " ms\n";
-
-        return 0;
+        return run_bench_mode(opt);
 
     } catch (const std::exception& e) {
         std::cerr << "ERROR: " << e.what() << "\n";
@@ -0,0 +1,175 @@
+// metadata.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the environment/run metadata collection.
+// Build details (flags, build type, git revision) are injected by CMake as
+// RESIZER_* definitions on this file only; the git revision is taken at
+// configure time.
+#include "metadata.hpp"
+
+#include "dispatch.hpp"
+#include "sysinfo.hpp"
+
+#include <cstdint>
+#include <ctime>
+#include <set>
+#include <thread>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+  #include <unistd.h>
+#endif
+
+#ifndef RESIZER_GIT_SHA
+  #define RESIZER_GIT_SHA "unknown"
+#endif
+#ifndef RESIZER_CXX_FLAGS
+  #define RESIZER_CXX_FLAGS "unknown"
+#endif
+#ifndef RESIZER_BUILD_TYPE
+  #define RESIZER_BUILD_TYPE "unknown"
+#endif
+
+static std::string or_unknown(std::string s) {
+    return s.empty() ? std::string("unknown") : s;
+}
+
+static std::string compiler_name() {
+#if defined(__clang__)
+    return "Clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "GCC " __VERSION__;
+#elif defined(_MSC_VER)
+    return "MSVC " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+// _OPENMP is the release date of the supported specification (yyyymm).
+static std::string openmp_version() {
+#if HAVE_OPENMP && defined(_OPENMP)
+    static const std::pair<long, const char*> versions[] = {
+        {200505, "2.5"}, {200805, "3.0"}, {201107, "3.1"}, {201307, "4.0"},
+        {201511, "4.5"}, {201811, "5.0"}, {202011, "5.1"}, {202111, "5.2"}
+    };
+    std::string name = std::to_string(_OPENMP);
+    for (const auto& [date, ver] : versions) {
+        if (date == _OPENMP) name = std::string(ver) + " (" + name + ")";
+    }
+    return name;
+#else
+    return "none";
+#endif
+}
+
+static std::string host_name() {
+#if defined(__linux__) || defined(__APPLE__)
+    char buf[256] = {};
+    if (gethostname(buf, sizeof(buf) - 1) == 0) return buf;
+#endif
+    return {};
+}
+
+static std::string utc_now() {
+    const std::time_t t = std::time(nullptr);
+    std::tm tm {};
+#if defined(_WIN32)
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buf[32] = {};
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+static MetadataFields collect_environment() {
+    MetadataFields m;
+    m.emplace_back("date_utc", utc_now());
+    m.emplace_back("host", or_unknown(host_name()));
+    m.emplace_back("os", or_unknown(kernel_release()));
+    m.emplace_back("cpu_model", or_unknown(cpu_model_name()));
+
+    const std::vector<LogicalCpu>& topo = cpu_topology();
+    std::set<std::pair<int, int>> cores;
+    std::set<int> packages;
+    for (const LogicalCpu& c : topo) {
+        cores.insert({c.package, c.core});
+        packages.insert(c.package);
+    }
+    m.emplace_back("hardware_threads", static_cast<std::int64_t>(std::thread::hardware_concurrency()));
+    m.emplace_back("allowed_cpus", static_cast<std::int64_t>(topo.size()));
+    m.emplace_back("physical_cores", static_cast<std::int64_t>(cores.size()));
+    m.emplace_back("packages", static_cast<std::int64_t>(packages.size()));
+
+    // cache_l1d_bytes, cache_l1i_bytes, cache_l2_bytes, ...
+    for (const CacheLevel& c : cpu_caches()) {
+        std::string name = "cache_l" + std::to_string(c.level);
+        if (c.type == "Data") name += 'd';
+        else if (c.type == "Instruction") name += 'i';
+        m.emplace_back(name + "_bytes", static_cast<std::int64_t>(c.size_bytes));
+    }
+
+    std::string isa;
+    for (const std::string& f : cpu_isa_extensions()) {
+        if (!isa.empty()) isa += ' ';
+        isa += f;
+    }
+    m.emplace_back("isa", or_unknown(isa));
+
+    // Row kernel variant in use (dispatch.hpp): overrides are applied before the first collection.
+    std::string levels;
+    for (IsaLevel l : compiled_isa_levels()) {
+        if (!levels.empty()) levels += ' ';
+        levels += isa_level_name(l);
+    }
+    m.emplace_back("isa_level", std::string(isa_level_name(active_kernels().level)));
+    m.emplace_back("isa_level_detected", std::string(isa_level_name(detected_isa_level())));
+    m.emplace_back("isa_levels_compiled", levels);
+    m.emplace_back("governor", or_unknown(cpu_governor()));
+
+    m.emplace_back("compiler", compiler_name());
+    m.emplace_back("cxx_standard", static_cast<std::int64_t>(__cplusplus));
+    m.emplace_back("cxx_flags", std::string(RESIZER_CXX_FLAGS));
+    m.emplace_back("build_type", std::string(RESIZER_BUILD_TYPE));
+    m.emplace_back("openmp", openmp_version());
+#if HAVE_OPENMP
+    m.emplace_back("omp_max_threads", static_cast<std::int64_t>(omp_get_max_threads()));
+#else
+    m.emplace_back("omp_max_threads", static_cast<std::int64_t>(1));
+#endif
+    m.emplace_back("git_sha", std::string(RESIZER_GIT_SHA));
+    return m;
+}
+
+const MetadataFields& environment_metadata() {
+    static const MetadataFields env = collect_environment();
+    return env;
+}
+
+static MetadataFields& run_parameters_storage() {
+    static MetadataFields params;
+    return params;
+}
+
+void set_run_parameters(MetadataFields params) {
+    run_parameters_storage() = std::move(params);
+}
+
+const MetadataFields& run_parameters() {
+    return run_parameters_storage();
+}
+
+std::string command_line(int argc, char** argv) {
+    std::string s;
+    for (int i = 0; i < argc; ++i) {
+        if (i) s += ' ';
+        const std::string a = argv[i];
+        if (a.find(' ') != std::string::npos) s += '"' + a + '"';
+        else s += a;
+    }
+    return s;
+}
@@ -0,0 +1,332 @@
+// metrics.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the image quality metrics.
+// PSNR sums come from the SIMD byte kernels; SSIM uses the separable window
+// kernels of kernels.hpp on row-band x column tiles, with one workspace per thread.
+#include "metrics.hpp"
+
+#include "kernels.hpp"
+#include "resize.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+// Same work unit as compare_images.
+static constexpr std::size_t error_chunk_bytes = std::size_t{1} << 20;
+
+// SSIM constants (Wang et al. 2004) and tile size in window positions:
+// a tile's working set (11 filtered rows of 5 moments) stays within L2.
+static constexpr double ssim_sigma = 1.5;
+static constexpr double ssim_k1 = 0.01;
+static constexpr double ssim_k2 = 0.03;
+static constexpr int ssim_tile_w = 256;
+static constexpr int ssim_tile_h = 128;
+
+static constexpr std::array<double, 5> ms_ssim_weights = {0.0448, 0.2856, 0.3001, 0.2363, 0.1333};
+
+static void check_same_shape(const Image& a, const Image& b, const char* what) {
+    if (a.empty() || b.empty()) {
+        throw std::invalid_argument(std::string(what) + ": empty image");
+    }
+    if (a.width != b.width || a.height != b.height || a.channels != b.channels) {
+        throw std::invalid_argument(std::string(what) + ": images differ in size/channels ("
+            + std::to_string(a.width) + "x" + std::to_string(a.height) + "x" + std::to_string(a.channels) + " vs "
+            + std::to_string(b.width) + "x" + std::to_string(b.height) + "x" + std::to_string(b.channels) + ")");
+    }
+}
+
+// Channels included in the overall SSIM / MS-SSIM (alpha is left out).
+static int color_channels(int channels) {
+    return (channels == 4) ? 3 : channels;
+}
+
+static double mean_color(const std::vector<double>& per_channel) {
+    const int n = color_channels(static_cast<int>(per_channel.size()));
+    double s = 0.0;
+    for (int c = 0; c < n; ++c) s += per_channel[static_cast<size_t>(c)];
+    return s / n;
+}
+
+static std::array<double, ssim_window> gaussian_window() {
+    std::array<double, ssim_window> g{};
+    double sum = 0.0;
+    for (int i = 0; i < ssim_window; ++i) {
+        const double d = i - ssim_window / 2;
+        g[static_cast<size_t>(i)] = std::exp(-(d * d) / (2.0 * ssim_sigma * ssim_sigma));
+        sum += g[static_cast<size_t>(i)];
+    }
+    for (double& v : g) v /= sum;
+    return g;
+}
+
+ErrorMetrics error_metrics(const Image& a, const Image& b, int threads) {
+    check_same_shape(a, b, "error_metrics");
+    TRACE_SCOPE("psnr", trace_cat::metrics);
+
+    const std::size_t n = a.data.size();
+    const std::size_t chunks = (n + error_chunk_bytes - 1) / error_chunk_bytes;
+
+    struct Partial {
+        AbsDiffAccum acc;
+        std::uint64_t sq = 0;
+    };
+    std::vector<Partial> parts(chunks);
+
+    auto run_chunk = [&](std::size_t k) {
+        const std::size_t begin = k * error_chunk_bytes;
+        const std::size_t len = std::min(error_chunk_bytes, n - begin);
+        absdiff_stats(a.data.data() + begin, b.data.data() + begin, len, parts[k].acc, nullptr);
+        parts[k].sq = sqdiff_sum(a.data.data() + begin, b.data.data() + begin, len);
+    };
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    const long long nchunks = static_cast<long long>(chunks);
+    #pragma omp parallel for schedule(static)
+    for (long long k = 0; k < nchunks; ++k) run_chunk(static_cast<std::size_t>(k));
+#else
+    (void)threads;
+    for (std::size_t k = 0; k < chunks; ++k) run_chunk(k);
+#endif
+
+    std::uint64_t sum_abs = 0;
+    std::uint64_t sum_sq = 0;
+    ErrorMetrics m;
+    for (const Partial& p : parts) {
+        sum_abs += p.acc.sum;
+        sum_sq += p.sq;
+        m.max_abs = std::max(m.max_abs, p.acc.max_abs);
+    }
+
+    m.mae = static_cast<double>(sum_abs) / static_cast<double>(n);
+    m.mse = static_cast<double>(sum_sq) / static_cast<double>(n);
+    m.rmse = std::sqrt(m.mse);
+    m.psnr = (sum_sq == 0) ? std::numeric_limits<double>::infinity()
+                           : 20.0 * std::log10(255.0) - 10.0 * std::log10(m.mse);
+    return m;
+}
+
+namespace {
+
+// Per-thread buffers of the tiled SSIM: the ring of horizontally filtered rows,
+// the vertical pass output, the per-position SSIM/cs accumulators of the tile
+// and the scratch rows of the horizontal pass.
+struct SsimWorkspace {
+    std::vector<float> storage;
+    std::array<SsimRows, ssim_window> ring{};
+    SsimRows column{};
+    float* htmp = nullptr;
+    float* ssim_acc = nullptr;
+    float* cs_acc = nullptr;
+
+    explicit SsimWorkspace(int channels) {
+        const size_t n = static_cast<size_t>(ssim_tile_w) * static_cast<size_t>(channels);
+        const size_t in = static_cast<size_t>(ssim_tile_w + ssim_window - 1) * static_cast<size_t>(channels);
+        storage.assign((ssim_window + 1) * 5 * n + 5 * in + 2 * n, 0.0f);
+
+        float* p = storage.data();
+        auto take = [&p, n]() {
+            SsimRows r{p, p + n, p + 2 * n, p + 3 * n, p + 4 * n};
+            p += 5 * n;
+            return r;
+        };
+        for (SsimRows& r : ring) r = take();
+        column = take();
+        htmp = p;
+        ssim_acc = p + 5 * in;
+        cs_acc = ssim_acc + n;
+    }
+};
+
+} // namespace
+
+SsimResult ssim(const Image& a, const Image& b, int threads) {
+    check_same_shape(a, b, "ssim");
+    if (a.width < ssim_window || a.height < ssim_window) {
+        throw std::invalid_argument("ssim: images must be at least 11x11");
+    }
+    TRACE_SCOPE_ARGS("ssim", trace_cat::metrics, "width", a.width, "height", a.height);
+
+    const int ch = a.channels;
+    const int ow = a.width - ssim_window + 1;  // window positions per row
+    const int oh = a.height - ssim_window + 1;
+    const int tiles_x = (ow + ssim_tile_w - 1) / ssim_tile_w;
+    const int tiles_y = (oh + ssim_tile_h - 1) / ssim_tile_h;
+    const long long ntiles = static_cast<long long>(tiles_x) * tiles_y;
+
+    std::array<float, ssim_window> taps{};
+    const std::array<double, ssim_window> g = gaussian_window();
+    std::transform(g.begin(), g.end(), taps.begin(), [](double v) { return static_cast<float>(v); });
+    const float c1 = static_cast<float>((ssim_k1 * 255.0) * (ssim_k1 * 255.0));
+    const float c2 = static_cast<float>((ssim_k2 * 255.0) * (ssim_k2 * 255.0));
+
+    // sums[t * 2ch + c] = SSIM sum of channel c in tile t, followed by the cs sums.
+    std::vector<double> sums(static_cast<size_t>(ntiles) * 2 * static_cast<size_t>(ch), 0.0);
+
+    auto run_tile = [&](long long t, SsimWorkspace& ws) {
+        const int x0 = static_cast<int>(t % tiles_x) * ssim_tile_w;
+        const int y0 = static_cast<int>(t / tiles_x) * ssim_tile_h;
+        const int tw = std::min(ssim_tile_w, ow - x0);
+        const int th = std::min(ssim_tile_h, oh - y0);
+        const int pw = tw + ssim_window - 1; // source pixels per tile row
+        const int n = tw * ch;
+        const size_t col = static_cast<size_t>(x0) * static_cast<size_t>(ch);
+
+        auto filter_row = [&](int r) {
+            ssim_hpass_row(a.row_ptr(y0 + r) + col, b.row_ptr(y0 + r) + col, pw, ch,
+                           taps.data(), ws.htmp, ws.ring[static_cast<size_t>(r % ssim_window)]);
+        };
+
+        std::array<SsimRows, ssim_window> window{};
+        std::fill(ws.ssim_acc, ws.ssim_acc + n, 0.0f);
+        std::fill(ws.cs_acc, ws.cs_acc + n, 0.0f);
+
+        for (int r = 0; r < ssim_window - 1; ++r) filter_row(r);
+        for (int y = 0; y < th; ++y) {
+            filter_row(y + ssim_window - 1);
+            for (int k = 0; k < ssim_window; ++k) {
+                window[static_cast<size_t>(k)] = ws.ring[static_cast<size_t>((y + k) % ssim_window)];
+            }
+            ssim_vpass_row(window.data(), taps.data(), n, ws.column);
+            ssim_map_row(ws.column, n, c1, c2, ws.ssim_acc, ws.cs_acc);
+        }
+
+        // Per-position sums cover at most ssim_tile_h rows: float is exact enough.
+        double* ssim_sum = sums.data() + static_cast<size_t>(t) * 2 * static_cast<size_t>(ch);
+        double* cs_sum = ssim_sum + ch;
+        for (int i = 0; i < n; ++i) {
+            ssim_sum[i % ch] += ws.ssim_acc[i];
+            cs_sum[i % ch] += ws.cs_acc[i];
+        }
+    };
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel
+    {
+        SsimWorkspace ws(ch);
+        #pragma omp for schedule(dynamic)
+        for (long long t = 0; t < ntiles; ++t) run_tile(t, ws);
+    }
+#else
+    (void)threads;
+    SsimWorkspace ws(ch);
+    for (long long t = 0; t < ntiles; ++t) run_tile(t, ws);
+#endif
+
+    // Combined in tile order, independent of which thread ran which tile.
+    std::vector<double> ssim_total(static_cast<size_t>(ch), 0.0);
+    std::vector<double> cs_total(static_cast<size_t>(ch), 0.0);
+    for (long long t = 0; t < ntiles; ++t) {
+        const double* s = sums.data() + static_cast<size_t>(t) * 2 * static_cast<size_t>(ch);
+        for (int c = 0; c < ch; ++c) {
+            ssim_total[static_cast<size_t>(c)] += s[c];
+            cs_total[static_cast<size_t>(c)] += s[ch + c];
+        }
+    }
+
+    const double count = static_cast<double>(ow) * static_cast<double>(oh);
+    SsimResult r;
+    for (int c = 0; c < ch; ++c) {
+        r.channels.push_back(ssim_total[static_cast<size_t>(c)] / count);
+        r.cs.push_back(cs_total[static_cast<size_t>(c)] / count);
+    }
+    r.ssim = mean_color(r.channels);
+    return r;
+}
+
+SsimResult ssim_reference(const Image& a, const Image& b) {
+    check_same_shape(a, b, "ssim_reference");
+    if (a.width < ssim_window || a.height < ssim_window) {
+        throw std::invalid_argument("ssim_reference: images must be at least 11x11");
+    }
+
+    const std::array<double, ssim_window> g = gaussian_window();
+    const double c1 = (ssim_k1 * 255.0) * (ssim_k1 * 255.0);
+    const double c2 = (ssim_k2 * 255.0) * (ssim_k2 * 255.0);
+    const int ow = a.width - ssim_window + 1;
+    const int oh = a.height - ssim_window + 1;
+
+    SsimResult r;
+    for (int c = 0; c < a.channels; ++c) {
+        double ssim_sum = 0.0;
+        double cs_sum = 0.0;
+        for (int y = 0; y < oh; ++y) {
+            for (int x = 0; x < ow; ++x) {
+                double mx = 0.0, my = 0.0, xx = 0.0, yy = 0.0, xy = 0.0;
+                for (int j = 0; j < ssim_window; ++j) {
+                    for (int i = 0; i < ssim_window; ++i) {
+                        const double w = g[static_cast<size_t>(j)] * g[static_cast<size_t>(i)];
+                        const double va = a.at(x + i, y + j, c);
+                        const double vb = b.at(x + i, y + j, c);
+                        mx += w * va;
+                        my += w * vb;
+                        xx += w * va * va;
+                        yy += w * vb * vb;
+                        xy += w * va * vb;
+                    }
+                }
+                const double cs = (2.0 * (xy - mx * my) + c2) / ((xx - mx * mx) + (yy - my * my) + c2);
+                cs_sum += cs;
+                ssim_sum += cs * (2.0 * mx * my + c1) / (mx * mx + my * my + c1);
+            }
+        }
+        const double count = static_cast<double>(ow) * static_cast<double>(oh);
+        r.channels.push_back(ssim_sum / count);
+        r.cs.push_back(cs_sum / count);
+    }
+    r.ssim = mean_color(r.channels);
+    return r;
+}
+
+MsSsimResult ms_ssim(const Image& a, const Image& b, int threads) {
+    check_same_shape(a, b, "ms_ssim");
+    if (a.width < ssim_window || a.height < ssim_window) {
+        throw std::invalid_argument("ms_ssim: images must be at least 11x11");
+    }
+    TRACE_SCOPE("ms_ssim", trace_cat::metrics);
+
+    MsSsimResult r;
+    r.scales = 1;
+    for (int w = a.width / 2, h = a.height / 2;
+         r.scales < static_cast<int>(ms_ssim_weights.size()) && w >= ssim_window && h >= ssim_window;
+         w /= 2, h /= 2) {
+        r.scales++;
+    }
+    double weight_sum = 0.0;
+    for (int s = 0; s < r.scales; ++s) weight_sum += ms_ssim_weights[static_cast<size_t>(s)];
+
+    r.channels.assign(static_cast<size_t>(a.channels), 1.0);
+    Image da, db; // current scale, once below full resolution
+    const Image* pa = &a;
+    const Image* pb = &b;
+    for (int s = 0; s < r.scales; ++s) {
+        const SsimResult level = ssim(*pa, *pb, threads);
+        const bool last = (s == r.scales - 1);
+        const double w = ms_ssim_weights[static_cast<size_t>(s)] / weight_sum;
+        for (size_t c = 0; c < r.channels.size(); ++c) {
+            const double term = last ? level.channels[c] : level.cs[c];
+            r.channels[c] *= std::pow(std::max(term, 0.0), w);
+        }
+        if (last) break;
+
+        Image na = resize_omp(*pa, pa->width / 2, pa->height / 2, ResizeMethod::Bilinear, threads);
+        Image nb = resize_omp(*pb, pb->width / 2, pb->height / 2, ResizeMethod::Bilinear, threads);
+        da = std::move(na);
+        db = std::move(nb);
+        pa = &da;
+        pb = &db;
+    }
+    r.ms_ssim = mean_color(r.channels);
+    return r;
+}
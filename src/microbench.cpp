@@ -0,0 +1,394 @@
+// microbench.cpp
+// Created by Francesco on 17/10/2026.
+//
+// resize_microbench: kernel-level microbenchmarks, built as a separate target.
+// Each row kernel from kernels.hpp runs on fixed-size row buffers (hot in L1/L2)
+// so its cost can be studied without whole-image effects such as memory
+// bandwidth, page faults or OpenMP scheduling. For every kernel x width x
+// channels the best of several timed batches is reported as ns/pixel,
+// cycles/pixel and GB/s of bytes touched.
+//
+// The resampling kernels (hpass, vpass, bilinear, nearest) run the active x86-64
+// level (dispatch.hpp) or, with --isa, each of the listed levels side by side.
+//
+// Cycles come from perf_event_open when available, otherwise from the x86 TSC
+// (reference cycles, not core cycles), otherwise they are reported as -1.
+#include "dispatch.hpp"
+#include "kernels.hpp"
+#include "metadata.hpp"
+#include "perf_counters.hpp"
+#include "results.hpp"
+#include "synthetic.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define HAVE_RDTSC 1
+#else
+  #define HAVE_RDTSC 0
+#endif
+
+namespace {
+
+struct MicroOptions {
+    std::vector<std::string> kernels = {"hpass", "vpass", "bilinear", "nearest", "rgba_to_rgb", "compare", "absdiff", "sqdiff",
+                                         "ssim_hpass", "ssim_vpass", "ssim_map", "hash"};
+    std::vector<int> widths = {64, 256, 1024, 4096, 16384};
+    std::vector<int> channels = {1, 3, 4};
+    double ratio = 1.5;   // input width / output width for the resampling kernels
+    double min_ms = 20.0; // minimum duration of one timed batch
+    int batches = 7;
+    std::vector<IsaLevel> isa_levels; // levels of the resampling kernels; empty = the active one
+    std::string out_path;
+};
+
+struct KernelCase {
+    std::string name;
+    int width = 0;          // output pixels per call
+    int channels = 0;
+    double bytes = 0.0;     // bytes read + written per call
+    std::function<void()> run;
+    std::string isa = "scalar";
+};
+
+struct MicroResult {
+    double ns_per_px = 0.0;
+    double cycles_per_px = -1.0;
+    double gbs = 0.0;
+    long long reps = 0;
+};
+
+volatile std::uint64_t g_sink = 0;
+
+const char* cycle_source(const PerfCounterSet& perf) {
+    if (perf.available()) return "perf";
+    return HAVE_RDTSC ? "tsc" : "none";
+}
+
+MicroResult measure(const KernelCase& k, const MicroOptions& opt, PerfCounterSet& perf) {
+    using clock = std::chrono::steady_clock;
+
+    // Calibrate: double the repetition count until one batch lasts min_ms.
+    long long reps = 1;
+    for (;;) {
+        const auto t0 = clock::now();
+        for (long long r = 0; r < reps; ++r) k.run();
+        const double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        if (ms >= opt.min_ms || reps >= (1ll << 40)) break;
+        reps *= (ms < opt.min_ms / 16.0) ? 8 : 2;
+    }
+
+    double best_ns = 0.0;
+    double best_cycles = -1.0;
+    for (int b = 0; b < opt.batches; ++b) {
+        if (perf.available()) { perf.reset(); perf.start(); }
+#if HAVE_RDTSC
+        const std::uint64_t c0 = __rdtsc();
+#endif
+        const auto t0 = clock::now();
+        for (long long r = 0; r < reps; ++r) k.run();
+        const double ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        double cycles = -1.0;
+#if HAVE_RDTSC
+        cycles = static_cast<double>(__rdtsc() - c0);
+#endif
+        if (perf.available()) {
+            perf.stop();
+            cycles = static_cast<double>(perf.read().cycles);
+        }
+
+        if (b == 0 || ns < best_ns) {
+            best_ns = ns;
+            best_cycles = cycles;
+        }
+    }
+
+    const double px = static_cast<double>(reps) * static_cast<double>(k.width);
+    MicroResult r;
+    r.reps = reps;
+    r.ns_per_px = best_ns / px;
+    r.cycles_per_px = (best_cycles >= 0.0) ? best_cycles / px : -1.0;
+    r.gbs = (static_cast<double>(reps) * k.bytes) / best_ns; // bytes/ns == GB/s
+    return r;
+}
+
+// Buffers for one (width, channels) point; owned here so the cases can capture them.
+struct RowBuffers {
+    Image src;                  // two input rows, white noise
+    ColumnMap nearest_map;
+    ColumnMap bilinear_map;
+    std::vector<float> h0, h1;  // horizontal-pass output rows
+    std::vector<std::uint8_t> dst;
+    std::vector<std::uint8_t> rgb;
+    std::vector<std::uint8_t> other; // second operand of compare
+    std::vector<float> ssim;         // window rows + output row of the SSIM moments, scratch
+    std::array<SsimRows, ssim_window + 1> ssim_rows{};
+    std::vector<std::uint64_t> hash_keys;
+};
+
+std::vector<KernelCase> make_cases(RowBuffers& b, int w, int c, const MicroOptions& opt) {
+    const int in_w = std::max(1, static_cast<int>(static_cast<double>(w) * opt.ratio + 0.5));
+    const size_t n = static_cast<size_t>(w) * static_cast<size_t>(c);
+
+    // Wide enough for the resampling kernels and for the ssim_window - 1 extra pixels of ssim_hpass.
+    b.src = generate_synthetic(std::max(in_w, w + ssim_window - 1), 2, c, SyntheticPattern::Noise, 1);
+    b.nearest_map = make_column_map(in_w, w, ResizeMethod::Nearest);
+    b.bilinear_map = make_column_map(in_w, w, ResizeMethod::Bilinear);
+    b.h0.assign(n, 0.0f);
+    b.h1.assign(n, 0.0f);
+    b.dst.assign(n, 0);
+    b.rgb.assign(static_cast<size_t>(w) * 3u, 0);
+    b.other.assign(b.src.row_ptr(1), b.src.row_ptr(1) + n);
+
+    hpass_row(b.src.row_ptr(0), b.h0.data(), b.bilinear_map, w, c);
+    hpass_row(b.src.row_ptr(1), b.h1.data(), b.bilinear_map, w, c);
+
+    // SSIM kernels: w window positions read w + ssim_window - 1 input pixels.
+    const size_t ssim_in = static_cast<size_t>(w + ssim_window - 1) * static_cast<size_t>(c);
+    b.ssim.assign((ssim_window + 1) * 5 * n + 5 * ssim_in + 2 * n, 1.0f);
+    for (size_t r = 0; r < b.ssim_rows.size(); ++r) {
+        float* p = b.ssim.data() + r * 5 * n;
+        b.ssim_rows[r] = {p, p + n, p + 2 * n, p + 3 * n, p + 4 * n};
+    }
+    float* ssim_tmp = b.ssim.data() + (ssim_window + 1) * 5 * n;
+    float* ssim_acc = ssim_tmp + 5 * ssim_in;
+    static const std::array<float, ssim_window> taps = [] {
+        std::array<float, ssim_window> t{};
+        t.fill(1.0f / ssim_window);
+        return t;
+    }();
+
+    const double in_row = static_cast<double>(in_w) * c;
+    const double out_row = static_cast<double>(n);
+    const double map_bytes = static_cast<double>(w) * (2 * sizeof(int) + sizeof(float));
+
+    std::vector<KernelCase> cases;
+    std::vector<const KernelTable*> tables;
+    for (IsaLevel l : opt.isa_levels) tables.push_back(kernel_table(l));
+    if (tables.empty()) tables.push_back(&active_kernels());
+    for (const KernelTable* t : tables) {
+        const std::string isa = isa_level_name(t->level);
+        const ColumnMap& bm = b.bilinear_map;
+        cases.push_back({"hpass", w, c, in_row + out_row * sizeof(float) + map_bytes, [&b, &bm, t, w, c] {
+            t->hpass_row(b.src.row_ptr(0), b.h0.data(), bm.x0.data(), bm.x1.data(), bm.wx.data(), w, c);
+        }, isa});
+        cases.push_back({"vpass", w, c, 2.0 * out_row * sizeof(float) + out_row, [&b, t, n] {
+            t->vpass_row(b.h0.data(), b.h1.data(), b.dst.data(), 0.375f, static_cast<int>(n));
+        }, isa});
+        cases.push_back({"bilinear", w, c, 2.0 * in_row + out_row + map_bytes, [&b, &bm, t, w, c] {
+            t->bilinear_row(b.src.row_ptr(0), b.src.row_ptr(1), b.dst.data(), bm.x0.data(), bm.x1.data(),
+                            bm.wx.data(), 0.375f, w, c);
+        }, isa});
+        cases.push_back({"nearest", w, c, 2.0 * out_row + static_cast<double>(w) * sizeof(int), [&b, t, w, c] {
+            t->nearest_row(b.src.row_ptr(0), b.dst.data(), b.nearest_map.x0.data(), w, c);
+        }, isa});
+    }
+    if (c == 4) {
+        cases.push_back({"rgba_to_rgb", w, c, static_cast<double>(w) * 7.0, [&b, w] {
+            rgba_to_rgb_row(b.src.row_ptr(0), b.rgb.data(), static_cast<size_t>(w));
+        }});
+    }
+    cases.push_back({"compare", w, c, 2.0 * out_row, [&b, n] {
+        int max_abs = 0;
+        std::uint64_t nonzero = 0;
+        compare_row(b.src.row_ptr(0), b.other.data(), n, max_abs, nonzero);
+        g_sink = g_sink + nonzero + static_cast<std::uint64_t>(max_abs);
+    }});
+    cases.push_back({"absdiff", w, c, 2.0 * out_row, [&b, n] {
+        AbsDiffAccum acc;
+        std::uint64_t hist[256] = {};
+        absdiff_stats(b.src.row_ptr(0), b.other.data(), n, acc, hist);
+        g_sink = g_sink + acc.nonzero + acc.sum + hist[1];
+    }});
+#if defined(__SSE2__)
+    cases.back().isa = "sse2";
+#endif
+    cases.push_back({"sqdiff", w, c, 2.0 * out_row, [&b, n] {
+        g_sink = g_sink + sqdiff_sum(b.src.row_ptr(0), b.other.data(), n);
+    }});
+#if defined(__SSE2__)
+    cases.back().isa = "sse2";
+#endif
+    cases.push_back({"ssim_hpass", w, c, 2.0 * static_cast<double>(ssim_in) + 5.0 * out_row * sizeof(float),
+                     [&b, w, c, ssim_tmp] {
+        ssim_hpass_row(b.src.row_ptr(0), b.src.row_ptr(1), w + ssim_window - 1, c, taps.data(), ssim_tmp,
+                       b.ssim_rows[0]);
+    }});
+    cases.push_back({"ssim_vpass", w, c, (ssim_window + 1) * 5.0 * out_row * sizeof(float), [&b, n] {
+        ssim_vpass_row(b.ssim_rows.data(), taps.data(), static_cast<int>(n), b.ssim_rows[ssim_window]);
+    }});
+#if defined(__SSE2__)
+    cases[cases.size() - 2].isa = "sse2";
+    cases.back().isa = "sse2";
+#endif
+    cases.push_back({"ssim_map", w, c, 9.0 * out_row * sizeof(float), [&b, n, ssim_acc] {
+        ssim_map_row(b.ssim_rows[0], static_cast<int>(n), 6.5f, 58.5f, ssim_acc, ssim_acc + n);
+    }});
+
+    if (n >= hash_stripe_bytes) {
+        // Stripes of the row; keys as for one row-sized block.
+        const std::size_t stripes = n / hash_stripe_bytes;
+        b.hash_keys.assign(stripes + hash_lanes - 1, 0x9E3779B97F4A7C15ull);
+        cases.push_back({"hash", w, c, static_cast<double>(stripes * hash_stripe_bytes), [&b, stripes] {
+            std::uint64_t acc[hash_lanes] = {};
+            hash_accumulate(acc, b.src.row_ptr(0), stripes, b.hash_keys.data());
+            g_sink = g_sink + acc[0];
+        }});
+#if defined(__SSE2__)
+        cases.back().isa = "sse2";
+#endif
+    }
+
+    std::erase_if(cases, [&](const KernelCase& k) {
+        return std::find(opt.kernels.begin(), opt.kernels.end(), k.name) == opt.kernels.end();
+    });
+    return cases;
+}
+
+void print_usage() {
+    std::cout <<
+        "Usage:\n"
+        "  resize_microbench [--kernels k1,k2,...] [--widths w1,w2,...] [--channels c1,c2,...]\n"
+        "                    [--ratio R] [--min-ms N] [--batches N] [--isa l1,l2,...|all]\n"
+        "                    [--out results.csv|results.json]\n\n"
+        "Kernels: hpass, vpass, bilinear, nearest, rgba_to_rgb (4 channels only), compare,\n"
+        "         absdiff (compare plus SAD and histogram, as used by compare_images),\n"
+        "         sqdiff (sum of squared differences, PSNR), ssim_hpass, ssim_vpass, ssim_map\n"
+        "         (the three steps of the tiled SSIM in metrics.cpp), hash (content-hash stripes,\n"
+        "         whole 64-byte stripes of the row)\n"
+        "Widths are output pixels per row; resampling kernels read ratio * width input pixels.\n"
+        "--isa runs the resampling kernels once per x86-64 level (baseline, v2, v3, v4; all = every level\n"
+        "this CPU runs) instead of only the active one (best supported, or RESIZER_ISA).\n";
+}
+
+MicroOptions parse_args(int argc, char** argv) {
+    MicroOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + a);
+            return argv[++i];
+        };
+
+        if (a == "--kernels") {
+            opt.kernels = split(to_lower(value()), ',');
+        } else if (a == "--widths") {
+            opt.widths = parse_int_list(value(), "widths");
+        } else if (a == "--channels") {
+            opt.channels = parse_int_list(value(), "channels");
+        } else if (a == "--ratio") {
+            const std::string v = value();
+            try { opt.ratio = std::stod(v); } catch (...) { throw std::invalid_argument("Invalid ratio: " + v); }
+            if (!(opt.ratio > 0.0)) throw std::invalid_argument("ratio must be > 0");
+        } else if (a == "--min-ms") {
+            opt.min_ms = parse_int(value(), "min-ms");
+        } else if (a == "--batches") {
+            opt.batches = parse_int(value(), "batches");
+        } else if (a == "--isa") {
+            const std::string v = to_lower(value());
+            opt.isa_levels.clear();
+            if (v == "all") {
+                for (IsaLevel l : compiled_isa_levels()) {
+                    if (kernel_table(l) != nullptr) opt.isa_levels.push_back(l);
+                }
+            } else {
+                for (const std::string& name : split(v, ',')) {
+                    const IsaLevel l = parse_isa_level(name);
+                    if (kernel_table(l) == nullptr) {
+                        throw std::invalid_argument(std::string("ISA level ") + isa_level_name(l) + " is not available here");
+                    }
+                    opt.isa_levels.push_back(l);
+                }
+            }
+        } else if (a == "--out") {
+            opt.out_path = value();
+        } else {
+            throw std::invalid_argument("Unknown option: " + a);
+        }
+    }
+
+    for (int w : opt.widths) if (w <= 0) throw std::invalid_argument("widths must be > 0");
+    for (int c : opt.channels) {
+        if (c != 1 && c != 3 && c != 4) throw std::invalid_argument("channels must be 1, 3 or 4");
+    }
+    if (opt.batches <= 0) throw std::invalid_argument("batches must be > 0");
+    return opt;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 2 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+            print_usage();
+            return 0;
+        }
+        const MicroOptions opt = parse_args(argc, argv);
+        std::string isa_levels;
+        for (IsaLevel l : opt.isa_levels) {
+            if (!isa_levels.empty()) isa_levels += ',';
+            isa_levels += isa_level_name(l);
+        }
+        set_run_parameters({
+            {"command", command_line(argc, argv)},
+            {"mode", std::string("microbench")},
+            {"ratio", opt.ratio},
+            {"min_ms", opt.min_ms},
+            {"batches", static_cast<std::int64_t>(opt.batches)},
+            {"isa", isa_levels.empty() ? std::string("auto") : isa_levels},
+        });
+
+        PerfCounterSet perf(1);
+        const char* cycles_from = cycle_source(perf);
+
+        std::unique_ptr<ResultWriter> writer;
+        if (!opt.out_path.empty()) {
+            writer = std::make_unique<ResultWriter>(opt.out_path, std::vector<std::string>{
+                "kernel", "isa", "width", "channels", "ratio", "reps",
+                "ns_per_px", "cycles_per_px", "cycles_source", "gb_per_s"});
+        }
+
+        std::printf("cycles: %s\n", cycles_from);
+        std::printf("%-12s %-9s %7s %3s %10s %10s %9s\n",
+                    "kernel", "isa", "width", "ch", "ns/px", "cyc/px", "GB/s");
+
+        for (int c : opt.channels) {
+            for (int w : opt.widths) {
+                RowBuffers buffers;
+                for (const KernelCase& k : make_cases(buffers, w, c, opt)) {
+                    const MicroResult r = measure(k, opt, perf);
+                    std::printf("%-12s %-9s %7d %3d %10.3f %10.2f %9.2f\n",
+                                k.name.c_str(), k.isa.c_str(), w, c, r.ns_per_px, r.cycles_per_px, r.gbs);
+
+                    if (writer) {
+                        writer->add_row({k.name, k.isa,
+                                         static_cast<std::int64_t>(w), static_cast<std::int64_t>(c),
+                                         opt.ratio, static_cast<std::int64_t>(r.reps),
+                                         r.ns_per_px, r.cycles_per_px, std::string(cycles_from), r.gbs});
+                    }
+                }
+            }
+        }
+
+        if (writer) {
+            writer->flush();
+            std::cout << "Results written to: " << writer->path() << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,180 @@
+// perf_counters.cpp
+// Created by Francesco on 17/10/2026.
+//
+// perf_event_open backend for PerfCounterSet (Linux only; a stub elsewhere).
+#include "perf_counters.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+  #include <cerrno>
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
+
+enum Event { Cycles, Instructions, L1dMiss, LlcMiss, BranchMiss, DtlbMiss, EventCount };
+
+#if defined(__linux__)
+struct EventDesc {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+constexpr std::uint64_t cache_config(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+const EventDesc kEvents[EventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+};
+
+int open_counter(const EventDesc& ev) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = ev.type;
+    attr.config = ev.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1; // allowed with perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // pid = 0, cpu = -1: count the calling thread on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+} // namespace
+
+struct PerfCounterSet::Impl {
+    std::vector<int> fds[EventCount]; // one fd per thread per event
+    std::string status = "ok";
+};
+
+PerfCounterSet::PerfCounterSet(int threads) : impl_(std::make_unique<Impl>()) {
+#if defined(__linux__)
+    std::mutex mu;
+    int first_errno = 0;
+
+    auto open_for_this_thread = [&]() {
+        for (int e = 0; e < EventCount; ++e) {
+            const int fd = open_counter(kEvents[e]);
+            std::lock_guard<std::mutex> lock(mu);
+            if (fd >= 0) impl_->fds[e].push_back(fd);
+            else if (first_errno == 0) first_errno = errno;
+        }
+    };
+
+  #if HAVE_OPENMP
+    if (threads != 1) {
+        const int team = (threads > 0) ? threads : omp_get_max_threads();
+        #pragma omp parallel num_threads(team)
+        open_for_this_thread();
+    } else {
+        open_for_this_thread();
+    }
+  #else
+    (void)threads;
+    open_for_this_thread();
+  #endif
+
+    if (!available()) {
+        impl_->status = std::string("perf_event_open: ") + std::strerror(first_errno ? first_errno : ENOSYS);
+    } else if (first_errno != 0) {
+        impl_->status = std::string("partial: ") + std::strerror(first_errno);
+    }
+#else
+    (void)threads;
+    impl_->status = "perf counters require Linux";
+#endif
+}
+
+PerfCounterSet::~PerfCounterSet() {
+#if defined(__linux__)
+    for (auto& v : impl_->fds) {
+        for (int fd : v) close(fd);
+    }
+#endif
+}
+
+bool PerfCounterSet::available() const noexcept {
+    for (const auto& v : impl_->fds) {
+        if (!v.empty()) return true;
+    }
+    return false;
+}
+
+const std::string& PerfCounterSet::status() const noexcept {
+    return impl_->status;
+}
+
+void PerfCounterSet::reset() {
+#if defined(__linux__)
+    for (auto& v : impl_->fds) {
+        for (int fd : v) ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    }
+#endif
+}
+
+void PerfCounterSet::start() {
+#if defined(__linux__)
+    for (auto& v : impl_->fds) {
+        for (int fd : v) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounterSet::stop() {
+#if defined(__linux__)
+    for (auto& v : impl_->fds) {
+        for (int fd : v) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+}
+
+PerfCounters PerfCounterSet::read() const {
+    std::int64_t totals[EventCount];
+    for (auto& t : totals) t = -1;
+
+#if defined(__linux__)
+    for (int e = 0; e < EventCount; ++e) {
+        if (impl_->fds[e].empty()) continue;
+
+        double sum = 0.0;
+        bool ok = false;
+        for (int fd : impl_->fds[e]) {
+            std::uint64_t buf[3] = {0, 0, 0}; // value, time_enabled, time_running
+            if (::read(fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) continue;
+            ok = true;
+            if (buf[2] == 0) continue; // never scheduled on the PMU
+            // Scale up when the kernel multiplexed this counter.
+            sum += static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+        }
+        if (ok) totals[e] = static_cast<std::int64_t>(sum + 0.5);
+    }
+#endif
+
+    PerfCounters c;
+    c.cycles        = totals[Cycles];
+    c.instructions  = totals[Instructions];
+    c.l1d_misses    = totals[L1dMiss];
+    c.llc_misses    = totals[LlcMiss];
+    c.branch_misses = totals[BranchMiss];
+    c.dtlb_misses   = totals[DtlbMiss];
+    return c;
+}
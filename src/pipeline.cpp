@@ -0,0 +1,211 @@
+// pipeline.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the end-to-end pipeline benchmark.
+// The input file is re-read every run, so the read phase measures the page
+// cache path (warm file), not the storage device.
+#include "pipeline.hpp"
+
+#include "config.hpp"
+#include "io.hpp"
+#include "results.hpp"
+#include "stats.hpp"
+#include "synthetic.hpp"
+#include "util.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double ms_between(clock_type::time_point a, clock_type::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+PhaseStats phase_stats(const std::vector<double>& v, double total_ms) {
+    PhaseStats s;
+    if (v.empty()) return s;
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    s.mean_ms = sum / static_cast<double>(v.size());
+    s.median_ms = median(v);
+    s.p90_ms = percentile(v, 90.0);
+    s.p99_ms = percentile(v, 99.0);
+    s.share = (total_ms > 0.0) ? sum / total_ms : 0.0;
+    return s;
+}
+
+const char* codec_extension(Codec c) {
+    return (c == Codec::Jpg) ? ".jpg" : ".png";
+}
+
+} // namespace
+
+const char* pipeline_phase_name(PipelinePhase p) {
+    switch (p) {
+        case PipelinePhase::Read:    return "read";
+        case PipelinePhase::Decode:  return "decode";
+        case PipelinePhase::Resize:  return "resize";
+        case PipelinePhase::Convert: return "convert";
+        case PipelinePhase::Encode:  return "encode";
+        case PipelinePhase::Write:   return "write";
+    }
+    return "unknown";
+}
+
+CodecSetting parse_codec_setting(const std::string& s) {
+    const std::vector<std::string> parts = split(to_lower(s), ':');
+    if (parts.empty() || parts.size() > 2) throw std::invalid_argument("Invalid codec setting: " + s);
+
+    CodecSetting c;
+    if (parts[0] == "png") {
+        c.codec = Codec::Png;
+        c.level = cfg::default_png_compression;
+    } else if (parts[0] == "jpg" || parts[0] == "jpeg") {
+        c.codec = Codec::Jpg;
+        c.level = cfg::default_jpg_quality;
+    } else {
+        throw std::invalid_argument("Unknown codec: " + parts[0]);
+    }
+
+    if (parts.size() == 2) c.level = parse_int(parts[1], "codec level");
+    if (c.codec == Codec::Png && (c.level < 0 || c.level > 9)) {
+        throw std::invalid_argument("PNG compression level must be 0..9: " + s);
+    }
+    if (c.codec == Codec::Jpg && (c.level < 1 || c.level > 100)) {
+        throw std::invalid_argument("JPG quality must be 1..100: " + s);
+    }
+    return c;
+}
+
+std::string codec_setting_name(const CodecSetting& c) {
+    return std::string(c.codec == Codec::Jpg ? "jpg:" : "png:") + std::to_string(c.level);
+}
+
+std::vector<PipelineResult> run_pipeline_bench(const PipelineSpec& spec, std::ostream& log) {
+    if (spec.out_w <= 0 || spec.out_h <= 0) throw std::invalid_argument("pipeline: output size must be > 0");
+    if (spec.warmup < 0 || spec.runs <= 0) throw std::invalid_argument("pipeline: warmup must be >= 0 and runs > 0");
+    if (spec.codecs.empty()) throw std::invalid_argument("pipeline: no codec settings");
+    if (spec.output_prefix.empty()) throw std::invalid_argument("pipeline: empty output prefix");
+
+    // Synthetic inputs have no file to read: encode them once and use that file.
+    std::string input_path = spec.input_path;
+    if (is_synthetic_spec(input_path)) {
+        input_path = spec.output_prefix + "_input.png";
+        save_png(load_image(spec.input_path, 0), input_path, cfg::default_png_compression);
+        log << "Synthetic input encoded to " << input_path << "\n";
+    }
+
+    std::vector<PipelineResult> results;
+    for (const CodecSetting& codec : spec.codecs) {
+        const std::string out_path = spec.output_prefix + codec_extension(codec.codec);
+        log << "Pipeline " << codec_setting_name(codec) << " -> " << out_path << " ... " << std::flush;
+
+        PipelineResult res;
+        res.codec = codec;
+        for (auto& v : res.samples) v.reserve(static_cast<size_t>(spec.runs));
+        res.wall_ms.reserve(static_cast<size_t>(spec.runs));
+
+        for (int it = 0; it < spec.warmup + spec.runs; ++it) {
+            std::array<clock_type::time_point, pipeline_phase_count + 1> t;
+
+            t[0] = clock_type::now();
+            const std::vector<std::uint8_t> file = read_file(input_path);
+            t[1] = clock_type::now();
+            const Image img = decode_image(file, 0, input_path);
+            t[2] = clock_type::now();
+            Image out = resize(img, spec.out_w, spec.out_h, spec.method, spec.backend, spec.threads);
+            t[3] = clock_type::now();
+            if (codec.codec == Codec::Jpg && out.channels == 4) out = drop_alpha(out);
+            t[4] = clock_type::now();
+            const std::vector<std::uint8_t> encoded = (codec.codec == Codec::Jpg)
+                ? encode_jpg(out, codec.level) : encode_png(out, codec.level);
+            t[5] = clock_type::now();
+            write_file(out_path, encoded);
+            t[6] = clock_type::now();
+
+            if (it < spec.warmup) continue;
+            for (int p = 0; p < pipeline_phase_count; ++p) {
+                res.samples[static_cast<size_t>(p)].push_back(ms_between(t[p], t[p + 1]));
+            }
+            res.wall_ms.push_back(ms_between(t[0], t[pipeline_phase_count]));
+
+            res.in_w = img.width;
+            res.in_h = img.height;
+            res.channels = img.channels;
+            res.input_bytes = file.size();
+            res.output_bytes = encoded.size();
+        }
+
+        double total = 0.0;
+        for (double x : res.wall_ms) total += x;
+        for (int p = 0; p < pipeline_phase_count; ++p) {
+            res.phases[static_cast<size_t>(p)] = phase_stats(res.samples[static_cast<size_t>(p)], total);
+        }
+        res.wall = phase_stats(res.wall_ms, total);
+
+        log << "median " << res.wall.median_ms << " ms\n";
+        results.push_back(std::move(res));
+    }
+    return results;
+}
+
+void print_pipeline_summary(const std::vector<PipelineResult>& results, std::ostream& os) {
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+
+    for (const PipelineResult& r : results) {
+        os << "\nPIPELINE " << codec_setting_name(r.codec)
+           << "  (" << r.in_w << "x" << r.in_h << "x" << r.channels << ", "
+           << r.input_bytes << " B in, " << r.output_bytes << " B out, "
+           << r.wall_ms.size() << " runs)\n"
+           << "  phase       median_ms     p90_ms     p99_ms   share\n";
+
+        auto line = [&](const char* name, const PhaseStats& s) {
+            os << "  " << std::left << std::setw(8) << name << std::right
+               << std::fixed << std::setprecision(3)
+               << "  " << std::setw(11) << s.median_ms
+               << "  " << std::setw(9) << s.p90_ms
+               << "  " << std::setw(9) << s.p99_ms
+               << "  " << std::setw(5) << std::setprecision(1) << 100.0 * s.share << "%\n";
+            os.flags(flags);
+        };
+        for (int p = 0; p < pipeline_phase_count; ++p) {
+            line(pipeline_phase_name(static_cast<PipelinePhase>(p)), r.phases[static_cast<size_t>(p)]);
+        }
+        line("total", r.wall);
+    }
+    os.precision(prec);
+}
+
+void write_pipeline_results(const std::vector<PipelineResult>& results, const PipelineSpec& spec,
+                            const std::string& path) {
+    ResultWriter writer(path, {
+        "codec", "phase", "backend", "method", "threads", "in_w", "in_h", "out_w", "out_h", "channels",
+        "input_bytes", "output_bytes", "runs", "mean_ms", "median_ms", "p90_ms", "p99_ms", "share"
+    });
+
+    for (const PipelineResult& r : results) {
+        auto add = [&](const char* phase, const PhaseStats& s) {
+            writer.add_row({
+                codec_setting_name(r.codec), std::string(phase),
+                std::string(backend_name(spec.backend)), std::string(method_name(spec.method)),
+                static_cast<std::int64_t>(spec.threads),
+                static_cast<std::int64_t>(r.in_w), static_cast<std::int64_t>(r.in_h),
+                static_cast<std::int64_t>(spec.out_w), static_cast<std::int64_t>(spec.out_h),
+                static_cast<std::int64_t>(r.channels),
+                static_cast<std::int64_t>(r.input_bytes), static_cast<std::int64_t>(r.output_bytes),
+                static_cast<std::int64_t>(r.wall_ms.size()),
+                s.mean_ms, s.median_ms, s.p90_ms, s.p99_ms, s.share
+            });
+        };
+        for (int p = 0; p < pipeline_phase_count; ++p) {
+            add(pipeline_phase_name(static_cast<PipelinePhase>(p)), r.phases[static_cast<size_t>(p)]);
+        }
+        add("total", r.wall);
+    }
+    writer.flush();
+}
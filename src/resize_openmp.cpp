@@ -6,113 +6,193 @@
 // data parallelism over image rows using OpenMP, enabling performance
 // comparisons between sequential and parallel executions.
 #include "resize.hpp"
+#include "affinity.hpp"
+#include "kernels.hpp"
+#include "trace.hpp"
 
-#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #if HAVE_OPENMP
   #include <omp.h>
 #endif
 
-static inline float map_coord(float out_coord, float in_size, float out_size) {
-    return (out_coord + 0.5f) * (in_size / out_size) - 0.5f;
-}
-
-static Image resize_nearest_omp(const Image& in, int out_w, int out_h, int threads) {
-    Image out(out_w, out_h, in.channels);
-
 #if HAVE_OPENMP
+// The row loops use schedule(runtime); this selects the actual policy for the call.
+static void apply_parallel_options(int threads, const ParallelOptions& popt) {
     if (threads > 0) omp_set_num_threads(threads);
 
-    #pragma omp parallel for schedule(static)
-    for (int y = 0; y < out_h; ++y) {
-        const float sy = map_coord(static_cast<float>(y), static_cast<float>(in.height), static_cast<float>(out_h));
-        int iy = static_cast<int>(std::lround(sy));
-        iy = clamp_int(iy, 0, in.height - 1);
+    omp_sched_t kind = omp_sched_static;
+    switch (popt.schedule) {
+        case OmpSchedule::Static:  kind = omp_sched_static;  break;
+        case OmpSchedule::Dynamic: kind = omp_sched_dynamic; break;
+        case OmpSchedule::Guided:  kind = omp_sched_guided;  break;
+    }
+    omp_set_schedule(kind, popt.chunk > 0 ? popt.chunk : 0);
+}
 
-        for (int x = 0; x < out_w; ++x) {
-            const float sx = map_coord(static_cast<float>(x), static_cast<float>(in.width), static_cast<float>(out_w));
-            int ix = static_cast<int>(std::lround(sx));
-            ix = clamp_int(ix, 0, in.width - 1);
+// Work-shared row loop. With popt.cpus each thread pins itself on entry (a
+// thread_local no-op once it is on its CPU, so only the first call pays for the
+// syscalls and no extra parallel region is opened); without, threads left pinned
+// by an earlier call get their original mask back. When tracing, each thread
+// records the row bands it processed and, separately, its wait at the closing
+// barrier; with accounting the same split is summed into popt.accounting.
+template <class RowFn>
+static void parallel_rows(int out_h, const char* trace_name, const ParallelOptions& popt, RowFn&& row) {
+    using clock = std::chrono::steady_clock;
+    (void)trace_name;
+    WorkAccounting* acct = popt.accounting;
+    const std::vector<int>& cpus = popt.cpus;
+    const bool traced = trace_enabled();
+    const bool split_wait = traced || acct != nullptr;
+
+    struct alignas(64) Slot {
+        double busy_ms = 0.0;
+        double wait_ms = 0.0;
+        std::int64_t rows = 0;
+        bool used = false;
+    };
+    std::vector<Slot> slots(acct ? static_cast<size_t>(omp_get_max_threads()) : 0);
+
+    #pragma omp parallel
+    {
+        const int tid = omp_get_thread_num();
+        if (!cpus.empty()) pin_current_thread(cpus[static_cast<size_t>(tid) % cpus.size()]);
+        else unpin_current_thread();
+        if (traced) trace_set_thread_name("omp " + std::to_string(tid));
+        TRACE_ROW_BANDS(bands, trace_name);
+
+        const clock::time_point t0 = acct ? clock::now() : clock::time_point{};
+        std::int64_t rows = 0;
+
+        #pragma omp for schedule(runtime) nowait
+        for (int y = 0; y < out_h; ++y) {
+            TRACE_ROW(bands, y);
+            row(y);
+            ++rows;
+        }
 
-            const std::uint8_t* src = in.row_ptr(iy) + (ix * in.channels);
-            std::uint8_t* dst = out.row_ptr(y) + (x * out.channels);
+        TRACE_ROW_FINISH(bands);
+        if (split_wait) {
+            const clock::time_point t1 = acct ? clock::now() : clock::time_point{};
+            {
+                TRACE_SCOPE("barrier wait", trace_cat::resize);
+                #pragma omp barrier
+            }
+            if (acct && static_cast<size_t>(tid) < slots.size()) {
+                Slot& s = slots[static_cast<size_t>(tid)];
+                s.busy_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+                s.wait_ms = std::chrono::duration<double, std::milli>(clock::now() - t1).count();
+                s.rows = rows;
+                s.used = true;
+            }
+        }
+    }
 
-            for (int c = 0; c < out.channels; ++c) dst[c] = src[c];
+    if (acct) {
+        for (size_t t = 0; t < slots.size(); ++t) {
+            if (!slots[t].used) continue;
+            if (acct->threads.size() <= t) acct->threads.resize(t + 1);
+            acct->threads[t].busy_ms += slots[t].busy_ms;
+            acct->threads[t].wait_ms += slots[t].wait_ms;
+            acct->threads[t].rows += slots[t].rows;
         }
+        ++acct->calls;
     }
+}
+#endif
+
+static void resize_nearest_omp(const Image& in, Image& out, int threads, const ParallelOptions& popt) {
+#if HAVE_OPENMP
+    const int out_w = out.width;
+    const int out_h = out.height;
+    apply_parallel_options(threads, popt);
+    const ColumnMap cm = make_column_map(in.width, out_w, ResizeMethod::Nearest);
+
+    parallel_rows(out_h, "nearest rows", popt, [&](int y) {
+        const RowTap t = row_tap(y, in.height, out_h, ResizeMethod::Nearest);
+        nearest_row(in.row_ptr(t.y0), out.row_ptr(y), cm, out_w, out.channels);
+    });
 #else
     (void)threads;
-    out = resize_seq(in, out_w, out_h, ResizeMethod::Nearest);
+    (void)popt;
+    resize_seq_into(in, out, ResizeMethod::Nearest);
 #endif
-
-    return out;
 }
 
-static Image resize_bilinear_omp(const Image& in, int out_w, int out_h, int threads) {
-    Image out(out_w, out_h, in.channels);
-
+static void resize_bilinear_omp(const Image& in, Image& out, int threads, const ParallelOptions& popt) {
 #if HAVE_OPENMP
-    if (threads > 0) omp_set_num_threads(threads);
-
-    #pragma omp parallel for schedule(static)
-    for (int y = 0; y < out_h; ++y) {
-        const float sy = map_coord(static_cast<float>(y), static_cast<float>(in.height), static_cast<float>(out_h));
-        const int y0 = clamp_int(static_cast<int>(std::floor(sy)), 0, in.height - 1);
-        const int y1 = clamp_int(y0 + 1, 0, in.height - 1);
-        const float wy = sy - static_cast<float>(y0);
-
-        const std::uint8_t* row0 = in.row_ptr(y0);
-        const std::uint8_t* row1 = in.row_ptr(y1);
-        std::uint8_t* dst_row = out.row_ptr(y);
-
-        for (int x = 0; x < out_w; ++x) {
-            const float sx = map_coord(static_cast<float>(x), static_cast<float>(in.width), static_cast<float>(out_w));
-            const int x0 = clamp_int(static_cast<int>(std::floor(sx)), 0, in.width - 1);
-            const int x1 = clamp_int(x0 + 1, 0, in.width - 1);
-            const float wx = sx - static_cast<float>(x0);
-
-            const std::uint8_t* p00 = row0 + (x0 * in.channels);
-            const std::uint8_t* p10 = row0 + (x1 * in.channels);
-            const std::uint8_t* p01 = row1 + (x0 * in.channels);
-            const std::uint8_t* p11 = row1 + (x1 * in.channels);
-
-            std::uint8_t* dst = dst_row + (x * out.channels);
-
-            for (int c = 0; c < out.channels; ++c) {
-                const float v00 = static_cast<float>(p00[c]);
-                const float v10 = static_cast<float>(p10[c]);
-                const float v01 = static_cast<float>(p01[c]);
-                const float v11 = static_cast<float>(p11[c]);
-
-                const float v0 = v00 + wx * (v10 - v00);
-                const float v1 = v01 + wx * (v11 - v01);
-                const float v  = v0  + wy * (v1  - v0);
-
-                dst[c] = clamp_u8(static_cast<int>(std::lround(v)));
-            }
-        }
-    }
+    const int out_w = out.width;
+    const int out_h = out.height;
+    apply_parallel_options(threads, popt);
+    const ColumnMap cm = make_column_map(in.width, out_w, ResizeMethod::Bilinear);
+
+    parallel_rows(out_h, "bilinear rows", popt, [&](int y) {
+        const RowTap t = row_tap(y, in.height, out_h, ResizeMethod::Bilinear);
+        bilinear_row(in.row_ptr(t.y0), in.row_ptr(t.y1), out.row_ptr(y), cm, t.wy, out_w, out.channels);
+    });
 #else
     (void)threads;
-    out = resize_seq(in, out_w, out_h, ResizeMethod::Bilinear);
+    (void)popt;
+    resize_seq_into(in, out, ResizeMethod::Bilinear);
 #endif
-
-    return out;
 }
 
 Image resize_omp(const Image& in, int out_w, int out_h, ResizeMethod method, int threads) {
+    return resize_omp(in, out_w, out_h, method, threads, ParallelOptions{});
+}
+
+Image resize_omp(const Image& in, int out_w, int out_h, ResizeMethod method, int threads,
+                 const ParallelOptions& popt) {
     if (in.empty()) throw std::invalid_argument("resize_omp: input image is empty");
     if (out_w <= 0 || out_h <= 0) throw std::invalid_argument("resize_omp: output size must be > 0");
 
+    Image out(out_w, out_h, in.channels);
+    resize_omp_into(in, out, method, threads, popt);
+    return out;
+}
+
+void resize_omp_into(const Image& in, Image& out, ResizeMethod method, int threads,
+                     const ParallelOptions& popt) {
+    if (in.empty()) throw std::invalid_argument("resize_omp: input image is empty");
+    if (out.empty()) throw std::invalid_argument("resize_omp: output image is empty");
+    if (out.channels != in.channels) throw std::invalid_argument("resize_omp: output channels must match input");
+
 #if !HAVE_OPENMP
     // compila comunque, ma “degrada” a sequenziale
-    return resize_seq(in, out_w, out_h, method);
+    (void)threads;
+    (void)popt;
+    resize_seq_into(in, out, method);
 #else
+    TRACE_SCOPE_ARGS("resize_omp", trace_cat::resize, "out_w", out.width, "out_h", out.height);
     switch (method) {
-        case ResizeMethod::Nearest:  return resize_nearest_omp(in, out_w, out_h, threads);
-        case ResizeMethod::Bilinear: return resize_bilinear_omp(in, out_w, out_h, threads);
+        case ResizeMethod::Nearest:  resize_nearest_omp(in, out, threads, popt); return;
+        case ResizeMethod::Bilinear: resize_bilinear_omp(in, out, threads, popt); return;
         default: throw std::invalid_argument("resize_omp: unsupported method");
     }
 #endif
 }
+
+double WorkAccounting::imbalance() const {
+    if (threads.empty()) return -1.0;
+    double sum = 0.0, mx = 0.0;
+    for (const ThreadWork& t : threads) {
+        sum += t.busy_ms;
+        mx = std::max(mx, t.busy_ms);
+    }
+    const double mean = sum / static_cast<double>(threads.size());
+    return (mean > 0.0) ? mx / mean : -1.0;
+}
+
+double WorkAccounting::idle_fraction() const {
+    double busy = 0.0, wait = 0.0;
+    for (const ThreadWork& t : threads) {
+        busy += t.busy_ms;
+        wait += t.wait_ms;
+    }
+    return (busy + wait > 0.0) ? wait / (busy + wait) : -1.0;
+}
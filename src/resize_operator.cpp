@@ -0,0 +1,230 @@
+// resize_operator.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the sparse resize operator, influence maps and batch apply.
+#include "resize_operator.hpp"
+
+#include "kernels.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
+
+// Appends the row (a, 1 - w) + (b, w), dropping zero weights and merging a == b.
+void push_taps(SparseMatrix& m, int a, int b, float w) {
+    if (a == b || w == 0.0f) {
+        m.col_idx.push_back(a);
+        m.val.push_back(1.0f);
+    } else {
+        m.col_idx.push_back(a);
+        m.val.push_back(1.0f - w);
+        m.col_idx.push_back(b);
+        m.val.push_back(w);
+    }
+    m.row_ptr.push_back(static_cast<int>(m.col_idx.size()));
+}
+
+SparseMatrix start_matrix(int rows, int cols) {
+    SparseMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    m.row_ptr.reserve(static_cast<size_t>(rows) + 1);
+    m.row_ptr.push_back(0);
+    m.col_idx.reserve(2 * static_cast<size_t>(rows));
+    m.val.reserve(2 * static_cast<size_t>(rows));
+    return m;
+}
+
+// Sum of |weight| and entry count per column.
+void column_sums(const SparseMatrix& m, std::vector<float>& weight, std::vector<int>& count) {
+    weight.assign(static_cast<size_t>(m.cols), 0.0f);
+    count.assign(static_cast<size_t>(m.cols), 0);
+    for (std::size_t k = 0; k < m.nnz(); ++k) {
+        weight[static_cast<size_t>(m.col_idx[k])] += std::fabs(m.val[k]);
+        count[static_cast<size_t>(m.col_idx[k])]++;
+    }
+}
+
+// Horizontal pass of one source row: dst holds cols_op.rows * channels floats.
+void apply_cols(const SparseMatrix& m, const std::uint8_t* src, float* dst, int channels) {
+    for (int r = 0; r < m.rows; ++r) {
+        const int b = m.row_ptr[r];
+        const std::uint8_t* p0 = src + m.col_idx[b] * channels;
+        float* d = dst + r * channels;
+        if (m.row_ptr[r + 1] - b == 1) {
+            for (int c = 0; c < channels; ++c) d[c] = static_cast<float>(p0[c]);
+        } else {
+            const std::uint8_t* p1 = src + m.col_idx[b + 1] * channels;
+            const float w = m.val[b + 1];
+            for (int c = 0; c < channels; ++c) {
+                const float v0 = static_cast<float>(p0[c]);
+                const float v1 = static_cast<float>(p1[c]);
+                d[c] = v0 + w * (v1 - v0);
+            }
+        }
+    }
+}
+
+// Nearest-style operators (one entry per row everywhere) are pure gathers.
+bool is_gather(const SparseMatrix& m) {
+    return m.nnz() == static_cast<std::size_t>(m.rows);
+}
+
+} // namespace
+
+ResizeOperator resize_operator(int in_w, int in_h, int out_w, int out_h, ResizeMethod method) {
+    if (in_w <= 0 || in_h <= 0 || out_w <= 0 || out_h <= 0) {
+        throw std::invalid_argument("resize_operator: sizes must be > 0");
+    }
+    ResizeOperator op;
+    op.in_w = in_w;
+    op.in_h = in_h;
+    op.out_w = out_w;
+    op.out_h = out_h;
+    op.method = method;
+
+    op.rows_op = start_matrix(out_h, in_h);
+    for (int y = 0; y < out_h; ++y) {
+        const RowTap t = row_tap(y, in_h, out_h, method);
+        push_taps(op.rows_op, t.y0, t.y1, t.wy);
+    }
+
+    const ColumnMap cm = make_column_map(in_w, out_w, method);
+    op.cols_op = start_matrix(out_w, in_w);
+    for (int x = 0; x < out_w; ++x) {
+        if (method == ResizeMethod::Nearest) push_taps(op.cols_op, cm.x0[x], cm.x0[x], 0.0f);
+        else push_taps(op.cols_op, cm.x0[x], cm.x1[x], cm.wx[x]);
+    }
+    return op;
+}
+
+InfluenceMap influence_map(const ResizeOperator& op) {
+    InfluenceMap map;
+    map.width = op.in_w;
+    map.height = op.in_h;
+    column_sums(op.cols_op, map.col_weight, map.col_count);
+    column_sums(op.rows_op, map.row_weight, map.row_count);
+    return map;
+}
+
+std::size_t InfluenceMap::influential_pixels() const {
+    const auto nonzero = [](const std::vector<float>& v) {
+        return static_cast<std::size_t>(std::count_if(v.begin(), v.end(), [](float w) { return w != 0.0f; }));
+    };
+    return nonzero(col_weight) * nonzero(row_weight);
+}
+
+double InfluenceMap::influential_fraction() const {
+    const double total = static_cast<double>(width) * static_cast<double>(height);
+    return (total > 0.0) ? static_cast<double>(influential_pixels()) / total : 0.0;
+}
+
+std::vector<float> influence_dense(const InfluenceMap& map, int threads) {
+    std::vector<float> out(static_cast<size_t>(map.width) * static_cast<size_t>(map.height));
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel for schedule(static)
+#else
+    (void)threads;
+#endif
+    for (int y = 0; y < map.height; ++y) {
+        float* row = out.data() + static_cast<size_t>(y) * static_cast<size_t>(map.width);
+        const float wy = map.row_weight[y];
+        for (int x = 0; x < map.width; ++x) row[x] = map.col_weight[x] * wy;
+    }
+    return out;
+}
+
+Image influence_image(const InfluenceMap& map, int threads) {
+    const float max_col = *std::max_element(map.col_weight.begin(), map.col_weight.end());
+    const float max_row = *std::max_element(map.row_weight.begin(), map.row_weight.end());
+    const float peak = max_col * max_row;
+    const float scale = (peak > 0.0f) ? 255.0f / peak : 0.0f;
+
+    Image img(map.width, map.height, 1);
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel for schedule(static)
+#else
+    (void)threads;
+#endif
+    for (int y = 0; y < map.height; ++y) {
+        std::uint8_t* row = img.row_ptr(y);
+        const float wy = map.row_weight[y] * scale;
+        for (int x = 0; x < map.width; ++x) {
+            row[x] = clamp_u8(static_cast<int>(std::lround(map.col_weight[x] * wy)));
+        }
+    }
+    return img;
+}
+
+std::vector<Image> apply_resize_operator(const ResizeOperator& op, const std::vector<Image>& batch, int threads) {
+    TRACE_SCOPE_ARGS("apply_resize_operator", trace_cat::resize, "images", static_cast<long long>(batch.size()),
+                     "out_h", op.out_h);
+
+    int max_ch = 1;
+    std::vector<Image> out;
+    out.reserve(batch.size());
+    for (const Image& img : batch) {
+        if (img.empty() || img.width != op.in_w || img.height != op.in_h) {
+            throw std::invalid_argument("apply_resize_operator: image size does not match the operator ("
+                                        + std::to_string(op.in_w) + "x" + std::to_string(op.in_h) + ")");
+        }
+        max_ch = std::max(max_ch, img.channels);
+        out.emplace_back(op.out_w, op.out_h, img.channels);
+    }
+
+    const bool gather = is_gather(op.rows_op) && is_gather(op.cols_op);
+    const long long tasks = static_cast<long long>(batch.size()) * op.out_h;
+    const std::size_t hrow = static_cast<size_t>(op.out_w) * static_cast<size_t>(max_ch);
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel
+#else
+    (void)threads;
+#endif
+    {
+        std::vector<float> h0(gather ? 0 : hrow);
+        std::vector<float> h1(gather ? 0 : hrow);
+#if HAVE_OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (long long t = 0; t < tasks; ++t) {
+            const Image& src = batch[static_cast<size_t>(t / op.out_h)];
+            Image& dst = out[static_cast<size_t>(t / op.out_h)];
+            const int y = static_cast<int>(t % op.out_h);
+            const int ch = src.channels;
+            const int b = op.rows_op.row_ptr[y];
+            std::uint8_t* d = dst.row_ptr(y);
+
+            if (gather) {
+                const std::uint8_t* s = src.row_ptr(op.rows_op.col_idx[b]);
+                for (int x = 0; x < op.out_w; ++x) {
+                    const std::uint8_t* p = s + op.cols_op.col_idx[x] * ch;
+                    for (int c = 0; c < ch; ++c) d[x * ch + c] = p[c];
+                }
+                continue;
+            }
+
+            const int n = op.out_w * ch;
+            apply_cols(op.cols_op, src.row_ptr(op.rows_op.col_idx[b]), h0.data(), ch);
+            if (op.rows_op.row_ptr[y + 1] - b == 1) {
+                for (int i = 0; i < n; ++i) d[i] = clamp_u8(static_cast<int>(std::lround(h0[i])));
+            } else {
+                apply_cols(op.cols_op, src.row_ptr(op.rows_op.col_idx[b + 1]), h1.data(), ch);
+                vpass_row(h0.data(), h1.data(), d, op.rows_op.val[b + 1], n);
+            }
+        }
+    }
+    return out;
+}
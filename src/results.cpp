@@ -0,0 +1,398 @@
+// results.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the buffered CSV/JSON result writer and its reader.
+#include "results.hpp"
+
+#include "metadata.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+static void write_value_csv(std::ostream& os, const ResultValue& v) {
+    if (const auto* s = std::get_if<std::string>(&v)) {
+        if (s->find_first_of(",\"\n") == std::string::npos) {
+            os << *s;
+        } else {
+            os << '"';
+            for (char ch : *s) {
+                if (ch == '"') os << '"';
+                os << ch;
+            }
+            os << '"';
+        }
+    } else if (const auto* i = std::get_if<std::int64_t>(&v)) {
+        os << *i;
+    } else {
+        os << std::get<double>(v);
+    }
+}
+
+static void write_json_string(std::ostream& os, const std::string& s) {
+    os << '"';
+    for (char ch : s) {
+        switch (ch) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n";  break;
+            case '\t': os << "\\t";  break;
+            default:   os << ch;     break;
+        }
+    }
+    os << '"';
+}
+
+static void write_value_json(std::ostream& os, const ResultValue& v) {
+    if (const auto* s = std::get_if<std::string>(&v)) {
+        write_json_string(os, *s);
+    } else if (const auto* i = std::get_if<std::int64_t>(&v)) {
+        os << *i;
+    } else {
+        const double d = std::get<double>(v);
+        if (std::isfinite(d)) os << d;
+        else os << "null"; // JSON has no inf/nan
+    }
+}
+
+ResultWriter::ResultWriter(std::string path, std::vector<std::string> columns)
+    : path_(std::move(path)), columns_(std::move(columns)), json_(ends_with_icase(path_, ".json")) {
+    if (columns_.empty()) throw std::invalid_argument("ResultWriter: no columns");
+}
+
+ResultWriter::~ResultWriter() {
+    try {
+        flush();
+    } catch (...) {
+        // destructors must not throw; callers that care call flush() explicitly
+    }
+}
+
+void ResultWriter::add_row(std::vector<ResultValue> values) {
+    if (values.size() != columns_.size()) {
+        throw std::invalid_argument("ResultWriter: row has " + std::to_string(values.size()) +
+                                    " values, expected " + std::to_string(columns_.size()));
+    }
+    rows_.push_back(std::move(values));
+}
+
+void ResultWriter::set_parameter(const std::string& name, ResultValue value) {
+    for (auto& [n, v] : params_) {
+        if (n == name) {
+            v = std::move(value);
+            return;
+        }
+    }
+    params_.emplace_back(name, std::move(value));
+}
+
+// "name": value pairs of a flat metadata object, one per line.
+static void write_fields_json(std::ostream& os, const std::vector<std::pair<std::string, ResultValue>>& fields) {
+    for (size_t i = 0; i < fields.size(); ++i) {
+        os << "    ";
+        write_json_string(os, fields[i].first);
+        os << ": ";
+        write_value_json(os, fields[i].second);
+        os << ((i + 1 < fields.size()) ? ",\n" : "\n");
+    }
+}
+
+void ResultWriter::flush() {
+    if (json_) {
+        // Global parameters first; writer-specific ones override same-named entries.
+        std::vector<std::pair<std::string, ResultValue>> params;
+        for (const auto& p : run_parameters()) {
+            const bool overridden = std::any_of(params_.begin(), params_.end(),
+                                                [&](const auto& q) { return q.first == p.first; });
+            if (!overridden) params.push_back(p);
+        }
+        params.insert(params.end(), params_.begin(), params_.end());
+
+        std::ostringstream oss;
+        oss << std::setprecision(10);
+        oss << "{\n  \"environment\": {\n";
+        write_fields_json(oss, environment_metadata());
+        oss << "  },\n  \"parameters\": {\n";
+        write_fields_json(oss, params);
+        oss << "  },\n  \"results\": [\n";
+        for (size_t r = 0; r < rows_.size(); ++r) {
+            oss << "    {";
+            for (size_t c = 0; c < columns_.size(); ++c) {
+                if (c) oss << ", ";
+                write_json_string(oss, columns_[c]);
+                oss << ": ";
+                write_value_json(oss, rows_[r][c]);
+            }
+            oss << ((r + 1 < rows_.size()) ? "},\n" : "}\n");
+        }
+        oss << "  ]\n}\n";
+
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("ResultWriter: cannot open file: " + path_);
+        out << oss.str();
+        return;
+    }
+
+    if (rows_.empty()) return;
+
+    bool write_header = false;
+    {
+        std::ifstream in(path_, std::ios::binary);
+        if (!in.good()) {
+            write_header = true;
+        } else {
+            in.seekg(0, std::ios::end);
+            write_header = (in.tellg() == 0);
+        }
+    }
+
+    std::ostringstream oss;
+    oss << std::setprecision(10);
+    if (write_header) {
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            if (c) oss << ',';
+            oss << columns_[c];
+        }
+        oss << '\n';
+    }
+    for (const auto& row : rows_) {
+        for (size_t c = 0; c < row.size(); ++c) {
+            if (c) oss << ',';
+            write_value_csv(oss, row[c]);
+        }
+        oss << '\n';
+    }
+
+    std::ofstream out(path_, std::ios::binary | std::ios::app);
+    if (!out) throw std::runtime_error("ResultWriter: cannot open file: " + path_);
+    out << oss.str();
+    rows_.clear();
+}
+
+int ResultTable::column(std::string_view name) const {
+    const auto it = std::find(columns.begin(), columns.end(), name);
+    return (it == columns.end()) ? -1 : static_cast<int>(it - columns.begin());
+}
+
+// One CSV record starting at pos (RFC 4180 quoting, as produced by write_value_csv).
+static std::vector<std::string> parse_csv_record(const std::string& text, size_t& pos) {
+    std::vector<std::string> fields;
+    std::string field;
+    bool quoted = false;
+
+    while (pos < text.size()) {
+        const char ch = text[pos++];
+        if (quoted) {
+            if (ch == '"') {
+                if (pos < text.size() && text[pos] == '"') { field += '"'; ++pos; }
+                else quoted = false;
+            } else {
+                field += ch;
+            }
+        } else if (ch == '"') {
+            quoted = true;
+        } else if (ch == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (ch == '\n') {
+            break;
+        } else if (ch != '\r') {
+            field += ch;
+        }
+    }
+    fields.push_back(std::move(field));
+    return fields;
+}
+
+static ResultTable parse_csv_table(const std::string& text, const std::string& path) {
+    ResultTable t;
+    size_t pos = 0;
+    if (text.empty()) return t;
+
+    t.columns = parse_csv_record(text, pos);
+    while (pos < text.size()) {
+        std::vector<std::string> rec = parse_csv_record(text, pos);
+        if (rec.size() == 1 && rec[0].empty()) continue; // blank line
+        if (rec.size() != t.columns.size()) {
+            throw std::runtime_error("read_result_table: " + path + ": row " + std::to_string(t.rows.size() + 1) +
+                                     " has " + std::to_string(rec.size()) + " fields, header has " +
+                                     std::to_string(t.columns.size()));
+        }
+        t.rows.push_back(std::move(rec));
+    }
+    return t;
+}
+
+namespace {
+
+// Minimal reader for what ResultWriter emits: an object with flat "environment"
+// and "parameters" objects and a "results" array of flat objects whose values are
+// strings, numbers, booleans or null. A bare results array is accepted as well.
+class JsonTableParser {
+public:
+    JsonTableParser(const std::string& text, const std::string& path) : s_(text), path_(path) {}
+
+    ResultTable parse() {
+        ResultTable t;
+        if (peek() == '[') {
+            parse_rows(t);
+            return t;
+        }
+
+        expect('{');
+        bool have_results = false;
+        if (peek() != '}') {
+            for (;;) {
+                const std::string key = string_value();
+                expect(':');
+                if (key == "results") {
+                    parse_rows(t);
+                    have_results = true;
+                } else if (key == "environment") {
+                    parse_flat_object(t.environment);
+                } else if (key == "parameters") {
+                    parse_flat_object(t.parameters);
+                } else {
+                    skip_value();
+                }
+                if (peek() == ',') { ++i_; continue; }
+                break;
+            }
+        }
+        expect('}');
+        if (!have_results) fail("missing \"results\" array");
+        return t;
+    }
+
+private:
+    void parse_rows(ResultTable& t) {
+        expect('[');
+        if (peek() == ']') { ++i_; return; }
+        for (;;) {
+            std::vector<std::string> row(t.columns.size());
+            expect('{');
+            if (peek() != '}') {
+                for (;;) {
+                    const std::string key = string_value();
+                    expect(':');
+                    const std::string value = scalar_value();
+                    int c = t.column(key);
+                    if (c < 0) {
+                        // Column first seen in a later row: earlier rows get "".
+                        t.columns.push_back(key);
+                        for (auto& r : t.rows) r.emplace_back();
+                        row.emplace_back();
+                        c = static_cast<int>(t.columns.size()) - 1;
+                    }
+                    row[static_cast<size_t>(c)] = value;
+                    if (peek() == ',') { ++i_; continue; }
+                    break;
+                }
+            }
+            expect('}');
+            t.rows.push_back(std::move(row));
+            if (peek() == ',') { ++i_; continue; }
+            break;
+        }
+        expect(']');
+    }
+
+    void parse_flat_object(std::map<std::string, std::string>& out) {
+        expect('{');
+        if (peek() == '}') { ++i_; return; }
+        for (;;) {
+            const std::string key = string_value();
+            expect(':');
+            out[key] = scalar_value();
+            if (peek() == ',') { ++i_; continue; }
+            break;
+        }
+        expect('}');
+    }
+
+    // Skips any value, including nested objects and arrays (unknown top-level keys).
+    void skip_value() {
+        const char ch = peek();
+        if (ch == '"') { string_value(); return; }
+        if (ch != '{' && ch != '[') { scalar_value(); return; }
+
+        const char close = (ch == '{') ? '}' : ']';
+        ++i_;
+        if (peek() == close) { ++i_; return; }
+        for (;;) {
+            if (close == '}') {
+                string_value();
+                expect(':');
+            }
+            skip_value();
+            if (peek() == ',') { ++i_; continue; }
+            break;
+        }
+        expect(close);
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("read_result_table: " + path_ + ": " + what + " at offset " + std::to_string(i_));
+    }
+
+    char peek() {
+        while (i_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[i_]))) ++i_;
+        return (i_ < s_.size()) ? s_[i_] : '\0';
+    }
+
+    void expect(char ch) {
+        if (peek() != ch) fail(std::string("expected '") + ch + "'");
+        ++i_;
+    }
+
+    std::string string_value() {
+        expect('"');
+        std::string out;
+        while (i_ < s_.size() && s_[i_] != '"') {
+            char ch = s_[i_++];
+            if (ch == '\\' && i_ < s_.size()) {
+                const char esc = s_[i_++];
+                switch (esc) {
+                    case 'n': ch = '\n'; break;
+                    case 't': ch = '\t'; break;
+                    default:  ch = esc;  break; // \" \\ \/
+                }
+            }
+            out += ch;
+        }
+        expect('"');
+        return out;
+    }
+
+    std::string scalar_value() {
+        if (peek() == '"') return string_value();
+        const size_t start = i_;
+        while (i_ < s_.size() && s_[i_] != ',' && s_[i_] != '}' && s_[i_] != ']' && !std::isspace(static_cast<unsigned char>(s_[i_]))) ++i_;
+        std::string tok = s_.substr(start, i_ - start);
+        if (tok.empty()) fail("expected a value");
+        if (tok == "null") return "";
+        return tok;
+    }
+
+    const std::string& s_;
+    const std::string& path_;
+    size_t i_ = 0;
+};
+
+} // namespace
+
+ResultTable read_result_table(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("read_result_table: cannot open file: " + path);
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    const std::string text = oss.str();
+
+    if (ends_with_icase(path, ".json")) return JsonTableParser(text, path).parse();
+    return parse_csv_table(text, path);
+}
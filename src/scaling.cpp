@@ -0,0 +1,215 @@
+// scaling.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of strong/weak thread-scaling experiments and model fits.
+#include "scaling.hpp"
+
+#include "benchmark.hpp"
+#include "results.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+std::vector<int> default_thread_ladder() {
+#if HAVE_OPENMP
+    int n = omp_get_num_procs();
+#else
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+#endif
+    if (n <= 0) n = 1;
+
+    std::vector<int> t;
+    for (int i = 1; i <= n; ++i) t.push_back(i);
+    return t;
+}
+
+double fit_amdahl_serial_fraction(const std::vector<ScalingPoint>& pts) {
+    // 1/S = f + (1-f)/p  <=>  (1/S - 1/p) = f * (1 - 1/p): regression through the origin.
+    double num = 0.0, den = 0.0;
+    for (const ScalingPoint& q : pts) {
+        if (q.threads <= 1 || q.speedup <= 0.0) continue;
+        const double inv_p = 1.0 / q.threads;
+        const double a = 1.0 - inv_p;
+        const double b = 1.0 / q.speedup - inv_p;
+        num += a * b;
+        den += a * a;
+    }
+    return (den > 0.0) ? num / den : 0.0;
+}
+
+double fit_gustafson_serial_fraction(const std::vector<ScalingPoint>& pts) {
+    // S = p - alpha * (p - 1)  <=>  (p - S) = alpha * (p - 1).
+    double num = 0.0, den = 0.0;
+    for (const ScalingPoint& q : pts) {
+        if (q.threads <= 1) continue;
+        const double a = q.threads - 1.0;
+        const double b = q.threads - q.speedup;
+        num += a * b;
+        den += a * a;
+    }
+    return (den > 0.0) ? num / den : 0.0;
+}
+
+static BenchResult measure(const Image& img, const ScalingSpec& spec, int w, int h, int threads) {
+    BenchOptions bopt;
+    bopt.thread_stats = spec.thread_stats;
+    return benchmark_resize(img, w, h, spec.method, Backend::OpenMP, threads,
+                            spec.warmup, spec.runs, spec.inner_reps, spec.popt, bopt);
+}
+
+ScalingReport run_scaling(const Image& img, const ScalingSpec& spec, std::ostream& log) {
+    if (img.empty()) throw std::invalid_argument("run_scaling: input image is empty");
+    if (spec.out_w <= 0 || spec.out_h <= 0) throw std::invalid_argument("run_scaling: output size must be > 0");
+
+    std::vector<int> threads = spec.threads.empty() ? default_thread_ladder() : spec.threads;
+    // Ascending and unique, with T1 (the reference point) measured once and first.
+    std::sort(threads.begin(), threads.end());
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+    if (threads.front() != 1) threads.insert(threads.begin(), 1);
+
+    ScalingReport rep;
+
+    if (spec.strong) {
+        log << "scaling: strong, " << spec.out_w << "x" << spec.out_h << "\n";
+        double t1 = 0.0;
+        for (int p : threads) {
+            log << "  t=" << p << " ... " << std::flush;
+            const BenchResult r = measure(img, spec, spec.out_w, spec.out_h, p);
+            if (p == 1) t1 = r.mean_ms;
+
+            ScalingPoint q;
+            q.threads = p;
+            q.out_w = spec.out_w;
+            q.out_h = spec.out_h;
+            q.mean_ms = r.mean_ms;
+            q.stddev_ms = r.stddev_ms;
+            q.imbalance = r.imbalance;
+            q.idle_fraction = r.idle_fraction;
+            q.speedup = (r.mean_ms > 0.0) ? t1 / r.mean_ms : 0.0;
+            q.efficiency = q.speedup / p;
+            if (p > 1 && q.speedup > 0.0) {
+                // Karp-Flatt experimentally determined serial fraction
+                q.serial_fraction = (1.0 / q.speedup - 1.0 / p) / (1.0 - 1.0 / p);
+            }
+            rep.strong.push_back(q);
+            log << r.mean_ms << " ms (S=" << q.speedup << ")\n";
+        }
+        rep.amdahl_serial = fit_amdahl_serial_fraction(rep.strong);
+    }
+
+    if (spec.weak) {
+        log << "scaling: weak, " << spec.out_w << "x" << spec.out_h << " per thread\n";
+        double t1 = 0.0;
+        const double px1 = static_cast<double>(spec.out_w) * static_cast<double>(spec.out_h);
+        for (int p : threads) {
+            // Grow both sides by sqrt(p) to keep the aspect ratio.
+            const double k = std::sqrt(static_cast<double>(p));
+            const int w = std::max(1, static_cast<int>(std::lround(spec.out_w * k)));
+            const int h = std::max(1, static_cast<int>(std::lround(spec.out_h * k)));
+
+            log << "  t=" << p << " " << w << "x" << h << " ... " << std::flush;
+            const BenchResult r = measure(img, spec, w, h, p);
+            if (p == 1) t1 = r.mean_ms;
+
+            ScalingPoint q;
+            q.threads = p;
+            q.out_w = w;
+            q.out_h = h;
+            q.mean_ms = r.mean_ms;
+            q.stddev_ms = r.stddev_ms;
+            q.imbalance = r.imbalance;
+            q.idle_fraction = r.idle_fraction;
+            // Rounding makes the area only approximately p times larger; correct for it.
+            const double work = static_cast<double>(w) * static_cast<double>(h) / px1;
+            q.speedup = (r.mean_ms > 0.0) ? work * t1 / r.mean_ms : 0.0;
+            q.efficiency = q.speedup / p;
+            if (p > 1) q.serial_fraction = (p - q.speedup) / (p - 1.0);
+            rep.weak.push_back(q);
+            log << r.mean_ms << " ms (S=" << q.speedup << ")\n";
+        }
+        rep.gustafson_serial = fit_gustafson_serial_fraction(rep.weak);
+    }
+
+    return rep;
+}
+
+void write_scaling_report(const ScalingReport& rep, const ScalingSpec& spec, const Image& img,
+                          const std::string& path) {
+    ResultWriter writer(path, {
+        "kind", "method", "schedule", "chunk", "threads",
+        "in_w", "in_h", "out_w", "out_h", "channels", "runs", "inner_reps",
+        "mean_ms", "stddev_ms", "speedup", "efficiency", "serial_fraction", "fitted_serial_fraction",
+        "imbalance", "idle_fraction"
+    });
+
+    auto emit = [&](const char* kind, const std::vector<ScalingPoint>& pts, double fitted) {
+        for (const ScalingPoint& q : pts) {
+            writer.add_row({
+                std::string(kind), std::string(method_name(spec.method)),
+                std::string(schedule_name(spec.popt.schedule)), static_cast<std::int64_t>(spec.popt.chunk),
+                static_cast<std::int64_t>(q.threads),
+                static_cast<std::int64_t>(img.width), static_cast<std::int64_t>(img.height),
+                static_cast<std::int64_t>(q.out_w), static_cast<std::int64_t>(q.out_h),
+                static_cast<std::int64_t>(img.channels),
+                static_cast<std::int64_t>(spec.runs), static_cast<std::int64_t>(spec.inner_reps),
+                q.mean_ms, q.stddev_ms, q.speedup, q.efficiency, q.serial_fraction, fitted,
+                q.imbalance, q.idle_fraction
+            });
+        }
+    };
+    emit("strong", rep.strong, rep.amdahl_serial);
+    emit("weak", rep.weak, rep.gustafson_serial);
+    writer.flush();
+}
+
+void print_scaling_summary(const ScalingReport& rep, std::ostream& os) {
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+
+    auto table = [&](const char* title, const std::vector<ScalingPoint>& pts, const char* frac_name) {
+        if (pts.empty()) return;
+        const bool accounted = pts.front().imbalance >= 0.0;
+        os << "\n" << title << "\n"
+           << "  threads        size      mean_ms   speedup  efficiency  " << std::setw(10) << frac_name;
+        if (accounted) os << "  imbalance      idle";
+        os << "\n";
+        for (const ScalingPoint& q : pts) {
+            os << "  " << std::setw(7) << q.threads
+               << "  " << std::setw(10) << (std::to_string(q.out_w) + "x" + std::to_string(q.out_h))
+               << std::fixed << std::setprecision(3)
+               << "  " << std::setw(11) << q.mean_ms
+               << "  " << std::setw(8) << q.speedup
+               << "  " << std::setw(10) << q.efficiency
+               << "  " << std::setw(10) << q.serial_fraction;
+            if (accounted) {
+                os << "  " << std::setw(9) << q.imbalance
+                   << "  " << std::setw(8) << q.idle_fraction;
+            }
+            os << "\n";
+            os.flags(flags);
+        }
+    };
+
+    table("STRONG SCALING (fixed size)", rep.strong, "karp_flatt");
+    if (!rep.strong.empty()) {
+        os << "  Amdahl fit: serial fraction = " << std::fixed << std::setprecision(4) << rep.amdahl_serial;
+        if (rep.amdahl_serial > 0.0) os << "  (max speedup ~ " << std::setprecision(1) << 1.0 / rep.amdahl_serial << "x)";
+        os << "\n";
+        os.flags(flags);
+    }
+
+    table("WEAK SCALING (size grows with threads)", rep.weak, "alpha");
+    if (!rep.weak.empty()) {
+        os << "  Gustafson fit: serial fraction = " << std::fixed << std::setprecision(4) << rep.gustafson_serial << "\n";
+        os.flags(flags);
+    }
+
+    os.precision(prec);
+}
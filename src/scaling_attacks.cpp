@@ -3,53 +3,152 @@
 //
 // Implementation of scaling-attack pipeline and metrics.
 // Computes MAE/RMSE/PSNR and max absolute difference between original and reconstructed image.
+// The reconstruction is streamed: upscaled rows are generated per thread from the
+// downscaled image and compared with the source right away.
 #include "scaling_attacks.hpp"
+#include "kernels.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
 #include <cmath>
-#include <stdexcept>
+#include <cstdint>
 #include <limits>
+#include <stdexcept>
+#include <vector>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
 
-static AttackMetrics diff_metrics(const Image& a, const Image& b) {
-    if (a.width != b.width || a.height != b.height || a.channels != b.channels) {
-        throw std::invalid_argument("diff_metrics: image sizes/channels must match");
+// Difference sums of a set of rows. All integer, so partial sums can be merged
+// in any order without changing the result.
+struct DiffSums {
+    AbsDiffAccum acc;
+    std::uint64_t sq = 0;
+
+    void merge(const DiffSums& o) {
+        acc.max_abs = std::max(acc.max_abs, o.acc.max_abs);
+        acc.nonzero += o.acc.nonzero;
+        acc.sum += o.acc.sum;
+        sq += o.sq;
     }
-    const size_t n = a.data.size();
-    if (n == 0) throw std::invalid_argument("diff_metrics: empty images");
-
-    double sum_abs = 0.0;
-    double sum_sq = 0.0;
-    int max_abs = 0;
-
-    for (size_t i = 0; i < n; ++i) {
-        const int da = static_cast<int>(a.data[i]);
-        const int db = static_cast<int>(b.data[i]);
-        const int d = da - db;
-        const int ad = (d < 0) ? -d : d;
-
-        sum_abs += static_cast<double>(ad);
-        sum_sq  += static_cast<double>(d) * static_cast<double>(d);
-        if (ad > max_abs) max_abs = ad;
+};
+
+// Produces the rows of small resized to out_w x out_h one at a time, byte-identical
+// to the rows of resize(small, out_w, out_h, method, ...). Bilinear keeps the
+// horizontal pass of the last two source rows, so when upscaling each source row
+// is interpolated horizontally about once instead of once per output row.
+class RowUpscaler {
+public:
+    RowUpscaler(const Image& small, int out_w, int out_h, ResizeMethod method)
+        : small_(small), out_w_(out_w), out_h_(out_h), method_(method),
+          cm_(make_column_map(small.width, out_w, method)),
+          n_(static_cast<size_t>(out_w) * static_cast<size_t>(small.channels)),
+          row_(n_) {
+        if (method == ResizeMethod::Bilinear) {
+            for (std::vector<float>& h : h_) h.resize(n_);
+        }
     }
 
-    const double mean_abs = sum_abs / static_cast<double>(n);
-    const double mse = sum_sq / static_cast<double>(n);
-    const double rmse = std::sqrt(mse);
+    const std::uint8_t* row(int y) {
+        const RowTap t = row_tap(y, small_.height, out_h_, method_);
+        if (method_ == ResizeMethod::Nearest) {
+            nearest_row(small_.row_ptr(t.y0), row_.data(), cm_, out_w_, small_.channels);
+        } else {
+            const int k0 = hrow(t.y0, -1);
+            const int k1 = hrow(t.y1, k0);
+            vpass_row(h_[k0].data(), h_[k1].data(), row_.data(), t.wy, static_cast<int>(n_));
+        }
+        return row_.data();
+    }
 
-    AttackMetrics m;
-    m.mae = mean_abs;
-    m.rmse = rmse;
-    m.max_abs = max_abs;
-
-    if (mse == 0.0) {
-        m.psnr = std::numeric_limits<double>::infinity();
-    } else {
-        const double peak = 255.0;
-        m.psnr = 20.0 * std::log10(peak) - 10.0 * std::log10(mse);
+    [[nodiscard]] size_t size() const { return n_; }
+
+private:
+    // Cache slot holding the horizontal pass of source row sy (never evicts slot keep).
+    int hrow(int sy, int keep) {
+        for (int k = 0; k < 2; ++k) {
+            if (cached_[k] == sy) return k;
+        }
+        int k = (cached_[0] <= cached_[1]) ? 0 : 1; // rows are visited in increasing order
+        if (k == keep) k = 1 - k;
+        hpass_row(small_.row_ptr(sy), h_[k].data(), cm_, out_w_, small_.channels);
+        cached_[k] = sy;
+        return k;
     }
 
+    const Image& small_;
+    int out_w_;
+    int out_h_;
+    ResizeMethod method_;
+    ColumnMap cm_;
+    size_t n_;
+    std::vector<std::uint8_t> row_;
+    std::vector<float> h_[2];
+    int cached_[2] = {-1, -1};
+};
+
+AttackMetrics to_attack_metrics(const DiffSums& s, size_t n) {
+    AttackMetrics m;
+    const double mse = static_cast<double>(s.sq) / static_cast<double>(n);
+    m.mae = static_cast<double>(s.acc.sum) / static_cast<double>(n);
+    m.rmse = std::sqrt(mse);
+    m.max_abs = s.acc.max_abs;
+    m.psnr = (s.sq == 0) ? std::numeric_limits<double>::infinity()
+                         : 20.0 * std::log10(255.0) - 10.0 * std::log10(mse);
     return m;
 }
 
+} // namespace
+
+AttackMetrics reconstruction_metrics(
+    const Image& src,
+    const Image& down,
+    ResizeMethod up_method,
+    Backend backend,
+    int threads,
+    int row_step
+) {
+    if (src.empty() || down.empty()) throw std::invalid_argument("reconstruction_metrics: empty image");
+    if (src.channels != down.channels) throw std::invalid_argument("reconstruction_metrics: channels must match");
+    if (row_step <= 0) throw std::invalid_argument("reconstruction_metrics: row_step must be > 0");
+    const int rows = (src.height + row_step - 1) / row_step;
+    TRACE_SCOPE_ARGS("down_up_compare", trace_cat::metrics, "width", src.width, "height", src.height);
+
+    DiffSums total;
+    const bool parallel = (backend == Backend::OpenMP);
+#if HAVE_OPENMP
+    if (parallel && threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel if(parallel)
+#else
+    (void)parallel;
+    (void)threads;
+#endif
+    {
+        RowUpscaler up(down, src.width, src.height, up_method);
+        DiffSums local;
+#if HAVE_OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int i = 0; i < rows; ++i) {
+            const int y = i * row_step;
+            const std::uint8_t* r = up.row(y);
+            absdiff_stats(src.row_ptr(y), r, up.size(), local.acc, nullptr);
+            local.sq += sqdiff_sum(src.row_ptr(y), r, up.size());
+        }
+#if HAVE_OPENMP
+        #pragma omp critical
+#endif
+        total.merge(local);
+    }
+
+    return to_attack_metrics(total, static_cast<size_t>(rows) * static_cast<size_t>(src.width)
+                                   * static_cast<size_t>(src.channels));
+}
+
 AttackMetrics down_up_metrics(
     const Image& src,
     int down_w, int down_h,
@@ -61,8 +160,27 @@ AttackMetrics down_up_metrics(
     if (src.empty()) throw std::invalid_argument("down_up_metrics: empty source image");
     if (down_w <= 0 || down_h <= 0) throw std::invalid_argument("down_up_metrics: invalid downscale size");
 
-    Image down = resize(src, down_w, down_h, down_method, backend, threads);
-    Image up   = resize(down, src.width, src.height, up_method, backend, threads);
+    const Image down = resize(src, down_w, down_h, down_method, backend, threads);
+    return reconstruction_metrics(src, down, up_method, backend, threads);
+}
+
+AttackMetrics down_up_metrics_reference(
+    const Image& src,
+    int down_w, int down_h,
+    ResizeMethod down_method,
+    ResizeMethod up_method
+) {
+    if (src.empty()) throw std::invalid_argument("down_up_metrics: empty source image");
+    if (down_w <= 0 || down_h <= 0) throw std::invalid_argument("down_up_metrics: invalid downscale size");
+
+    const Image down = resize_seq(src, down_w, down_h, down_method);
+    const Image up = resize_seq(down, src.width, src.height, up_method);
+    const ErrorMetrics e = error_metrics(src, up, 1);
 
-    return diff_metrics(src, up);
+    AttackMetrics m;
+    m.mae = e.mae;
+    m.rmse = e.rmse;
+    m.psnr = e.psnr;
+    m.max_abs = e.max_abs;
+    return m;
 }
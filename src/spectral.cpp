@@ -0,0 +1,168 @@
+// spectral.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the spectral scaling-attack detector.
+#include "spectral.hpp"
+
+#include "fft.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Bins kept free around DC and Nyquist so the background window stays valid.
+constexpr int peak_radius = 1;        // peak: max over (2r+1)^2 bins
+constexpr int ring_inner = 2;         // background: (2*outer+1)^2 window minus (2*inner+1)^2
+constexpr int ring_outer = 5;
+constexpr int dc_exclusion = 8;
+
+// Averaged power of the half spectrum, read with the real-input symmetry.
+struct PowerPlane {
+    int n = 0;
+    int rows = 0;
+    std::vector<float> p; // index l * rows + k
+
+    [[nodiscard]] float at(int k, int l) const {
+        k = ((k % n) + n) % n;
+        l = ((l % n) + n) % n;
+        if (k >= rows) {
+            k = n - k;
+            l = (n - l) % n;
+        }
+        return p[static_cast<std::size_t>(l) * rows + static_cast<std::size_t>(k)];
+    }
+};
+
+double median(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    const std::size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(mid), v.end());
+    return v[mid];
+}
+
+// Peak power around (k, l) over the median power of its ring, in dB.
+double excess_db(const PowerPlane& pp, int k, int l) {
+    float peak = 0.0f;
+    for (int dk = -peak_radius; dk <= peak_radius; ++dk) {
+        for (int dl = -peak_radius; dl <= peak_radius; ++dl) peak = std::max(peak, pp.at(k + dk, l + dl));
+    }
+    std::vector<float> ring;
+    for (int dk = -ring_outer; dk <= ring_outer; ++dk) {
+        for (int dl = -ring_outer; dl <= ring_outer; ++dl) {
+            if (std::abs(dk) <= ring_inner && std::abs(dl) <= ring_inner) continue;
+            ring.push_back(pp.at(k + dk, l + dl));
+        }
+    }
+    const std::size_t mid = ring.size() / 2;
+    std::nth_element(ring.begin(), ring.begin() + static_cast<std::ptrdiff_t>(mid), ring.end());
+    const double bg = std::max(static_cast<double>(ring[mid]), 1e-12);
+    return 10.0 * std::log10(std::max(static_cast<double>(peak), 1e-12) / bg);
+}
+
+// Rec. 601 luma of one pixel.
+float luma(const std::uint8_t* p, int channels) {
+    if (channels < 3) return static_cast<float>(p[0]);
+    return 0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2];
+}
+
+} // namespace
+
+SpectralResult spectral_scan(const Image& img, int target_w, int target_h, const SpectralSpec& spec, int threads) {
+    if (img.empty()) throw std::invalid_argument("spectral_scan: empty image");
+    if (target_w <= 0 || target_h <= 0) throw std::invalid_argument("spectral_scan: target size must be > 0");
+    if (spec.tile < 1 || spec.max_tiles < 1) throw std::invalid_argument("spectral_scan: tile and max_tiles must be > 0");
+
+    SpectralResult res;
+    res.stride_x = static_cast<double>(img.width) / target_w;
+    res.stride_y = static_cast<double>(img.height) / target_h;
+
+    int n = spec.tile;
+    while (n > img.width || n > img.height) n /= 2;
+    const int min_tile = 2 * (dc_exclusion + ring_outer + 2);
+    if (n < min_tile) return res;
+    res.tile = n;
+
+    // Lattice frequencies (bins) of the sampling grid, l along x and k along y,
+    // k >= 0 (the other half is symmetric). Each gets a control point half a
+    // lattice step further out in every non-zero coordinate, so points on an
+    // axis are compared with points on the same axis (where separable content
+    // such as gradients puts its energy) and the radial 1/f falloff cancels.
+    const double fx = n / res.stride_x;
+    const double fy = n / res.stride_y;
+    const int limit = n / 2 - ring_outer - 1;
+    struct Probe { int k, l, ck, cl; };
+    std::vector<Probe> probes;
+    for (int b = 0; (b + 0.5) * fy <= limit; ++b) {
+        for (int a = -static_cast<int>(limit / fx); (a + 0.5) * fx <= limit; ++a) {
+            if (b == 0 && a <= 0) continue; // (0, 0) and the mirrored half of the k = 0 row
+            const double ca = (a == 0) ? 0.0 : (a > 0 ? a + 0.5 : a - 0.5);
+            const double cb = (b == 0) ? 0.0 : b + 0.5;
+            if (std::fabs(ca * fx) > limit) continue;
+            const Probe p{static_cast<int>(std::lround(b * fy)), static_cast<int>(std::lround(a * fx)),
+                          static_cast<int>(std::lround(cb * fy)), static_cast<int>(std::lround(ca * fx))};
+            if (p.k * p.k + p.l * p.l < dc_exclusion * dc_exclusion) continue;
+            probes.push_back(p);
+        }
+    }
+    if (probes.empty()) return res;
+
+    TRACE_SCOPE_ARGS("spectral_scan", trace_cat::metrics, "tile", n, "peaks", static_cast<long long>(probes.size()));
+
+    std::vector<float> window(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * (i + 0.5) / n));
+    }
+
+    // Tiles on an evenly spaced g x g grid, the first max_tiles of them.
+    int g = 1;
+    while (g * g < spec.max_tiles) ++g;
+    auto origin = [&](int i, int size) { return (g == 1) ? (size - n) / 2 : static_cast<int>(static_cast<long long>(size - n) * i / (g - 1)); };
+
+    PowerPlane pp;
+    pp.n = n;
+    pp.rows = n / 2 + 1;
+    pp.p.assign(static_cast<std::size_t>(n) * pp.rows, 0.0f);
+    std::vector<float> tile(static_cast<std::size_t>(n) * n);
+
+    for (int t = 0; t < std::min(spec.max_tiles, g * g); ++t) {
+        const int x0 = origin(t % g, img.width);
+        const int y0 = origin(t / g, img.height);
+
+        double mean = 0.0;
+        for (int y = 0; y < n; ++y) {
+            const std::uint8_t* src = img.row_ptr(y0 + y) + static_cast<std::size_t>(x0) * img.channels;
+            float* dst = tile.data() + static_cast<std::size_t>(y) * n;
+            for (int x = 0; x < n; ++x) {
+                dst[x] = luma(src + x * img.channels, img.channels);
+                mean += dst[x];
+            }
+        }
+        const float m = static_cast<float>(mean / (static_cast<double>(n) * n));
+        for (int y = 0; y < n; ++y) {
+            float* row = tile.data() + static_cast<std::size_t>(y) * n;
+            for (int x = 0; x < n; ++x) row[x] = (row[x] - m) * window[y] * window[x];
+        }
+
+        const HalfSpectrum f = real_fft2d(tile.data(), n, n, threads);
+        for (std::size_t i = 0; i < pp.p.size(); ++i) pp.p[i] += f.re[i] * f.re[i] + f.im[i] * f.im[i];
+        res.tiles++;
+    }
+
+    std::vector<double> lat, ctl, diff;
+    for (const Probe& p : probes) {
+        lat.push_back(excess_db(pp, p.k, p.l));
+        ctl.push_back(excess_db(pp, p.ck, p.cl));
+        diff.push_back(lat.back() - ctl.back());
+    }
+    res.applicable = true;
+    res.peaks = static_cast<int>(probes.size());
+    res.lattice_db = median(std::move(lat));
+    res.control_db = median(std::move(ctl));
+    res.score_db = median(std::move(diff));
+    return res;
+}
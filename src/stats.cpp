@@ -0,0 +1,130 @@
+// stats.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the benchmark statistics helpers.
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+double mean(const std::vector<double>& v) {
+    if (v.empty()) return 0.0;
+    double s = 0.0;
+    for (double x : v) s += x;
+    return s / static_cast<double>(v.size());
+}
+
+double stddev_sample(const std::vector<double>& v, double mu) {
+    if (v.size() < 2) return 0.0;
+    double s2 = 0.0;
+    for (double x : v) {
+        const double d = x - mu;
+        s2 += d * d;
+    }
+    return std::sqrt(s2 / static_cast<double>(v.size() - 1));
+}
+
+static double percentile_sorted(const std::vector<double>& s, double p) {
+    if (s.empty()) return 0.0;
+    p = std::clamp(p, 0.0, 100.0);
+    const double rank = p / 100.0 * static_cast<double>(s.size() - 1);
+    const size_t lo = static_cast<size_t>(std::floor(rank));
+    const size_t hi = std::min(lo + 1, s.size() - 1);
+    const double f = rank - static_cast<double>(lo);
+    return s[lo] + f * (s[hi] - s[lo]);
+}
+
+double percentile(std::vector<double> v, double p) {
+    std::sort(v.begin(), v.end());
+    return percentile_sorted(v, p);
+}
+
+double median(std::vector<double> v) {
+    return percentile(std::move(v), 50.0);
+}
+
+double mad(const std::vector<double>& v, double med) {
+    std::vector<double> dev;
+    dev.reserve(v.size());
+    for (double x : v) dev.push_back(std::fabs(x - med));
+    return median(std::move(dev));
+}
+
+std::vector<double> reject_outliers_mad(const std::vector<double>& v, double k, int* rejected) {
+    const double med = median(v);
+    const double sigma = 1.4826 * mad(v, med);
+
+    std::vector<double> kept;
+    kept.reserve(v.size());
+    for (double x : v) {
+        if (sigma == 0.0 || std::fabs(x - med) <= k * sigma) kept.push_back(x);
+    }
+    if (rejected) *rejected = static_cast<int>(v.size() - kept.size());
+    return kept;
+}
+
+ConfInterval bootstrap_ci_median(const std::vector<double>& v, double confidence, int resamples, std::uint32_t seed) {
+    if (v.empty()) throw std::invalid_argument("bootstrap_ci_median: no samples");
+    if (v.size() == 1 || resamples <= 0) return {v.front(), v.front()};
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, v.size() - 1);
+
+    std::vector<double> boot(v.size());
+    std::vector<double> medians;
+    medians.reserve(static_cast<size_t>(resamples));
+
+    const size_t mid = boot.size() / 2;
+    for (int b = 0; b < resamples; ++b) {
+        for (double& x : boot) x = v[pick(rng)];
+        std::nth_element(boot.begin(), boot.begin() + static_cast<std::ptrdiff_t>(mid), boot.end());
+        double m = boot[mid];
+        if (boot.size() % 2 == 0) {
+            m = 0.5 * (m + *std::max_element(boot.begin(), boot.begin() + static_cast<std::ptrdiff_t>(mid)));
+        }
+        medians.push_back(m);
+    }
+
+    std::sort(medians.begin(), medians.end());
+    const double alpha = (1.0 - confidence) / 2.0;
+    return {percentile_sorted(medians, 100.0 * alpha), percentile_sorted(medians, 100.0 * (1.0 - alpha))};
+}
+
+double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b) {
+    if (a.size() < 2 || b.size() < 2) return 1.0;
+
+    struct Obs { double x; bool from_a; };
+    std::vector<Obs> all;
+    all.reserve(a.size() + b.size());
+    for (double x : a) all.push_back({x, true});
+    for (double x : b) all.push_back({x, false});
+    std::sort(all.begin(), all.end(), [](const Obs& l, const Obs& r) { return l.x < r.x; });
+
+    // Average ranks over ties; accumulate sum(t^3 - t) for the variance correction.
+    const double n = static_cast<double>(all.size());
+    double rank_sum_a = 0.0;
+    double ties = 0.0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].x == all[i].x) ++j;
+        const double avg_rank = 0.5 * static_cast<double>(i + 1 + j); // ranks i+1 .. j
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].from_a) rank_sum_a += avg_rank;
+        }
+        const double t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    const double n1 = static_cast<double>(a.size());
+    const double n2 = static_cast<double>(b.size());
+    const double u1 = rank_sum_a - n1 * (n1 + 1.0) / 2.0;
+    const double mu = n1 * n2 / 2.0;
+    const double var = n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+    if (var <= 0.0) return 1.0; // all values identical
+
+    const double z = std::max(0.0, std::fabs(u1 - mu) - 0.5) / std::sqrt(var);
+    return std::erfc(z / std::sqrt(2.0));
+}
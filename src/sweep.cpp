@@ -0,0 +1,182 @@
+// sweep.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the parameter-grid benchmark engine.
+#include "sweep.hpp"
+
+#include "benchmark.hpp"
+#include "results.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+std::vector<std::pair<int, int>> geometric_sizes(int base_w, int base_h, int steps, double scale) {
+    if (base_w <= 0 || base_h <= 0) throw std::invalid_argument("geometric_sizes: base size must be > 0");
+    if (steps <= 0) throw std::invalid_argument("geometric_sizes: steps must be > 0");
+
+    std::vector<std::pair<int, int>> sizes;
+    sizes.reserve(static_cast<size_t>(steps));
+
+    int w = base_w;
+    int h = base_h;
+    for (int i = 0; i < steps; ++i) {
+        sizes.emplace_back(w, h);
+        w = static_cast<int>(std::round(w * scale));
+        h = static_cast<int>(std::round(h * scale));
+    }
+    return sizes;
+}
+
+std::vector<SweepConfig> expand_sweep(const SweepSpec& spec) {
+    if (spec.sizes.empty())    throw std::invalid_argument("expand_sweep: no output sizes");
+    if (spec.methods.empty())  throw std::invalid_argument("expand_sweep: no methods");
+    if (spec.backends.empty()) throw std::invalid_argument("expand_sweep: no backends");
+
+    const std::vector<int> threads = spec.threads.empty() ? std::vector<int>{0} : spec.threads;
+    const std::vector<OmpSchedule> schedules =
+        spec.schedules.empty() ? std::vector<OmpSchedule>{OmpSchedule::Static} : spec.schedules;
+    const std::vector<int> chunks = spec.chunks.empty() ? std::vector<int>{0} : spec.chunks;
+    const std::vector<AllocMode> allocs =
+        spec.allocs.empty() ? std::vector<AllocMode>{AllocMode::Fresh} : spec.allocs;
+    const std::vector<CacheMode> caches =
+        spec.caches.empty() ? std::vector<CacheMode>{CacheMode::Warm} : spec.caches;
+
+    std::vector<SweepConfig> configs;
+    for (const auto& [w, h] : spec.sizes) {
+        if (w <= 0 || h <= 0) throw std::invalid_argument("expand_sweep: output sizes must be > 0");
+
+        for (ResizeMethod m : spec.methods) {
+            for (Backend b : spec.backends) {
+                for (AllocMode a : allocs) {
+                    for (CacheMode cm : caches) {
+                        SweepConfig c;
+                        c.out_w = w;
+                        c.out_h = h;
+                        c.method = m;
+                        c.backend = b;
+                        c.alloc = a;
+                        c.cache = cm;
+
+                        if (b == Backend::Sequential) {
+                            c.threads = 1;
+                            configs.push_back(c);
+                            continue;
+                        }
+
+                        for (int t : threads) {
+                            for (OmpSchedule s : schedules) {
+                                for (int ch : chunks) {
+                                    c.threads = t;
+                                    c.popt.schedule = s;
+                                    c.popt.chunk = ch;
+                                    configs.push_back(c);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+void run_sweep(const Image& img, const SweepSpec& spec, const std::string& out_path, std::ostream& log) {
+    if (img.empty()) throw std::invalid_argument("run_sweep: input image is empty");
+
+    const std::vector<SweepConfig> configs = expand_sweep(spec);
+
+    // Execution order is a permutation of the canonical order; config_id keeps the
+    // canonical index so shuffled runs with different seeds can be joined.
+    std::vector<size_t> order(configs.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    if (spec.shuffle) {
+        std::mt19937 rng(spec.seed);
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+
+    const std::vector<int> cpus = affinity_cpu_order(spec.affinity);
+
+    std::vector<std::string> columns = {
+        "config_id", "exec_order", "backend", "method", "threads", "schedule", "chunk", "affinity", "cpu_map",
+        "alloc", "cache",
+        "in_w", "in_h", "out_w", "out_h", "channels", "warmup", "inner_reps", "mpix_per_s"
+    };
+    for (const std::string& c : bench_result_columns()) columns.push_back(c);
+    ResultWriter writer(out_path, columns);
+
+    std::unique_ptr<ResultWriter> samples;
+    if (!spec.samples_path.empty()) {
+        samples = std::make_unique<ResultWriter>(spec.samples_path,
+            std::vector<std::string>{"config_id", "sample", "ms", "outlier"});
+    }
+
+    log << "benchset: " << configs.size() << " configurations"
+        << (spec.shuffle ? " (shuffled, seed " + std::to_string(spec.seed) + ")" : "") << "\n";
+    if (!cpus.empty()) {
+        log << "benchset: affinity " << affinity_policy_name(spec.affinity.policy)
+            << ", cpu order " << affinity_mapping(cpus, static_cast<int>(cpus.size())) << "\n";
+    }
+
+    for (size_t k = 0; k < order.size(); ++k) {
+        SweepConfig c = configs[order[k]];
+        if (c.backend == Backend::OpenMP) c.popt.cpus = cpus;
+
+        log << "  [" << (k + 1) << "/" << order.size() << "] "
+            << backend_name(c.backend) << " " << method_name(c.method) << " "
+            << c.out_w << "x" << c.out_h;
+        if (c.backend == Backend::OpenMP) {
+            log << " t=" << c.threads << " " << schedule_name(c.popt.schedule) << "/" << c.popt.chunk;
+        }
+        if (c.alloc != AllocMode::Fresh) log << " " << alloc_mode_name(c.alloc);
+        if (c.cache != CacheMode::Warm) log << " " << cache_mode_name(c.cache);
+        log << " ... " << std::flush;
+
+        BenchOptions bopt = spec.bench;
+        bopt.alloc = c.alloc;
+        bopt.cache = c.cache;
+        const BenchResult r = benchmark_resize(
+            img, c.out_w, c.out_h, c.method, c.backend, c.threads,
+            spec.warmup, spec.runs, spec.inner_reps, c.popt, bopt);
+
+        const double mpix = static_cast<double>(c.out_w) * static_cast<double>(c.out_h) / 1.0e6;
+        const double mpix_per_s = (r.mean_ms > 0.0) ? mpix / (r.mean_ms / 1000.0) : 0.0;
+
+        log << r.mean_ms << " ms (median " << r.median_ms << ", n=" << r.runs << ")";
+        if (r.perf.ipc() >= 0.0) log << "  ipc=" << r.perf.ipc();
+        log << "\n";
+        if (k == 0 && !r.perf_status.empty() && !r.perf.any()) {
+            log << "  (perf counters unavailable: " << r.perf_status << ")\n";
+        }
+
+        const bool omp = (c.backend == Backend::OpenMP);
+        std::vector<ResultValue> row = {
+            static_cast<std::int64_t>(order[k]), static_cast<std::int64_t>(k),
+            std::string(backend_name(c.backend)), std::string(method_name(c.method)),
+            static_cast<std::int64_t>(c.threads),
+            std::string(omp ? schedule_name(c.popt.schedule) : "-"),
+            static_cast<std::int64_t>(omp ? c.popt.chunk : 0),
+            std::string(omp ? affinity_policy_name(spec.affinity.policy) : "-"),
+            omp ? affinity_mapping(cpus, c.threads > 0 ? c.threads : static_cast<int>(cpus.size())) : std::string("-"),
+            std::string(alloc_mode_name(c.alloc)),
+            std::string(cache_mode_name(c.cache)),
+            static_cast<std::int64_t>(img.width), static_cast<std::int64_t>(img.height),
+            static_cast<std::int64_t>(c.out_w), static_cast<std::int64_t>(c.out_h),
+            static_cast<std::int64_t>(img.channels),
+            static_cast<std::int64_t>(spec.warmup), static_cast<std::int64_t>(spec.inner_reps),
+            mpix_per_s
+        };
+        append_bench_result(row, r);
+        writer.add_row(std::move(row));
+
+        if (samples) write_samples(*samples, {static_cast<std::int64_t>(order[k])}, r, spec.bench.outlier_k);
+    }
+
+    writer.flush();
+    if (samples) samples->flush();
+    log << "benchset: wrote " << configs.size() << " rows to " << out_path << "\n";
+}
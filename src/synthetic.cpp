@@ -0,0 +1,253 @@
+// synthetic.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of the synthetic image generator.
+// Randomness comes from a stateless splitmix64-style hash of the pixel
+// coordinates, never from a sequential RNG, to keep generation order-free.
+#include "synthetic.hpp"
+
+#include "util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+namespace {
+
+inline std::uint64_t mix64(std::uint64_t z) {
+    z += 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+inline std::uint64_t hash3(std::uint64_t seed, std::uint64_t a, std::uint64_t b) {
+    return mix64(seed ^ mix64(a ^ mix64(b)));
+}
+
+// Uniform in [0, 1)
+inline float unit(std::uint64_t h) {
+    return static_cast<float>(h >> 40) * (1.0f / 16777216.0f);
+}
+
+inline float smooth(float t) { return t * t * (3.0f - 2.0f * t); }
+
+// Adds amp * value_noise(x, y) for x in [0, w) to acc, where value_noise is bilinearly
+// (smoothstep) interpolated lattice noise with cell size `cell`. Corner hashes are
+// computed once per lattice cell, not once per pixel.
+void add_value_noise_row(std::uint64_t seed, int y, int w, int cell, float amp, float* acc) {
+    const int cy = y / cell;
+    const float fy = smooth(static_cast<float>(y - cy * cell) / static_cast<float>(cell));
+    const float inv_cell = 1.0f / static_cast<float>(cell);
+
+    auto corner = [&](int cx, int dy) {
+        return unit(hash3(seed, static_cast<std::uint64_t>(cx), static_cast<std::uint64_t>(cy + dy)));
+    };
+
+    // Column values at the left edge of the current cell, interpolated along y.
+    float left = corner(0, 0) + fy * (corner(0, 1) - corner(0, 0));
+    for (int cx = 0; cx * cell < w; ++cx) {
+        const float right = corner(cx + 1, 0) + fy * (corner(cx + 1, 1) - corner(cx + 1, 0));
+        const int x_end = std::min(w, (cx + 1) * cell);
+        for (int x = cx * cell; x < x_end; ++x) {
+            const float fx = smooth(static_cast<float>(x - cx * cell) * inv_cell);
+            acc[x] += amp * (left + fx * (right - left));
+        }
+        left = right;
+    }
+}
+
+// Sum of octaves with amplitude proportional to cell size: ~1/f amplitude spectrum.
+// Octaves finer than min_cell are skipped. Result in [0, 1].
+void fractal_noise_row(std::uint64_t seed, int y, int w, int base_cell, int min_cell, float* out) {
+    std::fill(out, out + w, 0.0f);
+    float norm = 0.0f;
+    int octave = 0;
+    for (int cell = base_cell; cell >= min_cell; cell /= 2, ++octave) {
+        const float amp = static_cast<float>(cell);
+        add_value_noise_row(seed + static_cast<std::uint64_t>(octave) * 0x51ed27ull, y, w, cell, amp, out);
+        norm += amp;
+    }
+    const float inv = 1.0f / norm;
+    for (int x = 0; x < w; ++x) out[x] *= inv;
+}
+
+inline std::uint8_t to_u8(float v01) {
+    return clamp_u8(static_cast<int>(v01 * 255.0f + 0.5f));
+}
+
+struct GlyphGeometry {
+    static constexpr int cell_w = 6;   // 5 px glyph + 1 px spacing
+    static constexpr int cell_h = 10;  // 7 px glyph + 3 px leading
+    static constexpr int glyph_w = 5;
+    static constexpr int glyph_h = 7;
+};
+
+std::uint8_t text_pixel(std::uint64_t seed, int x, int y) {
+    using G = GlyphGeometry;
+    const int gx = x / G::cell_w, gy = y / G::cell_h;
+    const int sx = x - gx * G::cell_w, sy = y - gy * G::cell_h;
+    if (sx >= G::glyph_w || sy >= G::glyph_h) return 245; // paper
+
+    // Word gaps: one cell in eight is a space.
+    const std::uint64_t g = hash3(seed, static_cast<std::uint64_t>(gx), static_cast<std::uint64_t>(gy));
+    if ((g & 7u) < 1u) return 245;
+
+    // Each glyph gets its own pseudo-random 5x7 bitmap with ~45% ink.
+    const std::uint64_t bits = mix64(g);
+    const int bit = sy * G::glyph_w + sx;
+    const bool ink = unit(mix64(bits + static_cast<std::uint64_t>(bit))) < 0.45f;
+    return ink ? 20 : 245;
+}
+
+} // namespace
+
+const char* synthetic_pattern_name(SyntheticPattern p) {
+    switch (p) {
+        case SyntheticPattern::Gradient: return "gradient";
+        case SyntheticPattern::Noise:    return "noise";
+        case SyntheticPattern::Checker:  return "checker";
+        case SyntheticPattern::Text:     return "text";
+        case SyntheticPattern::Natural:  return "natural";
+    }
+    return "unknown";
+}
+
+Image generate_synthetic(int w, int h, int channels, SyntheticPattern pattern,
+                         std::uint64_t seed, int threads) {
+    if (w <= 0 || h <= 0 || w > synthetic_max_side || h > synthetic_max_side) {
+        throw std::invalid_argument("generate_synthetic: width/height must be in 1.." +
+                                    std::to_string(synthetic_max_side));
+    }
+    Image img(w, h, channels);
+
+    // Largest octave: a quarter of the long side, rounded down to a power of two.
+    int base_cell = 1;
+    while (base_cell * 8 <= std::max(w, h)) base_cell *= 2;
+
+    const float inv_w = (w > 1) ? 1.0f / static_cast<float>(w - 1) : 0.0f;
+    const float inv_h = (h > 1) ? 1.0f / static_cast<float>(h - 1) : 0.0f;
+
+    // Natural pattern: one luminance row plus up to three (coarser) chroma rows.
+    const int noise_rows = (pattern == SyntheticPattern::Natural) ? 1 + std::min(channels, 3) : 0;
+    const int chroma_cell = std::max(1, base_cell / 2);
+    const int chroma_min_cell = std::min(chroma_cell, 4); // chroma carries little fine detail
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel
+#else
+    (void)threads;
+#endif
+    {
+        std::vector<float> noise(static_cast<size_t>(noise_rows) * static_cast<size_t>(w));
+
+#if HAVE_OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int y = 0; y < h; ++y) {
+            std::uint8_t* row = img.row_ptr(y);
+
+            if (noise_rows > 0) {
+                fractal_noise_row(seed, y, w, base_cell, 1, noise.data());
+                for (int c = 1; c < noise_rows; ++c) {
+                    fractal_noise_row(seed + 0x1000u * static_cast<std::uint64_t>(c), y, w,
+                                      chroma_cell, chroma_min_cell, noise.data() + static_cast<size_t>(c) * w);
+                }
+            }
+
+            for (int x = 0; x < w; ++x) {
+                std::uint8_t* px = row + static_cast<size_t>(x) * static_cast<size_t>(channels);
+
+                switch (pattern) {
+                    case SyntheticPattern::Gradient: {
+                        const float u = static_cast<float>(x) * inv_w;
+                        const float v = static_cast<float>(y) * inv_h;
+                        const float ramps[4] = {u, v, 0.5f * (u + v), 1.0f - 0.5f * (u + v)};
+                        if (channels == 1) px[0] = to_u8(0.5f * (u + v));
+                        else for (int c = 0; c < channels; ++c) px[c] = to_u8(ramps[c]);
+                        break;
+                    }
+                    case SyntheticPattern::Noise: {
+                        const std::uint64_t hv = hash3(seed, static_cast<std::uint64_t>(x), static_cast<std::uint64_t>(y));
+                        for (int c = 0; c < channels; ++c) px[c] = static_cast<std::uint8_t>(hv >> (8 * c));
+                        break;
+                    }
+                    case SyntheticPattern::Checker: {
+                        const int phase = static_cast<int>(seed & 15u);
+                        const bool on = ((((x + phase) >> 4) ^ ((y + phase) >> 4)) & 1) != 0;
+                        for (int c = 0; c < channels; ++c) px[c] = on ? 255 : 0;
+                        break;
+                    }
+                    case SyntheticPattern::Text: {
+                        const std::uint8_t v = text_pixel(seed, x, y);
+                        for (int c = 0; c < channels; ++c) px[c] = v;
+                        break;
+                    }
+                    case SyntheticPattern::Natural: {
+                        // Shared luminance structure plus a weaker per-channel component.
+                        const float lum = noise[static_cast<size_t>(x)];
+                        for (int c = 0; c < channels; ++c) {
+                            if (c == 3) { px[c] = 255; continue; } // opaque alpha
+                            const float chroma = noise[static_cast<size_t>(c + 1) * w + static_cast<size_t>(x)];
+                            px[c] = to_u8(0.75f * lum + 0.25f * chroma);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return img;
+}
+
+bool is_synthetic_spec(std::string_view path) {
+    return path.rfind("synthetic:", 0) == 0;
+}
+
+Image load_synthetic(std::string_view spec, int requested_channels) {
+    if (!is_synthetic_spec(spec)) throw std::invalid_argument("load_synthetic: not a synthetic spec: " + std::string(spec));
+
+    const std::vector<std::string> parts = split(spec.substr(10), ':');
+    if (parts.empty() || parts.size() > 3) {
+        throw std::invalid_argument("synthetic spec must be synthetic:WxHxC[:pattern[:seed]]: " + std::string(spec));
+    }
+
+    const std::vector<std::string> dims = split(to_lower(parts[0]), 'x');
+    if (dims.size() != 2 && dims.size() != 3) {
+        throw std::invalid_argument("synthetic size must be WxH or WxHxC: " + parts[0]);
+    }
+    const int w = parse_int(dims[0], "synthetic width");
+    const int h = parse_int(dims[1], "synthetic height");
+    int c = (dims.size() == 3) ? parse_int(dims[2], "synthetic channels") : 3;
+    if (requested_channels != 0) c = requested_channels;
+
+    SyntheticPattern pattern = SyntheticPattern::Natural;
+    if (parts.size() >= 2) {
+        const std::string p = to_lower(parts[1]);
+        if      (p == "gradient") pattern = SyntheticPattern::Gradient;
+        else if (p == "noise")    pattern = SyntheticPattern::Noise;
+        else if (p == "checker" || p == "checkerboard") pattern = SyntheticPattern::Checker;
+        else if (p == "text")     pattern = SyntheticPattern::Text;
+        else if (p == "natural")  pattern = SyntheticPattern::Natural;
+        else throw std::invalid_argument("Unknown synthetic pattern: " + p);
+    }
+
+    std::uint64_t seed = 1;
+    if (parts.size() == 3) {
+        try {
+            size_t idx = 0;
+            seed = std::stoull(parts[2], &idx);
+            if (idx != parts[2].size()) throw std::invalid_argument("trailing chars");
+        } catch (...) {
+            throw std::invalid_argument("Invalid synthetic seed: " + parts[2]);
+        }
+    }
+
+    return generate_synthetic(w, h, c, pattern, seed);
+}
@@ -0,0 +1,194 @@
+// sysinfo.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Implementation of host introspection helpers.
+#include "sysinfo.hpp"
+
+#include "util.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <initializer_list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+  #include <sys/utsname.h>
+#endif
+
+static std::string read_first_line(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (in) std::getline(in, line);
+    return line;
+}
+
+// sysfs cache sizes look like "32K", "1024K" or "32M".
+static std::size_t parse_size_suffix(const std::string& s) {
+    if (s.empty()) return 0;
+    std::size_t v = 0;
+    size_t i = 0;
+    while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+        v = v * 10 + static_cast<std::size_t>(s[i] - '0');
+        ++i;
+    }
+    if (i < s.size()) {
+        if (s[i] == 'K' || s[i] == 'k') v *= 1024;
+        else if (s[i] == 'M' || s[i] == 'm') v *= 1024 * 1024;
+        else if (s[i] == 'G' || s[i] == 'g') v *= 1024ull * 1024 * 1024;
+    }
+    return v;
+}
+
+std::vector<CacheLevel> cpu_caches() {
+    std::vector<CacheLevel> caches;
+    for (int idx = 0; idx < 16; ++idx) {
+        const std::string base = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(idx) + "/";
+        const std::string level = read_first_line(base + "level");
+        if (level.empty()) break;
+
+        CacheLevel c;
+        c.level = std::stoi(level);
+        c.type = read_first_line(base + "type");
+        c.size_bytes = parse_size_suffix(read_first_line(base + "size"));
+        caches.push_back(std::move(c));
+    }
+    return caches;
+}
+
+std::size_t llc_size_bytes() {
+    std::size_t best = 0;
+    int best_level = 0;
+    for (const CacheLevel& c : cpu_caches()) {
+        if (c.type == "Instruction") continue;
+        if (c.level > best_level || (c.level == best_level && c.size_bytes > best)) {
+            best_level = c.level;
+            best = c.size_bytes;
+        }
+    }
+    return best;
+}
+
+// Value of the first "key : value" line of /proc/cpuinfo whose key is one of keys.
+static std::string cpuinfo_field(std::initializer_list<const char*> keys) {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        while (!key.empty() && (key.back() == ' ' || key.back() == '\t')) key.pop_back();
+        for (const char* k : keys) {
+            if (key == k) {
+                const size_t v = line.find_first_not_of(' ', colon + 1);
+                return (v == std::string::npos) ? std::string() : line.substr(v);
+            }
+        }
+    }
+    return {};
+}
+
+std::string cpu_model_name() {
+    // x86: "model name"; arm64 kernels usually expose no model string at all.
+    return cpuinfo_field({"model name", "Model", "Hardware", "cpu model"});
+}
+
+std::vector<std::string> cpu_isa_extensions() {
+    static const char* const relevant[] = {
+        "sse2", "ssse3", "sse4_1", "sse4_2", "popcnt", "avx", "f16c", "fma", "bmi2", "avx2",
+        "avx512f", "avx512dq", "avx512cd", "avx512bw", "avx512vl", "avx512_vnni", "avx512_bf16",
+        "neon", "asimd", "asimdhp", "sve", "sve2"
+    };
+    const std::vector<std::string> flags = split(cpuinfo_field({"flags", "Features"}), ' ');
+
+    std::vector<std::string> out;
+    for (const char* f : relevant) {
+        if (std::find(flags.begin(), flags.end(), f) != flags.end()) out.emplace_back(f);
+    }
+    return out;
+}
+
+std::string kernel_release() {
+#if defined(__linux__) || defined(__APPLE__)
+    struct utsname u {};
+    if (uname(&u) == 0) return std::string(u.sysname) + " " + u.release + " " + u.machine;
+#endif
+    return {};
+}
+
+std::string cpu_governor() {
+    return read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+}
+
+std::vector<int> parse_cpu_list(std::string_view s) {
+    std::vector<int> cpus;
+    for (const std::string& item : split(s, ',')) {
+        const size_t dash = item.find('-');
+        if (dash == std::string::npos) {
+            cpus.push_back(parse_int(item, "cpu"));
+            continue;
+        }
+        const int lo = parse_int(std::string_view(item).substr(0, dash), "cpu");
+        const int hi = parse_int(std::string_view(item).substr(dash + 1), "cpu");
+        if (lo > hi) throw std::invalid_argument("Invalid CPU range: " + item);
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    for (int c : cpus) {
+        if (c < 0) throw std::invalid_argument("CPU numbers must be >= 0");
+    }
+    return cpus;
+}
+
+static std::vector<LogicalCpu> detect_cpu_topology() {
+    std::vector<int> ids;
+    const std::string online = read_first_line("/sys/devices/system/cpu/online");
+    if (!online.empty()) {
+        try {
+            ids = parse_cpu_list(online);
+        } catch (const std::exception&) {
+            ids.clear();
+        }
+    }
+    if (ids.empty()) {
+        const int n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int c = 0; c < n; ++c) ids.push_back(c);
+    }
+
+#if defined(__linux__)
+    // Respect taskset/cgroup restrictions.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        std::erase_if(ids, [&](int c) { return c >= CPU_SETSIZE || !CPU_ISSET(c, &allowed); });
+    }
+#endif
+
+    std::vector<LogicalCpu> cpus;
+    for (int id : ids) {
+        const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+        const std::string pkg = read_first_line(base + "physical_package_id");
+        const std::string core = read_first_line(base + "core_id");
+
+        LogicalCpu c;
+        c.id = id;
+        c.package = pkg.empty() ? 0 : std::stoi(pkg);
+        c.core = core.empty() ? id : std::stoi(core);
+        cpus.push_back(c);
+    }
+
+    // SMT rank: order of the CPU among those sharing (package, core).
+    std::map<std::pair<int, int>, int> seen;
+    for (LogicalCpu& c : cpus) c.smt = seen[{c.package, c.core}]++;
+    return cpus;
+}
+
+const std::vector<LogicalCpu>& cpu_topology() {
+    static const std::vector<LogicalCpu> topo = detect_cpu_topology();
+    return topo;
+}
@@ -0,0 +1,163 @@
+// trace.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Per-thread trace buffers and the Chrome trace-event JSON writer.
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace trace_detail {
+    std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+struct ThreadBuffer {
+    int tid = 0;
+    std::string name;
+    std::vector<TraceEvent> events; // written only by the owning thread
+};
+
+// Buffers are never freed: worker threads keep a pointer to theirs for the whole
+// process lifetime (OpenMP pools outlive any session).
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::int64_t epoch_ns = 0;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+ThreadBuffer& local_buffer() {
+    thread_local ThreadBuffer* buf = nullptr;
+    if (buf == nullptr) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto b = std::make_unique<ThreadBuffer>();
+        b->tid = static_cast<int>(r.buffers.size());
+        b->events.reserve(4096);
+        buf = b.get();
+        r.buffers.push_back(std::move(b));
+    }
+    return *buf;
+}
+
+void write_json_string(std::ostream& os, const std::string& s) {
+    os << '"';
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') os << '\\';
+        os << ch;
+    }
+    os << '"';
+}
+
+// Microseconds with nanosecond resolution, as Chrome expects for ts/dur.
+void write_us(std::ostream& os, std::int64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(ns) / 1000.0);
+    os << buf;
+}
+
+} // namespace
+
+void trace_detail::record(const TraceEvent& e) {
+    local_buffer().events.push_back(e);
+}
+
+void trace_set_thread_name(const std::string& name) {
+    ThreadBuffer& b = local_buffer();
+    if (b.name.empty()) b.name = name;
+}
+
+TraceSession::TraceSession(std::string path) : path_(std::move(path)) {
+    if (path_.empty()) return;
+#if !RESIZER_TRACE
+    throw std::invalid_argument("--trace: tracing was disabled at build time (RESIZER_TRACING=OFF)");
+#else
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto& b : r.buffers) b->events.clear();
+        r.epoch_ns = trace_detail::now_ns();
+    }
+    trace_set_thread_name("main");
+    active_ = true;
+    trace_detail::enabled.store(true, std::memory_order_relaxed);
+#endif
+}
+
+TraceSession::~TraceSession() {
+    if (!active_) return;
+    try {
+        finish();
+    } catch (const std::exception& e) {
+        std::cerr << "WARNING: " << e.what() << "\n";
+    }
+}
+
+// Meant to be called once the traced work is done: worker threads must not be
+// recording while their buffers are read.
+std::size_t TraceSession::finish() {
+    if (!active_) return 0;
+    active_ = false;
+    trace_detail::enabled.store(false, std::memory_order_relaxed);
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::ostringstream oss;
+    oss << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    oss << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"Image_resizer_PP_Lab2\"}}";
+
+    std::size_t count = 0;
+    for (const auto& b : r.buffers) {
+        if (b->events.empty()) continue;
+        const std::string name = b->name.empty() ? "thread " + std::to_string(b->tid) : b->name;
+        oss << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->tid << ", \"args\": {\"name\": ";
+        write_json_string(oss, name);
+        oss << "}}";
+        oss << ",\n  {\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->tid
+            << ", \"args\": {\"sort_index\": " << b->tid << "}}";
+
+        for (const TraceEvent& e : b->events) {
+            oss << ",\n  {\"name\": ";
+            write_json_string(oss, e.name);
+            oss << ", \"cat\": ";
+            write_json_string(oss, e.cat);
+            oss << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << b->tid << ", \"ts\": ";
+            write_us(oss, e.begin_ns - r.epoch_ns);
+            oss << ", \"dur\": ";
+            write_us(oss, std::max<std::int64_t>(0, e.end_ns - e.begin_ns));
+            if (e.arg_names[0] != nullptr) {
+                oss << ", \"args\": {";
+                for (int a = 0; a < 2 && e.arg_names[a] != nullptr; ++a) {
+                    if (a) oss << ", ";
+                    write_json_string(oss, e.arg_names[a]);
+                    oss << ": " << e.args[a];
+                }
+                oss << "}";
+            }
+            oss << "}";
+            ++count;
+        }
+        b->events.clear();
+    }
+    oss << "\n]}\n";
+
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("trace: cannot open file: " + path_);
+    out << oss.str();
+    return count;
+}
@@ -36,3 +36,23 @@ int parse_int(std::string_view s, std::string_view name) {
         throw std::invalid_argument("Invalid integer for " + std::string(name) + ": " + std::string(s));
     }
 }
+
+std::vector<std::string> split(std::string_view s, char sep) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        const size_t pos = s.find(sep, start);
+        const size_t end = (pos == std::string_view::npos) ? s.size() : pos;
+        if (end > start) out.emplace_back(s.substr(start, end - start));
+        if (pos == std::string_view::npos) break;
+        start = pos + 1;
+    }
+    return out;
+}
+
+std::vector<int> parse_int_list(std::string_view s, std::string_view name) {
+    std::vector<int> out;
+    for (const std::string& item : split(s, ',')) out.push_back(parse_int(item, name));
+    if (out.empty()) throw std::invalid_argument("Empty list for " + std::string(name));
+    return out;
+}
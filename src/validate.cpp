@@ -3,23 +3,103 @@
 //
 // Implementation of image comparison metrics for correctness validation.
 #include "validate.hpp"
+#include "kernels.hpp"
+
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+// Work unit of the parallel comparison: large enough to amortize scheduling,
+// small enough to balance 100 MP images over many threads.
+static constexpr std::size_t compare_chunk_bytes = std::size_t{1} << 20;
 
-DiffStats compare_images(const Image& a, const Image& b) {
+static void check_comparable(const Image& a, const Image& b) {
     if (a.width != b.width || a.height != b.height || a.channels != b.channels) {
         throw std::invalid_argument("compare_images: size/channels mismatch");
     }
     if (a.data.size() != b.data.size()) {
         throw std::invalid_argument("compare_images: buffer size mismatch");
     }
+}
+
+static void set_first_mismatch(DiffStats& s, const Image& img, std::size_t index) {
+    const std::size_t c = static_cast<std::size_t>(img.channels);
+    const std::size_t px = index / c;
+    s.first_c = static_cast<int>(index % c);
+    s.first_x = static_cast<int>(px % static_cast<std::size_t>(img.width));
+    s.first_y = static_cast<int>(px / static_cast<std::size_t>(img.width));
+}
+
+double DiffStats::mean_abs_diff() const {
+    std::uint64_t n = 0;
+    for (std::uint64_t h : histogram) n += h;
+    return (n > 0) ? static_cast<double>(sum_abs_diff) / static_cast<double>(n) : 0.0;
+}
+
+DiffStats compare_images(const Image& a, const Image& b, int threads) {
+    check_comparable(a, b);
+
+    const std::size_t n = a.data.size();
+    const std::size_t chunks = (n + compare_chunk_bytes - 1) / compare_chunk_bytes;
+
+    struct Partial {
+        AbsDiffAccum acc;
+        std::array<std::uint64_t, 256> hist{};
+        std::size_t first = 0; // absolute index, valid when acc.nonzero > 0
+    };
+    std::vector<Partial> parts(chunks);
+
+    auto run_chunk = [&](std::size_t k) {
+        const std::size_t begin = k * compare_chunk_bytes;
+        const std::size_t len = std::min(compare_chunk_bytes, n - begin);
+        Partial& p = parts[k];
+        absdiff_stats(a.data.data() + begin, b.data.data() + begin, len, p.acc, p.hist.data());
+        if (p.acc.nonzero > 0) p.first = begin + first_mismatch(a.data.data() + begin, b.data.data() + begin, len);
+    };
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    const long long nchunks = static_cast<long long>(chunks);
+    #pragma omp parallel for schedule(static)
+    for (long long k = 0; k < nchunks; ++k) run_chunk(static_cast<std::size_t>(k));
+#else
+    (void)threads;
+    for (std::size_t k = 0; k < chunks; ++k) run_chunk(k);
+#endif
+
+    // Combined in chunk order: the first mismatch is the one of the first dirty chunk.
+    DiffStats s;
+    bool have_first = false;
+    for (const Partial& p : parts) {
+        s.different_values += p.acc.nonzero;
+        s.max_abs_diff = std::max(s.max_abs_diff, p.acc.max_abs);
+        s.sum_abs_diff += p.acc.sum;
+        for (int d = 1; d < 256; ++d) s.histogram[static_cast<size_t>(d)] += p.hist[static_cast<size_t>(d)];
+        if (!have_first && p.acc.nonzero > 0) {
+            set_first_mismatch(s, a, p.first);
+            have_first = true;
+        }
+    }
+    s.histogram[0] = static_cast<std::uint64_t>(n) - s.different_values;
+    return s;
+}
+
+DiffStats compare_images_reference(const Image& a, const Image& b) {
+    check_comparable(a, b);
 
     DiffStats s;
-    for (size_t i = 0; i < a.data.size(); ++i) {
-        const int da = static_cast<int>(a.data[i]);
-        const int db = static_cast<int>(b.data[i]);
-        const int d = da - db;
+    for (std::size_t i = 0; i < a.data.size(); ++i) {
+        const int d = static_cast<int>(a.data[i]) - static_cast<int>(b.data[i]);
         const int ad = (d < 0) ? -d : d;
-        if (ad != 0) s.different_values++;
+        s.histogram[static_cast<size_t>(ad)]++;
+        s.sum_abs_diff += static_cast<std::uint64_t>(ad);
+        if (ad == 0) continue;
+        if (s.different_values == 0) set_first_mismatch(s, a, i);
+        s.different_values++;
         if (ad > s.max_abs_diff) s.max_abs_diff = ad;
     }
     return s;
@@ -0,0 +1,234 @@
+// yuv.cpp
+// Created by Francesco on 17/10/2026.
+//
+// Planar YUV resize, conversion and raw I/O.
+// Each plane is treated as a 1-channel image. Coordinate mapping and rounding are the
+// same as resize_seq, so a center-sited plane is bit-identical to resizing it as a
+// grayscale Image; left-sited chroma only changes the horizontal sampling phase.
+#include "yuv.hpp"
+
+#include "kernels.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#if HAVE_OPENMP
+  #include <omp.h>
+#endif
+
+YuvImage::YuvImage(int w, int h, ChromaFormat f, ChromaSiting s)
+    : width(w), height(h), format(f), siting(s) {
+    if (w <= 0 || h <= 0) throw std::invalid_argument("YuvImage: width/height must be > 0");
+    y = Image(w, h, 1);
+    u = Image(chroma_width(), chroma_height(), 1);
+    v = Image(chroma_width(), chroma_height(), 1);
+}
+
+namespace {
+
+// Source coordinate for destination coordinate d: (d + phase) * scale - phase.
+// phase = 0.5 is the usual pixel-center mapping used by resize_seq.
+struct AxisMap {
+    float scale = 1.0f;
+    float phase = 0.5f;
+
+    [[nodiscard]] float src(int d) const {
+        return (static_cast<float>(d) + phase) * scale - phase;
+    }
+};
+
+// make_column_map / row_tap for an arbitrary AxisMap (same clamping and weights).
+ColumnMap axis_column_map(const AxisMap& m, int in_w, int out_w, ResizeMethod method) {
+    ColumnMap cm;
+    cm.x0.resize(static_cast<size_t>(out_w));
+    if (method == ResizeMethod::Bilinear) {
+        cm.x1.resize(static_cast<size_t>(out_w));
+        cm.wx.resize(static_cast<size_t>(out_w));
+    }
+    for (int x = 0; x < out_w; ++x) {
+        const float sx = m.src(x);
+        if (method == ResizeMethod::Nearest) {
+            cm.x0[x] = clamp_int(static_cast<int>(std::lround(sx)), 0, in_w - 1);
+        } else {
+            cm.x0[x] = clamp_int(static_cast<int>(std::floor(sx)), 0, in_w - 1);
+            cm.x1[x] = clamp_int(cm.x0[x] + 1, 0, in_w - 1);
+            cm.wx[x] = sx - static_cast<float>(cm.x0[x]);
+        }
+    }
+    return cm;
+}
+
+RowTap axis_row_tap(const AxisMap& m, int y, int in_h, ResizeMethod method) {
+    const float sy = m.src(y);
+    RowTap t;
+    if (method == ResizeMethod::Nearest) {
+        t.y0 = clamp_int(static_cast<int>(std::lround(sy)), 0, in_h - 1);
+        t.y1 = t.y0;
+    } else {
+        t.y0 = clamp_int(static_cast<int>(std::floor(sy)), 0, in_h - 1);
+        t.y1 = clamp_int(t.y0 + 1, 0, in_h - 1);
+        t.wy = sy - static_cast<float>(t.y0);
+    }
+    return t;
+}
+
+// One plane of a YUV resize job, with its column map precomputed. Rows run the
+// 1-channel kernels of kernels.hpp (and so the dispatched x86-64 level).
+struct PlaneJob {
+    const Image* in = nullptr;
+    Image* out = nullptr;
+    AxisMap mx, my;
+    ResizeMethod method = ResizeMethod::Nearest;
+    ColumnMap cm;
+
+    void prepare(ResizeMethod m) {
+        method = m;
+        cm = axis_column_map(mx, in->width, out->width, method);
+    }
+
+    void row(int y) const {
+        const RowTap t = axis_row_tap(my, y, in->height, method);
+        if (method == ResizeMethod::Nearest) {
+            nearest_row(in->row_ptr(t.y0), out->row_ptr(y), cm, out->width, 1);
+        } else {
+            bilinear_row(in->row_ptr(t.y0), in->row_ptr(t.y1), out->row_ptr(y), cm, t.wy, out->width, 1);
+        }
+    }
+};
+
+} // namespace
+
+YuvImage resize_yuv(const YuvImage& in, int out_w, int out_h,
+                    ResizeMethod method, Backend backend, int threads) {
+    if (in.empty()) throw std::invalid_argument("resize_yuv: input image is empty");
+    if (out_w <= 0 || out_h <= 0) throw std::invalid_argument("resize_yuv: output size must be > 0");
+
+    YuvImage out(out_w, out_h, in.format, in.siting);
+
+    const float luma_sx = static_cast<float>(in.width) / static_cast<float>(out_w);
+
+    PlaneJob jobs[3];
+    jobs[0].in = &in.y; jobs[0].out = &out.y;
+    jobs[1].in = &in.u; jobs[1].out = &out.u;
+    jobs[2].in = &in.v; jobs[2].out = &out.v;
+
+    for (PlaneJob& j : jobs) {
+        j.mx.scale = static_cast<float>(j.in->width)  / static_cast<float>(j.out->width);
+        j.my.scale = static_cast<float>(j.in->height) / static_cast<float>(j.out->height);
+    }
+    if (in.siting == ChromaSiting::Left) {
+        // Chroma sample i sits on luma sample 2i: in chroma units the mapping keeps
+        // the luma scale but uses a quarter-sample phase.
+        for (int p = 1; p < 3; ++p) {
+            jobs[p].mx.scale = luma_sx;
+            jobs[p].mx.phase = 0.25f;
+        }
+    }
+    for (PlaneJob& j : jobs) j.prepare(method);
+
+    // Rows of all planes are flattened into one index space: [Y rows][U rows][V rows].
+    const int rows_y = out.y.height;
+    const int rows_c = out.u.height;
+    const int total_rows = rows_y + 2 * rows_c;
+
+    auto do_row = [&](int r) {
+        int p = 0;
+        if (r >= rows_y) {
+            r -= rows_y;
+            p = 1;
+            if (r >= rows_c) { r -= rows_c; p = 2; }
+        }
+        jobs[p].row(r);
+    };
+
+#if HAVE_OPENMP
+    if (backend == Backend::OpenMP) {
+        if (threads > 0) omp_set_num_threads(threads);
+
+        #pragma omp parallel for schedule(static)
+        for (int r = 0; r < total_rows; ++r) do_row(r);
+
+        return out;
+    }
+#else
+    (void)threads;
+#endif
+    (void)backend;
+    for (int r = 0; r < total_rows; ++r) do_row(r);
+    return out;
+}
+
+Image yuv_to_rgb(const YuvImage& in, int threads) {
+    if (in.empty()) throw std::invalid_argument("yuv_to_rgb: input image is empty");
+
+    Image out(in.width, in.height, 3);
+    const int w = in.width;
+
+    // Luma coordinate -> chroma coordinate. Chroma sample i sits on luma 2i (left)
+    // or 2i + 0.5 (center, and always vertically for 4:2:0); 4:2:2 rows map 1:1.
+    const AxisMap cmx{0.5f, (in.siting == ChromaSiting::Left) ? 0.0f : 0.5f};
+    const AxisMap cmy{(in.format == ChromaFormat::Yuv420) ? 0.5f : 1.0f, 0.5f};
+    const ColumnMap cm = axis_column_map(cmx, in.u.width, w, ResizeMethod::Bilinear);
+
+#if HAVE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+    #pragma omp parallel
+#else
+    (void)threads;
+#endif
+    {
+        // One upsampled chroma row per plane and thread.
+        std::vector<std::uint8_t> urow(static_cast<size_t>(w)), vrow(static_cast<size_t>(w));
+
+#if HAVE_OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int y = 0; y < in.height; ++y) {
+            const RowTap t = axis_row_tap(cmy, y, in.u.height, ResizeMethod::Bilinear);
+            bilinear_row(in.u.row_ptr(t.y0), in.u.row_ptr(t.y1), urow.data(), cm, t.wy, w, 1);
+            bilinear_row(in.v.row_ptr(t.y0), in.v.row_ptr(t.y1), vrow.data(), cm, t.wy, w, 1);
+
+            const std::uint8_t* yr = in.y.row_ptr(y);
+            std::uint8_t* dst = out.row_ptr(y);
+            for (int x = 0; x < w; ++x) {
+                const float Y = static_cast<float>(yr[x]);
+                const float U = static_cast<float>(urow[x]) - 128.0f;
+                const float V = static_cast<float>(vrow[x]) - 128.0f;
+
+                dst[3 * x + 0] = clamp_u8(static_cast<int>(std::lround(Y + 1.402f * V)));
+                dst[3 * x + 1] = clamp_u8(static_cast<int>(std::lround(Y - 0.344136f * U - 0.714136f * V)));
+                dst[3 * x + 2] = clamp_u8(static_cast<int>(std::lround(Y + 1.772f * U)));
+            }
+        }
+    }
+    return out;
+}
+
+YuvImage load_yuv_raw(const std::string& path, int w, int h, ChromaFormat format, ChromaSiting siting) {
+    YuvImage img(w, h, format, siting);
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("load_yuv_raw: cannot open file: " + path);
+
+    for (Image* p : {&img.y, &img.u, &img.v}) {
+        in.read(reinterpret_cast<char*>(p->data.data()), static_cast<std::streamsize>(p->size_bytes()));
+        if (in.gcount() != static_cast<std::streamsize>(p->size_bytes())) {
+            throw std::runtime_error("load_yuv_raw: file too short for given size/format: " + path);
+        }
+    }
+    return img;
+}
+
+void save_yuv_raw(const YuvImage& img, const std::string& path) {
+    if (img.empty()) throw std::invalid_argument("save_yuv_raw: image is empty");
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("save_yuv_raw: cannot open file: " + path);
+
+    for (const Image* p : {&img.y, &img.u, &img.v}) {
+        out.write(reinterpret_cast<const char*>(p->data.data()), static_cast<std::streamsize>(p->size_bytes()));
+    }
+    if (!out) throw std::runtime_error("save_yuv_raw: failed to write: " + path);
+}